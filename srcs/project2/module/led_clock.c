@@ -0,0 +1,73 @@
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/atomic.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
+#include <linux/sched.h>
+#include <linux/sched/signal.h>
+
+#include "led_control.h"
+
+// 엔진 시계
+// 평소에는 CLOCK_MONOTONIC 그대로다. virtual_clock=1 로 올리면 시간이 저절로 흐르지 않고
+// sysfs clock_ns 에 쓴 시각까지만 흐른다. 그 사이에 예정된 엔진 tick, 레이어 프레임,
+// mmio 폴링, 제스처 타임아웃은 쓰는 쪽 context 에서 시각 순서대로 모두 실행되므로
+// 몇 분짜리 패턴도 바로, 매번 같은 순서로 끝난다.
+
+static bool virtual_clock;
+module_param(virtual_clock, bool, 0444);
+MODULE_PARM_DESC(virtual_clock, "engine time only moves when sysfs clock_ns is written (testing only)");
+
+// 0 에서 시작하면 첫 스위치 엣지가 디바운스에 걸리므로 1 초에서 시작
+static atomic64_t virtual_ns = ATOMIC64_INIT(NSEC_PER_SEC);
+// 시계를 돌리는 쪽은 한 번에 하나
+static DEFINE_MUTEX(advance_mutex);
+
+bool led_clock_is_virtual(void) {
+    return virtual_clock;
+}
+
+// 엔진, 레이어, 제스처, 이벤트 타임스탬프가 쓰는 현재 시각 (어느 context 에서든 호출 가능)
+u64 led_clock_ns(void) {
+    return virtual_clock ? atomic64_read(&virtual_ns) : ktime_get_ns();
+}
+
+// 가상 시계를 until 까지 돌린다. 도중에 할 일이 생기면 그 시각에 멈춰 처리하고 계속 간다
+int led_clock_advance(u64 until) {
+    u64 now, next;
+    int ret = 0;
+
+    if (!virtual_clock) {
+        return -EPERM;
+    }
+
+    mutex_lock(&advance_mutex);
+    now = led_clock_ns();
+    if (until < now) {
+        ret = -EINVAL;
+        goto out;
+    }
+    for (;;) {
+        next = min(led_engine_next_due(), led_gesture_next());
+        if (next > until) {
+            break;
+        }
+        if (next > now) {
+            now = next;
+            atomic64_set(&virtual_ns, now);
+        }
+        // 제스처가 모드를 바꿀 수 있으므로 엔진보다 먼저
+        led_gesture_expire(now);
+        led_engine_run(now);
+
+        if (fatal_signal_pending(current)) {
+            ret = -EINTR;
+            goto out;
+        }
+        cond_resched();
+    }
+    atomic64_set(&virtual_ns, until);
+out:
+    mutex_unlock(&advance_mutex);
+    return ret;
+}
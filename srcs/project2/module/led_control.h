@@ -0,0 +1,159 @@
+#ifndef LED_CONTROL_H
+#define LED_CONTROL_H
+
+// led_control 모듈 내부에서 파일끼리 공유하는 선언
+
+#include <linux/bits.h>
+#include <linux/fs.h>
+#include <linux/types.h>
+
+#include "led_engine.h"
+#include "led_proto.h"
+#include "led_uapi.h"
+
+struct attribute_group;
+struct cpumask;
+struct device;
+struct gpio_desc;
+struct task_struct;
+
+#define HIGH 1
+#define LOW  0
+
+extern int sw[SW_NUM];
+extern int led[LED_NUM];
+
+// /sys/kernel/led_control/stats 에 나가는 값
+struct led_stats {
+    u64 ticks;
+    u64 last_late_ns;
+    u64 max_late_ns;
+    bool sync_enabled;
+    u64 sync_samples;
+    s64 sync_last_error_ns;
+    s64 sync_max_error_ns;
+    u64 sync_abs_error_sum_ns;
+    u64 tick_last_cost_ns;   // 엔진 tick 처리 시간
+    u64 tick_max_cost_ns;
+    u64 tick_cost_sum_ns;
+    u64 writes;              // dev_write 호출 수와 처리 시간
+    u64 write_max_cost_ns;
+    u64 write_cost_sum_ns;
+    u64 usage_ns;              // LED 사용량 집계 시간
+    u64 usage_window_ns;
+    u64 led_on_ns[LED_NUM];    // 누적 켜진 시간
+    u64 led_toggles[LED_NUM];  // 핀 레벨 전환 횟수
+    u32 led_duty[LED_NUM];     // 지난 창의 duty (permille)
+};
+
+// led_module.c
+void led_handle_gesture(int gesture, u32 sw_mask);
+void led_switch_edge(u32 held);
+void led_pattern_install(struct led_pattern_lib *lib);
+int led_mode_get(void);
+int led_mode_set(int new_mode);
+u32 led_mask_get(void);
+void led_mask_set(u32 mask);
+u64 led_period_get(void);
+int led_period_set(u64 ns);
+unsigned int led_brightness_get(void);
+int led_brightness_set(unsigned int pct);
+void led_stats_get(struct led_stats *st);
+int led_command(const char *cmd, char *arg);
+void led_engine_kick(void);
+u64 led_engine_next_due(void);
+void led_engine_run(u64 now);
+void led_output_refresh(void);
+
+// led_events.c
+extern const struct file_operations led_event_fops;
+void led_emit_event(u16 type, u16 code, u32 value);
+void led_trace_input(u16 type, u16 code, u32 value);
+u32 led_event_head(void);
+int led_event_fetch(u32 *tail, struct led_event *out, int max);
+
+// led_netlink.c
+int led_netlink_init(void);
+void led_netlink_exit(void);
+void led_netlink_kick(void);
+
+// led_pattern.c
+int led_pattern_decode(const u8 *data, size_t size, struct led_pattern_lib **out);
+void led_pattern_free(struct led_pattern_lib *lib);
+int led_pattern_find(const struct led_pattern_lib *lib, const char *arg);
+int led_pattern_fw_path(char *buf, size_t size, const char *name);
+int led_pattern_request(struct device *dev, const char *name);
+
+// led_layer.c
+int led_blend_parse(const char *name);
+int led_layer_set(int n, int blend, u32 mask, const struct led_pattern *pat, u32 value);
+int led_layer_off(int n);
+void led_layer_relink(const struct led_pattern_lib *lib);
+u64 led_layer_next(void);
+void led_layer_step(u64 now);
+u32 led_layer_compose(u32 base);
+
+// led_session.c
+struct led_session;
+struct led_session *led_session_open(void);
+void led_session_close(struct led_session *sess);
+ssize_t led_session_write(struct led_session *sess, const void *data, size_t avail, bool nonblock);
+int led_session_fasync(int fd, struct file *file, int on);
+void led_session_signal(void);
+void led_session_consumed(struct led_session *sess);
+bool led_session_pending(void);
+bool led_session_drain(void);
+bool led_session_update(struct led_session *sess, u32 set, u32 clr, u32 claim);
+u32 led_session_compose(u32 base);
+
+// led_mmio.c
+struct vm_area_struct;
+int led_mmio_mmap(struct led_session *sess, struct vm_area_struct *vma);
+void led_mmio_release(struct led_session *sess);
+u64 led_mmio_next(void);
+bool led_mmio_poll(u64 now);
+void led_mmio_publish(u32 out);
+
+// led_sched.c
+extern const struct attribute_group led_sched_group;
+void led_sched_init(struct task_struct *task);
+void led_sched_exit(void);
+
+// led_sysfs.c
+enum led_sysfs_attr {
+    LED_ATTR_MODE,
+    LED_ATTR_LED_MASK,
+    LED_ATTR_PERIOD,
+    LED_ATTR_BRIGHTNESS,
+    LED_ATTR_COUNT,
+};
+int led_sysfs_init(void);
+void led_sysfs_exit(void);
+void led_sysfs_notify(enum led_sysfs_attr attr);
+
+// led_gesture.c
+struct led_sw_line;
+void led_gesture_init(void);
+void led_gesture_exit(void);
+u32 led_gesture_held(void);
+int led_gesture_set_affinity(const struct cpumask *mask);
+int led_gesture_inject(u32 held);
+u64 led_gesture_next(void);
+void led_gesture_expire(u64 now);
+struct led_sw_line *led_gesture_line_get(struct gpio_desc *desc);
+void led_gesture_line_put(struct led_sw_line *line);
+void led_gesture_bind(struct led_sw_line *const *lines);
+
+// led_pinmap.c
+int led_pinmap_setup(struct device *dev, const char *label, u32 handed, u32 level);
+void led_pinmap_release(bool keep);
+void led_pinmap_write(u32 mask);
+int led_pinmap_init(void);
+void led_pinmap_exit(void);
+
+// led_clock.c
+bool led_clock_is_virtual(void);
+u64 led_clock_ns(void);
+int led_clock_advance(u64 until);
+
+#endif
@@ -0,0 +1,297 @@
+#include <linux/bitops.h>
+#include <linux/bits.h>
+#include <linux/limits.h>
+#include <linux/math64.h>
+#include <linux/string.h>
+
+#include "led_engine.h"
+
+#define NS_PER_MS 1000000ULL
+
+static void engine_output(struct led_engine *eng, u32 mask) {
+    eng->mask = mask;
+    eng->changed = true;
+}
+
+void led_engine_init(struct led_engine *eng, u64 period_ns, unsigned int insn_budget) {
+    memset(eng, 0, sizeof(*eng));
+    eng->mode = LED_MODE_RESET;
+    eng->period_ns = period_ns;
+    eng->insn_budget = insn_budget;
+}
+
+// 리셋/수동: 전부 끄고 tick 없음
+static u64 off_enter(struct led_engine *eng) {
+    engine_output(eng, 0);
+    return LED_ENGINE_STOP;
+}
+
+// 수동 모드 제스처
+//  PRESS  : 해당 LED 토글
+//  DOUBLE : 해당 LED 만 켬
+//  CHORD  : 같이 누른 스위치대로 LED 설정
+//  LONG   : 리셋
+static int manual_gesture(struct led_engine *eng, int gesture, u32 sw_mask) {
+    switch (gesture) {
+    case LED_GESTURE_PRESS:
+        engine_output(eng, eng->mask ^ BIT(__ffs(sw_mask)));
+        return 0;
+    case LED_GESTURE_DOUBLE:
+        engine_output(eng, BIT(__ffs(sw_mask)));
+        return 0;
+    case LED_GESTURE_CHORD:
+        engine_output(eng, sw_mask & LED_MASK_ALL);
+        return 0;
+    }
+    return LED_MODE_RESET;
+}
+
+#if defined(CONFIG_LED_MODE_BLINK) || defined(CONFIG_LED_MODE_SEQ)
+// 전체/순차: 한 주기 뒤 첫 tick (출력은 그대로)
+static u64 periodic_enter(struct led_engine *eng) {
+    return eng->period_ns;
+}
+#endif
+
+#ifdef CONFIG_LED_MODE_BLINK
+static u64 blink_tick(struct led_engine *eng) {
+    engine_output(eng, eng->flag ? 0 : LED_MASK_ALL);
+    eng->flag = !eng->flag;
+    return eng->period_ns;
+}
+#endif
+
+#ifdef CONFIG_LED_MODE_SEQ
+static u64 seq_tick(struct led_engine *eng) {
+    engine_output(eng, BIT(eng->led_index));
+    eng->led_index = (eng->led_index + 1) % LED_NUM;
+    return eng->period_ns;
+}
+#endif
+
+#ifdef CONFIG_LED_MODE_PROGRAM
+static bool program_ready(const struct led_engine *eng) {
+    return eng->vm.len != 0;
+}
+
+// 처음부터 바로 실행
+static u64 program_enter(struct led_engine *eng) {
+    led_vm_reset(&eng->vm);
+    return 0;
+}
+
+// 다른 모드로 가면 WAITSW 를 풀어 스위치 엣지가 엔진을 깨우지 않게 한다
+static void program_exit(struct led_engine *eng) {
+    eng->vm.wait_sw = 0;
+}
+
+static u64 program_tick(struct led_engine *eng) {
+    int ret = led_vm_run(&eng->vm, eng->switches, eng->insn_budget);
+
+    engine_output(eng, eng->vm.mask);
+    if (ret == LED_VM_HALT) {
+        eng->status = LED_ENGINE_HALTED;
+    } else if (ret == LED_VM_FAULT) {
+        eng->status = LED_ENGINE_FAULT;
+    }
+    return ret < 0 ? LED_ENGINE_STOP : (u64)(ret > 1 ? ret : 1) * NS_PER_MS;
+}
+#endif
+
+#ifdef CONFIG_LED_MODE_PATTERN
+static bool pattern_ready(const struct led_engine *eng) {
+    return eng->patterns != NULL;
+}
+
+// 첫 프레임부터 바로 재생
+static u64 pattern_enter(struct led_engine *eng) {
+    eng->frame_index = 0;
+    return 0;
+}
+
+static u64 pattern_tick(struct led_engine *eng) {
+    const struct led_pattern *pat;
+
+    if (!eng->patterns || eng->pattern_sel >= eng->patterns->count) {
+        return LED_ENGINE_STOP;
+    }
+    pat = &eng->patterns->patterns[eng->pattern_sel];
+
+    if (eng->frame_index >= pat->nframes) {
+        if (!pat->loop) {
+            eng->status = LED_ENGINE_FINISHED;
+            return LED_ENGINE_STOP;
+        }
+        eng->frame_index = 0;
+    }
+
+    engine_output(eng, pat->frames[eng->frame_index].mask);
+    return (u64)pat->frames[eng->frame_index++].duration_ms * NS_PER_MS;
+}
+#endif
+
+// 모드 번호 -> 설명자. 리셋/수동은 항상 있고 나머지는 빌드 옵션으로 고른다
+static const struct led_mode_desc led_modes[LED_MODE_MAX + 1] = {
+#ifdef CONFIG_LED_MODE_BLINK
+    [LED_MODE_BLINK] = {
+        .name = "blink",
+        .needs_timer = true,
+        .sync = LED_SYNC_PERIOD,
+        .on_enter = periodic_enter,
+        .tick = blink_tick,
+    },
+#endif
+#ifdef CONFIG_LED_MODE_SEQ
+    [LED_MODE_SEQ] = {
+        .name = "seq",
+        .needs_timer = true,
+        .sync = LED_SYNC_PERIOD,
+        .on_enter = periodic_enter,
+        .tick = seq_tick,
+    },
+#endif
+    [LED_MODE_MANUAL] = {
+        .name = "manual",
+        .on_enter = off_enter,
+        .on_gesture = manual_gesture,
+    },
+    [LED_MODE_RESET] = {
+        .name = "reset",
+        .on_enter = off_enter,
+    },
+#ifdef CONFIG_LED_MODE_PROGRAM
+    [LED_MODE_PROGRAM] = {
+        .name = "program",
+        .needs_timer = true,
+        .ready = program_ready,
+        .on_enter = program_enter,
+        .on_exit = program_exit,
+        .tick = program_tick,
+    },
+#endif
+#ifdef CONFIG_LED_MODE_PATTERN
+    [LED_MODE_PATTERN] = {
+        .name = "pattern",
+        .needs_timer = true,
+        .sync = LED_SYNC_RESTART,
+        .ready = pattern_ready,
+        .on_enter = pattern_enter,
+        .tick = pattern_tick,
+    },
+#endif
+};
+
+// 빌드에 들어 있지 않거나 없는 번호면 NULL
+const struct led_mode_desc *led_mode_desc(int mode) {
+    if (mode < LED_MODE_BLINK || mode > LED_MODE_MAX || !led_modes[mode].name) {
+        return NULL;
+    }
+    return &led_modes[mode];
+}
+
+// 모드 전환. 첫 tick 까지의 ns 를 반환 (모드는 호출하는 쪽이 led_mode_desc 로 확인)
+u64 led_engine_set_mode(struct led_engine *eng, int mode) {
+    const struct led_mode_desc *old = led_mode_desc(eng->mode);
+    const struct led_mode_desc *desc = led_mode_desc(mode);
+
+    if (old && old->on_exit) {
+        old->on_exit(eng);
+    }
+    eng->mode = mode;
+    eng->changed = false;
+    eng->status = LED_ENGINE_OK;
+    return desc ? desc->on_enter(eng) : LED_ENGINE_STOP;
+}
+
+// 동기화 경계 번호 k 로 전체/순차 모드 위상을 정한다.
+// 같은 시계를 쓰는 보드끼리 같은 모양이 된다.
+void led_engine_sync(struct led_engine *eng, u64 k) {
+    eng->flag = k & 1;
+    eng->led_index = k % LED_NUM;
+}
+
+// 현재 모드의 한 tick. 다음 tick 까지의 ns 를 반환
+u64 led_engine_step(struct led_engine *eng) {
+    const struct led_mode_desc *desc = led_mode_desc(eng->mode);
+
+    eng->changed = false;
+    eng->status = LED_ENGINE_OK;
+    return desc && desc->tick ? desc->tick(eng) : LED_ENGINE_STOP;
+}
+
+// 스위치 제스처. 바꿀 모드를 반환하고, 0 이면 모드는 그대로 (출력을 바꿨으면 changed).
+// 모드가 따로 정하지 않으면 PRESS/DOUBLE 은 SW[i] 에 해당하는 모드(i + 1), 나머지는 리셋
+int led_engine_gesture(struct led_engine *eng, int gesture, u32 sw_mask) {
+    const struct led_mode_desc *desc = led_mode_desc(eng->mode);
+    int mode;
+
+    eng->changed = false;
+    if (desc && desc->on_gesture) {
+        return desc->on_gesture(eng, gesture, sw_mask);
+    }
+    if (gesture == LED_GESTURE_PRESS || gesture == LED_GESTURE_DOUBLE) {
+        mode = LED_MODE_BLINK + __ffs(sw_mask);
+        return led_mode_desc(mode) ? mode : 0;
+    }
+    return LED_MODE_RESET;
+}
+
+// now (엔진 시각) 이후 첫 경계를 찾는다. offset = 기준 시계 - 엔진 시계.
+// offset 을 매번 새로 받으므로 REALTIME 이 NTP 등으로 조정돼도 다음 경계부터 따라간다.
+void led_phase_next(struct led_phase *ph, u64 period_ns, u64 now, s64 offset) {
+    s64 t = (s64)now + offset;
+
+    if (t <= (s64)ph->start_ns) {
+        ph->step = 0;
+    } else {
+        ph->step = div64_u64(t - ph->start_ns + period_ns - 1, period_ns);
+    }
+    ph->boundary_ns = ph->start_ns + ph->step * period_ns - offset;
+}
+
+// 경계에서 깨어난 시각 now 의 위상 오차 (늦으면 양수)
+s64 led_phase_error(const struct led_phase *ph, u64 period_ns, u64 now, s64 offset) {
+    return ((s64)now + offset) - (s64)(ph->start_ns + ph->step * period_ns);
+}
+
+// tick 하나를 마친 뒤 다음 tick 의 절대 시각, 0 이면 정지.
+// tick_ns 는 방금 돈 tick 의 예정 시각, delay 는 led_engine_step 의 반환값이다.
+// 늦게 깨어나도 예정 시각에 더하므로 tick 이 밀려 쌓이지 않는다.
+// ph 가 있으면 (위상 고정 중) 모드의 sync 방식대로 경계에 맞춘다
+u64 led_engine_next_tick(struct led_phase *ph, enum led_mode_sync sync, u64 period_ns,
+                         u64 tick_ns, u64 delay, u64 now, s64 offset) {
+    u64 next;
+
+    if (!ph || sync == LED_SYNC_NONE) {
+        return delay == LED_ENGINE_STOP ? 0 : tick_ns + delay;
+    }
+    if (sync == LED_SYNC_PERIOD) {
+        led_phase_next(ph, period_ns, now + 1, offset);
+        return ph->boundary_ns;
+    }
+    // 패턴이 주기보다 짧으면 경계까지 마지막 프레임 유지, 길면 경계에서 자른다
+    next = delay == LED_ENGINE_STOP ? ph->boundary_ns : tick_ns + delay;
+    return next < ph->boundary_ns ? next : ph->boundary_ns;
+}
+
+// 엔진 스레드가 다음에 깨어날 시각. 할 일이 없으면 U64_MAX
+u64 led_engine_next_wake(const struct led_wake *w) {
+    u64 wake = U64_MAX;
+
+    if (w->pending) {
+        return 0;
+    }
+    if (w->armed) {
+        wake = w->tick_ns;
+    }
+    if (w->layer_ns && w->layer_ns < wake) {
+        wake = w->layer_ns;
+    }
+    if (w->mmio_ns && w->mmio_ns < wake) {
+        wake = w->mmio_ns;
+    }
+    if (w->pwm && w->pwm_ns < wake) {
+        wake = w->pwm_ns;
+    }
+    return wake;
+}
@@ -0,0 +1,111 @@
+#ifndef LED_ENGINE_H
+#define LED_ENGINE_H
+
+// 모드 엔진: 전체/순차/수동/리셋/프로그램/패턴 모드의 tick 로직 (커널 API 를 쓰지 않는 순수 로직)
+// 모듈과 native 시뮬레이터(ledsim)가 같은 소스를 빌드한다.
+// 시계와 GPIO 는 다루지 않는다. 호출하는 쪽이 "다음 tick 까지 몇 ns" 를 받아 재우고,
+// changed 가 서 있으면 mask 를 출력에 반영한다. 다음 tick/깨어날 시각 계산도 여기서
+// 하며, 현재 시각과 시계 차이는 호출하는 쪽이 넘긴다.
+
+#include <linux/types.h>
+
+#include "led_uapi.h"
+#include "led_vm.h"
+
+#define LED_ENGINE_STOP ((u64)-1)  // 다음 tick 없음
+
+// 디코딩된 패턴 (프레임 테이블)
+struct led_frame {
+    u8 mask;
+    u32 duration_ms;
+};
+
+struct led_pattern {
+    char name[LED_PAT_NAME_LEN];
+    bool loop;
+    u16 nframes;
+    struct led_frame *frames;
+};
+
+struct led_pattern_lib {
+    u16 count;
+    struct led_pattern patterns[]; // 뒤에 모든 패턴의 프레임이 이어 붙는다
+};
+
+// 마지막 step 이 멈춘 이유
+enum led_engine_status {
+    LED_ENGINE_OK,
+    LED_ENGINE_HALTED,   // 프로그램이 END 에 도달
+    LED_ENGINE_FAULT,    // 프로그램 명령어 예산 초과
+    LED_ENGINE_FINISHED, // 반복하지 않는 패턴이 끝남
+};
+
+struct led_engine {
+    int mode;
+    u64 period_ns;             // 전체/순차 모드 주기
+    unsigned int insn_budget;  // tick 한 번에 실행할 바이트코드 명령어 수
+    u32 switches;              // 눌려 있는 스위치 (프로그램 WAITSW 입력)
+    u32 mask;                  // 모드 출력
+    bool changed;              // 이번 호출에서 mask 를 새로 정함
+    int status;
+    int flag;                  // 전체 모드 위상 (1 이면 다음 tick 에 끔)
+    int led_index;             // 순차 모드에서 다음에 켤 LED
+    struct led_vm vm;
+    const struct led_pattern_lib *patterns;
+    int pattern_sel;
+    int frame_index;
+};
+
+// 외부 시계 위상 고정을 어떻게 받는지
+enum led_mode_sync {
+    LED_SYNC_NONE,
+    LED_SYNC_PERIOD,   // 주기 경계마다 tick, 위상은 led_engine_sync 로
+    LED_SYNC_RESTART,  // 주기 경계마다 처음부터 다시
+};
+
+// 외부 시계 위상: 기준 시계(MONOTONIC/REALTIME)로 start_ns + k * period_ns 경계
+struct led_phase {
+    u64 start_ns;         // 기준 시계로 본 시작 시각
+    u64 step;             // 다음 경계 번호 k
+    u64 boundary_ns;      // 다음 경계의 엔진 시각
+};
+
+// 엔진 스레드를 깨우는 일들 (엔진 시각)
+struct led_wake {
+    bool pending;         // 세션 요청이 밀려 있다 (바로 깨어남)
+    bool armed;           // tick_ns 에 tick 이 예약돼 있다
+    u64 tick_ns;
+    u64 layer_ns;         // 다음 레이어 프레임, 0 이면 없음
+    u64 mmio_ns;          // 다음 mmio 폴링, 0 이면 없음
+    bool pwm;             // PWM 이 돌고 있다
+    u64 pwm_ns;
+};
+
+// 모드 설명자. 모드 번호로 찾는 const 표(led_engine.c)에 들어 있고,
+// 빌드 옵션 CONFIG_LED_MODE_* 로 뺀 모드는 표에 없다 (led_mode_desc 가 NULL)
+struct led_mode_desc {
+    const char *name;
+    bool needs_timer;          // tick 이 돈다
+    enum led_mode_sync sync;
+    bool (*ready)(const struct led_engine *eng);       // 고를 수 있는지 (프로그램/패턴이 올라와 있는지)
+    u64 (*on_enter)(struct led_engine *eng);           // 첫 tick 까지의 ns
+    void (*on_exit)(struct led_engine *eng);
+    u64 (*tick)(struct led_engine *eng);               // 다음 tick 까지의 ns
+    int (*on_gesture)(struct led_engine *eng, int gesture, u32 sw_mask);  // 없으면 기본 동작
+};
+
+const struct led_mode_desc *led_mode_desc(int mode);
+void led_engine_init(struct led_engine *eng, u64 period_ns, unsigned int insn_budget);
+u64 led_engine_set_mode(struct led_engine *eng, int mode);
+u64 led_engine_step(struct led_engine *eng);
+void led_engine_sync(struct led_engine *eng, u64 k);
+int led_engine_gesture(struct led_engine *eng, int gesture, u32 sw_mask);
+
+// 시각 계산 (tick 예약, 위상 고정, 엔진 스레드 깨우기)
+void led_phase_next(struct led_phase *ph, u64 period_ns, u64 now, s64 offset);
+s64 led_phase_error(const struct led_phase *ph, u64 period_ns, u64 now, s64 offset);
+u64 led_engine_next_tick(struct led_phase *ph, enum led_mode_sync sync, u64 period_ns,
+                         u64 tick_ns, u64 delay, u64 now, s64 offset);
+u64 led_engine_next_wake(const struct led_wake *w);
+
+#endif
@@ -0,0 +1,174 @@
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/poll.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/uio.h>
+#include <linux/wait.h>
+
+#include "led_control.h"
+
+// 이벤트 링 버퍼: 쓰는 쪽은 하나, 읽는 쪽은 open 한 파일마다 자기 위치(tail)만 가진다.
+// 읽는 쪽마다 복사본을 두지 않으므로 reader 수가 늘어도 emit 비용은 같다.
+#define EVENT_RING_SIZE 256
+#define EVENT_READ_CHUNK 16
+
+static struct led_event ring[EVENT_RING_SIZE];
+static u32 ring_head; // 지금까지 기록된 이벤트 수
+static DEFINE_SPINLOCK(ring_lock);
+static DECLARE_WAIT_QUEUE_HEAD(ring_wait);
+
+struct event_reader {
+    u32 tail;
+};
+
+// 드라이버가 받은 입력(명령 모드, 세션, 요청)도 이벤트로 남긴다. 요청이 많으면 링이 금방 넘치므로 기본은 끔
+static bool trace_inputs;
+module_param(trace_inputs, bool, 0644);
+MODULE_PARM_DESC(trace_inputs, "also emit LED_EV_INPUT_* events for commands and session requests (recording)");
+
+// IRQ 를 포함한 어느 context 에서든 호출 가능
+void led_emit_event(u16 type, u16 code, u32 value) {
+    struct led_event *ev;
+    unsigned long flags;
+
+    spin_lock_irqsave(&ring_lock, flags);
+    ev = &ring[ring_head % EVENT_RING_SIZE];
+    ev->timestamp_ns = led_clock_ns();
+    ev->type = type;
+    ev->code = code;
+    ev->value = value;
+    ring_head++;
+    spin_unlock_irqrestore(&ring_lock, flags);
+
+    wake_up_interruptible(&ring_wait);
+    led_netlink_kick();
+    if (type == LED_EV_SWITCH || type == LED_EV_GESTURE || type == LED_EV_MODE) {
+        led_session_signal();
+    }
+}
+
+// 입력 기록 이벤트. trace_inputs 가 꺼져 있으면 아무것도 하지 않는다
+void led_trace_input(u16 type, u16 code, u32 value) {
+    if (READ_ONCE(trace_inputs)) {
+        led_emit_event(type, code, value);
+    }
+}
+
+// 모듈 안에서 링을 따라가는 reader (netlink 등) 의 시작 위치
+u32 led_event_head(void) {
+    unsigned long flags;
+    u32 head;
+
+    spin_lock_irqsave(&ring_lock, flags);
+    head = ring_head;
+    spin_unlock_irqrestore(&ring_lock, flags);
+    return head;
+}
+
+static int event_open(struct inode *inode, struct file *file) {
+    struct event_reader *reader;
+
+    reader = kzalloc(sizeof(*reader), GFP_KERNEL);
+    if (!reader) {
+        return -ENOMEM;
+    }
+
+    // open 이후 발생한 이벤트만 받는다
+    reader->tail = led_event_head();
+
+    file->private_data = reader;
+    file->f_mode |= FMODE_NOWAIT;
+    return nonseekable_open(inode, file);
+}
+
+static int event_release(struct inode *inode, struct file *file) {
+    kfree(file->private_data);
+    return 0;
+}
+
+// tail 위치에서 최대 max 개를 꺼낸다. 너무 뒤처졌으면 OVERRUN 이벤트를 먼저 넣는다.
+int led_event_fetch(u32 *tail, struct led_event *out, int max) {
+    unsigned long flags;
+    u32 lost;
+    int n = 0;
+
+    spin_lock_irqsave(&ring_lock, flags);
+    lost = ring_head - *tail;
+    if (lost > EVENT_RING_SIZE) {
+        lost -= EVENT_RING_SIZE;
+        *tail = ring_head - EVENT_RING_SIZE;
+        out[n].timestamp_ns = led_clock_ns();
+        out[n].type = LED_EV_OVERRUN;
+        out[n].code = 0;
+        out[n].value = lost;
+        n++;
+    }
+    while (n < max && *tail != ring_head) {
+        out[n++] = ring[*tail % EVENT_RING_SIZE];
+        (*tail)++;
+    }
+    spin_unlock_irqrestore(&ring_lock, flags);
+
+    return n;
+}
+
+static bool event_pending(struct event_reader *reader) {
+    return READ_ONCE(ring_head) != reader->tail;
+}
+
+// IOCB_NOWAIT (io_uring) 나 O_NONBLOCK 이면 쌓인 이벤트가 없을 때 -EAGAIN
+static ssize_t event_read_iter(struct kiocb *iocb, struct iov_iter *to) {
+    struct file *file = iocb->ki_filp;
+    struct event_reader *reader = file->private_data;
+    struct led_event chunk[EVENT_READ_CHUNK];
+    size_t max = iov_iter_count(to) / sizeof(struct led_event);
+    size_t done = 0, bytes;
+    int n, ret;
+
+    if (max == 0) {
+        return -EINVAL;
+    }
+
+    while (!event_pending(reader)) {
+        if ((iocb->ki_flags & IOCB_NOWAIT) || (file->f_flags & O_NONBLOCK)) {
+            return -EAGAIN;
+        }
+        ret = wait_event_interruptible(ring_wait, event_pending(reader));
+        if (ret) {
+            return ret;
+        }
+    }
+
+    while (done < max) {
+        n = led_event_fetch(&reader->tail, chunk, min_t(size_t, max - done, EVENT_READ_CHUNK));
+        if (n == 0) {
+            break;
+        }
+        bytes = n * sizeof(struct led_event);
+        if (copy_to_iter(chunk, bytes, to) != bytes) {
+            return -EFAULT;
+        }
+        done += n;
+    }
+
+    return done * sizeof(struct led_event);
+}
+
+static __poll_t event_poll(struct file *file, poll_table *wait) {
+    struct event_reader *reader = file->private_data;
+
+    poll_wait(file, &ring_wait, wait);
+    return event_pending(reader) ? EPOLLIN | EPOLLRDNORM : 0;
+}
+
+const struct file_operations led_event_fops = {
+    .owner = THIS_MODULE,
+    .open = event_open,
+    .release = event_release,
+    .read_iter = event_read_iter,
+    .poll = event_poll,
+    .llseek = no_llseek,
+};
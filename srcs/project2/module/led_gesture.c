@@ -0,0 +1,378 @@
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/cpumask.h>
+#include <linux/gpio/consumer.h>
+#include <linux/hrtimer.h>
+#include <linux/interrupt.h>
+#include <linux/ktime.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+
+#include "led_control.h"
+#include "led_gesture_fsm.h"
+
+// 스위치 제스처 인식
+// IRQ 에서 찍은 타임스탬프와 IRQ 스레드에서 읽은 레벨을 상태 머신(led_gesture_fsm.c)에 넣고,
+// 인식된 제스처(짧게/길게/두 번/동시 누름)만 모드 로직과 이벤트 링으로 올린다.
+// 여기는 잠금, deadline hrtimer, IRQ 와 GPIO 만 다룬다.
+// 라인(GPIO + IRQ)은 led_pinmap.c 가 잡아 led_gesture_line_get 으로 IRQ 를 걸고,
+// led_gesture_bind 로 SW[i] 자리에 한꺼번에 붙인다.
+
+static unsigned int debounce_ms = 20;
+module_param(debounce_ms, uint, 0644);
+MODULE_PARM_DESC(debounce_ms, "switch debounce window (ms)");
+
+static unsigned int long_press_ms = 700;
+module_param(long_press_ms, uint, 0644);
+MODULE_PARM_DESC(long_press_ms, "hold time for a long press (ms)");
+
+static unsigned int double_press_ms = 250;
+module_param(double_press_ms, uint, 0644);
+MODULE_PARM_DESC(double_press_ms, "second-press window for a double press, 0 disables (ms)");
+
+static unsigned int chord_ms = 80;
+module_param(chord_ms, uint, 0644);
+MODULE_PARM_DESC(chord_ms, "max gap between presses that form a chord (ms)");
+
+// 시험용 스위치 주입 ("inject <mask>" 명령). 보드 없이 스트레스 도구가 제스처 경로를 돌릴 때만 켠다
+static bool allow_inject;
+module_param(allow_inject, bool, 0644);
+MODULE_PARM_DESC(allow_inject, "accept the \"inject <mask>\" command that simulates switch edges (testing only)");
+
+// SW[i] 자리: 붙은 라인과 deadline 타이머. 상태 머신은 led_gesture_fsm.c
+struct sw_gesture {
+    int index;
+    struct led_sw_line *line;  // 붙어 있는 라인, NULL 이면 없음
+    u64 timer_ns;              // hrtimer 를 걸어 둔 deadline, 0 이면 없음
+    struct hrtimer timer;
+};
+
+// IRQ 를 걸어 둔 스위치 라인
+struct led_sw_line {
+    struct list_head node;
+    struct gpio_desc *desc;
+    int irq;
+    u64 irq_ns;             // 하드 IRQ 에서 찍은 엣지 시각 (IRQ 스레드가 씀)
+    struct sw_gesture *g;   // 붙은 스위치, NULL 이면 대기 중 (gesture_lock)
+};
+
+static struct sw_gesture gestures[SW_NUM];
+static struct led_gesture_fsm fsm;
+static DEFINE_SPINLOCK(gesture_lock);
+
+// 대기 중인 것까지 IRQ 를 건 라인 전부와 irq_cpus 로 받은 CPU (새 라인에도 건다)
+static LIST_HEAD(sw_lines);
+static DEFINE_MUTEX(sw_lines_mutex);
+static struct cpumask sw_affinity;
+static bool sw_affinity_set;
+
+static void gesture_cfg(struct led_gesture_cfg *cfg) {
+    cfg->debounce_ns = (u64)READ_ONCE(debounce_ms) * NSEC_PER_MSEC;
+    cfg->long_press_ns = (u64)READ_ONCE(long_press_ms) * NSEC_PER_MSEC;
+    cfg->double_press_ns = (u64)READ_ONCE(double_press_ms) * NSEC_PER_MSEC;
+    cfg->chord_ns = (u64)READ_ONCE(chord_ms) * NSEC_PER_MSEC;
+}
+
+// 상태 머신의 deadline 을 hrtimer 에 맞춘다. deadline 은 led_clock_ns 기준 절대 시각이다.
+// 가상 시계면 타이머 대신 led_clock_advance 가 led_gesture_next 를 보고 led_gesture_expire 를 부른다
+// (gesture_lock 잡은 상태에서 호출)
+static void gesture_sync_timers(void) {
+    int i;
+
+    if (led_clock_is_virtual()) {
+        return;
+    }
+    for (i = 0; i < SW_NUM; i++) {
+        struct sw_gesture *g = &gestures[i];
+        u64 deadline = fsm.sw[i].deadline_ns;
+
+        if (deadline == g->timer_ns) {
+            continue;
+        }
+        g->timer_ns = deadline;
+        if (deadline) {
+            hrtimer_start(&g->timer, ns_to_ktime(deadline), HRTIMER_MODE_ABS);
+        } else {
+            hrtimer_try_to_cancel(&g->timer);
+        }
+    }
+}
+
+// 인식 결과는 gesture_lock 밖에서 전달한다
+static void gesture_report(int kind, u32 mask) {
+    led_emit_event(LED_EV_GESTURE, kind, mask);
+    led_handle_gesture(kind, mask);
+}
+
+static enum hrtimer_restart gesture_timer_cb(struct hrtimer *timer) {
+    struct sw_gesture *g = container_of(timer, struct sw_gesture, timer);
+    unsigned long flags;
+    int kind;
+
+    spin_lock_irqsave(&gesture_lock, flags);
+    kind = led_gesture_fsm_expire(&fsm, g->index, led_clock_ns());
+    // 이 타이머는 끝났다. 그 사이에 deadline 이 바뀌었으면 다시 건다
+    g->timer_ns = 0;
+    gesture_sync_timers();
+    spin_unlock_irqrestore(&gesture_lock, flags);
+
+    if (kind) {
+        gesture_report(kind, BIT(g->index));
+    }
+    return HRTIMER_NORESTART;
+}
+
+// 가장 이른 제스처 deadline, 없으면 U64_MAX (가상 시계용)
+u64 led_gesture_next(void) {
+    unsigned long flags;
+    u64 next;
+
+    spin_lock_irqsave(&gesture_lock, flags);
+    next = led_gesture_fsm_next(&fsm);
+    spin_unlock_irqrestore(&gesture_lock, flags);
+    return next;
+}
+
+// now 까지 지난 deadline 처리 (가상 시계용, 타이머 콜백과 같은 일)
+void led_gesture_expire(u64 now) {
+    unsigned long flags;
+    int kind, i;
+
+    for (i = 0; i < SW_NUM; i++) {
+        spin_lock_irqsave(&gesture_lock, flags);
+        kind = led_gesture_fsm_expire(&fsm, i, now);
+        spin_unlock_irqrestore(&gesture_lock, flags);
+
+        if (kind) {
+            gesture_report(kind, BIT(i));
+        }
+    }
+}
+
+// 스위치 레벨 변화 하나를 상태 머신에 넣는다 (gesture_lock 잡은 상태에서 호출)
+static int gesture_level(struct sw_gesture *g, int level, u64 now, bool *changed, u32 *mask) {
+    struct led_gesture_cfg cfg;
+    int kind;
+
+    gesture_cfg(&cfg);
+    kind = led_gesture_fsm_level(&fsm, &cfg, g->index, level, now, changed, mask);
+    gesture_sync_timers();
+    return kind;
+}
+
+// gesture_level 결과를 gesture_lock 밖에서 전달
+static void gesture_deliver(bool changed, u32 held, int kind, u32 mask) {
+    if (changed) {
+        led_emit_event(LED_EV_SWITCH, 0, held);
+        led_switch_edge(held);
+    }
+    if (kind) {
+        gesture_report(kind, mask);
+    }
+}
+
+// 어느 context 에서든 호출 가능
+static void gesture_edge(struct sw_gesture *g, int level, u64 now) {
+    unsigned long flags;
+    bool changed = false;
+    u32 mask = 0, held;
+    int kind;
+
+    spin_lock_irqsave(&gesture_lock, flags);
+    kind = gesture_level(g, level, now, &changed, &mask);
+    held = fsm.held;
+    spin_unlock_irqrestore(&gesture_lock, flags);
+
+    gesture_deliver(changed, held, kind, mask);
+}
+
+// 스위치 인터럽트 (양쪽 엣지). 하드 IRQ 에서는 시각만 찍고, 레벨은 IRQ 스레드에서 읽는다.
+// gpio-sim, I2C 확장 칩처럼 읽을 때 잠들 수 있는 칩이어도 되고, 제스처 시간은 엣지 시각 그대로다
+static irqreturn_t gesture_irq(int irq, void *dev_id) {
+    struct led_sw_line *line = dev_id;
+
+    line->irq_ns = led_clock_ns();
+    return IRQ_WAKE_THREAD;
+}
+
+// IRQF_ONESHOT 이라 이 스레드가 끝날 때까지 같은 라인의 IRQ 는 막혀 있다.
+// 아직 어느 스위치에도 붙지 않은(또는 떼어 낸) 라인의 엣지는 버린다
+static irqreturn_t gesture_irq_thread(int irq, void *dev_id) {
+    struct led_sw_line *line = dev_id;
+    int level = gpiod_get_value_cansleep(line->desc) ? HIGH : LOW;
+    unsigned long flags;
+    bool changed = false;
+    u32 mask = 0, held;
+    int kind = 0;
+
+    spin_lock_irqsave(&gesture_lock, flags);
+    if (line->g) {
+        kind = gesture_level(line->g, level, line->irq_ns, &changed, &mask);
+    }
+    held = fsm.held;
+    spin_unlock_irqrestore(&gesture_lock, flags);
+
+    gesture_deliver(changed, held, kind, mask);
+    return IRQ_HANDLED;
+}
+
+// 스위치가 held 처럼 눌려 있는 것으로 엣지를 넣는다. 디바운스는 실제 스위치와 똑같이 걸린다
+int led_gesture_inject(u32 held) {
+    int i;
+
+    if (!READ_ONCE(allow_inject)) {
+        return -EPERM;
+    }
+    if (held & ~SW_MASK_ALL) {
+        return -EINVAL;
+    }
+    for (i = 0; i < SW_NUM; i++) {
+        gesture_edge(&gestures[i], (held & BIT(i)) ? HIGH : LOW, led_clock_ns());
+    }
+    return 0;
+}
+
+// 지금 눌려 있는 스위치 마스크 (디바운스 적용된 레벨)
+u32 led_gesture_held(void) {
+    return READ_ONCE(fsm.held);
+}
+
+// 스위치 IRQ 를 받을 CPU 지정. 나중에 거는 라인에도 같은 CPU 를 쓴다
+int led_gesture_set_affinity(const struct cpumask *mask) {
+    struct led_sw_line *line;
+    int ret = 0;
+
+    mutex_lock(&sw_lines_mutex);
+    list_for_each_entry(line, &sw_lines, node) {
+        ret = irq_set_affinity(line->irq, mask);
+        if (ret < 0) {
+            break;
+        }
+    }
+    if (ret == 0) {
+        cpumask_copy(&sw_affinity, mask);
+        sw_affinity_set = true;
+    }
+    mutex_unlock(&sw_lines_mutex);
+    return ret;
+}
+
+// 입력으로 잡아 둔 라인에 IRQ 를 건다. led_gesture_bind 로 붙이기 전까지 엣지는 버린다 (process context)
+struct led_sw_line *led_gesture_line_get(struct gpio_desc *desc) {
+    struct led_sw_line *line;
+    int ret;
+
+    line = kzalloc(sizeof(*line), GFP_KERNEL);
+    if (!line) {
+        return ERR_PTR(-ENOMEM);
+    }
+    line->desc = desc;
+    line->irq = gpiod_to_irq(desc);
+    if (line->irq < 0) {
+        ret = line->irq;
+        goto fail;
+    }
+    ret = request_threaded_irq(line->irq, gesture_irq, gesture_irq_thread,
+                               IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING | IRQF_ONESHOT, "led_sw", line);
+    if (ret < 0) {
+        goto fail;
+    }
+
+    // 붙기 전에 irq_cpus 를 맞춰 두어 바꾸는 순간부터 같은 CPU 에서 받는다
+    mutex_lock(&sw_lines_mutex);
+    if (sw_affinity_set && irq_set_affinity(line->irq, &sw_affinity) < 0) {
+        printk(KERN_WARNING "led_control: cannot apply irq_cpus to IRQ %d\n", line->irq);
+    }
+    list_add_tail(&line->node, &sw_lines);
+    mutex_unlock(&sw_lines_mutex);
+    return line;
+
+fail:
+    printk(KERN_ERR "Request IRQ failed for switch line (%d)\n", ret);
+    kfree(line);
+    return ERR_PTR(ret);
+}
+
+// 어느 스위치에도 붙어 있지 않은 라인의 IRQ 를 푼다. GPIO 는 호출한 쪽이 놓는다
+void led_gesture_line_put(struct led_sw_line *line) {
+    if (!line) {
+        return;
+    }
+    mutex_lock(&sw_lines_mutex);
+    list_del(&line->node);
+    mutex_unlock(&sw_lines_mutex);
+    free_irq(line->irq, line);
+    kfree(line);
+}
+
+// SW[i] 를 lines[i] 에 붙인다 (NULL 이면 빈 자리). 모든 자리를 gesture_lock 안에서 한 번에 바꾸고,
+// 라인이 바뀐 스위치는 눌려 있었으면 뗀 것으로 치고 진행 중인 제스처를 버린다.
+// 떼어 낸 라인은 IRQ 가 남아 있어도 엣지를 버리므로 호출한 쪽이 나중에 푼다 (process context)
+void led_gesture_bind(struct led_sw_line *const *lines) {
+    int level[SW_NUM];
+    unsigned long flags;
+    u32 released = 0, held;
+    int i;
+
+    // 새 라인의 처음 레벨 (읽다가 잠들 수 있어 잠그기 전에)
+    for (i = 0; i < SW_NUM; i++) {
+        level[i] = LOW;
+        if (lines[i] && lines[i] != gestures[i].line) {
+            level[i] = gpiod_get_value_cansleep(lines[i]->desc) ? HIGH : LOW;
+        }
+    }
+
+    spin_lock_irqsave(&gesture_lock, flags);
+    for (i = 0; i < SW_NUM; i++) {
+        if (gestures[i].line && gestures[i].line != lines[i]) {
+            gestures[i].line->g = NULL;
+        }
+    }
+    for (i = 0; i < SW_NUM; i++) {
+        struct sw_gesture *g = &gestures[i];
+
+        if (g->line == lines[i]) {
+            continue;
+        }
+        if (led_gesture_fsm_reset(&fsm, i, level[i])) {
+            released |= BIT(i);
+        }
+        g->line = lines[i];
+        if (g->line) {
+            g->line->g = g;
+        }
+    }
+    gesture_sync_timers();
+    held = fsm.held;
+    spin_unlock_irqrestore(&gesture_lock, flags);
+
+    if (released) {
+        led_emit_event(LED_EV_SWITCH, 0, held);
+        led_switch_edge(held);
+    }
+}
+
+// 상태 머신만 준비한다. 라인은 led_pinmap_init 이 붙인다
+void led_gesture_init(void) {
+    int i;
+
+    led_gesture_fsm_init(&fsm);
+    for (i = 0; i < SW_NUM; i++) {
+        struct sw_gesture *g = &gestures[i];
+
+        g->index = i;
+        hrtimer_init(&g->timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+        g->timer.function = gesture_timer_cb;
+    }
+}
+
+// 라인은 led_pinmap_exit 에서 이미 떼어 냈다
+void led_gesture_exit(void) {
+    int i;
+
+    for (i = 0; i < SW_NUM; i++) {
+        hrtimer_cancel(&gestures[i].timer);
+    }
+}
@@ -0,0 +1,163 @@
+#include <linux/bits.h>
+#include <linux/limits.h>
+#include <linux/string.h>
+
+#include "led_gesture_fsm.h"
+
+void led_gesture_fsm_init(struct led_gesture_fsm *fsm) {
+    memset(fsm, 0, sizeof(*fsm));
+}
+
+static void sw_arm(struct led_gesture_sw *g, u64 now, u64 ns) {
+    g->deadline_ns = now + ns;
+}
+
+static void sw_disarm(struct led_gesture_sw *g) {
+    g->deadline_ns = 0;
+}
+
+static void sw_press(struct led_gesture_fsm *fsm, const struct led_gesture_cfg *cfg, int i, u64 now) {
+    struct led_gesture_sw *g = &fsm->sw[i];
+    u32 bit = BIT(i);
+    int j;
+
+    fsm->held |= bit;
+    g->down_ns = now;
+
+    // 이미 chord 가 진행 중이면 합류
+    if (fsm->chord & fsm->held) {
+        fsm->chord |= bit;
+        g->state = LED_GS_CONSUMED;
+        return;
+    }
+
+    // chord_ns 안에 눌린 다른 스위치가 있으면 chord 시작
+    for (j = 0; j < SW_NUM; j++) {
+        struct led_gesture_sw *other = &fsm->sw[j];
+
+        if (j == i || !(fsm->held & BIT(j))) {
+            continue;
+        }
+        if ((other->state == LED_GS_DOWN || other->state == LED_GS_DOWN_SECOND) &&
+            now - other->down_ns <= cfg->chord_ns) {
+            fsm->chord |= bit | BIT(j);
+            other->state = LED_GS_CONSUMED;
+            sw_disarm(other);
+        }
+    }
+    if (fsm->chord) {
+        g->state = LED_GS_CONSUMED;
+        sw_disarm(g);
+        return;
+    }
+
+    g->state = (g->state == LED_GS_WAIT_SECOND) ? LED_GS_DOWN_SECOND : LED_GS_DOWN;
+    sw_arm(g, now, cfg->long_press_ns);
+}
+
+static int sw_release(struct led_gesture_fsm *fsm, const struct led_gesture_cfg *cfg, int i, u64 now,
+                      u32 *mask) {
+    struct led_gesture_sw *g = &fsm->sw[i];
+    u32 bit = BIT(i);
+
+    fsm->held &= ~bit;
+    *mask = bit;
+
+    switch (g->state) {
+    case LED_GS_DOWN:
+        sw_disarm(g);
+        if (cfg->double_press_ns == 0) {
+            g->state = LED_GS_IDLE;
+            return LED_GESTURE_PRESS;
+        }
+        g->state = LED_GS_WAIT_SECOND;
+        sw_arm(g, now, cfg->double_press_ns);
+        return 0;
+
+    case LED_GS_DOWN_SECOND:
+        sw_disarm(g);
+        g->state = LED_GS_IDLE;
+        return LED_GESTURE_DOUBLE;
+
+    case LED_GS_CONSUMED:
+        g->state = LED_GS_IDLE;
+        // chord 는 마지막 스위치가 떨어질 때 한 번만 보고
+        if ((fsm->chord & bit) && !(fsm->chord & fsm->held)) {
+            *mask = fsm->chord;
+            fsm->chord = 0;
+            return LED_GESTURE_CHORD;
+        }
+        return 0;
+
+    default:
+        g->state = LED_GS_IDLE;
+        return 0;
+    }
+}
+
+// SW[i] 의 레벨 변화 하나 (now 는 엣지 시각). 디바운스 후 상태 머신을 돌려 보고할 제스처를
+// 반환하고, 그 스위치 마스크를 mask 에 둔다. 디바운스를 통과해 held 가 바뀌었으면 changed
+int led_gesture_fsm_level(struct led_gesture_fsm *fsm, const struct led_gesture_cfg *cfg,
+                          int i, int level, u64 now, bool *changed, u32 *mask) {
+    struct led_gesture_sw *g = &fsm->sw[i];
+
+    level = !!level;
+    if (level == g->level || now - g->last_edge_ns < cfg->debounce_ns) {
+        return 0;
+    }
+    g->last_edge_ns = now;
+    g->level = level;
+    *changed = true;
+    if (level) {
+        sw_press(fsm, cfg, i, now);
+        return 0;
+    }
+    return sw_release(fsm, cfg, i, now, mask);
+}
+
+// SW[i] 의 deadline 이 지났으면 long press / 한 번 누름으로 확정. 보고할 제스처를 반환
+int led_gesture_fsm_expire(struct led_gesture_fsm *fsm, int i, u64 now) {
+    struct led_gesture_sw *g = &fsm->sw[i];
+
+    // 취소와 재무장이 겹친 경우의 늦은 타이머는 무시
+    if (!g->deadline_ns || now < g->deadline_ns) {
+        return 0;
+    }
+    g->deadline_ns = 0;
+    if (g->state == LED_GS_DOWN || g->state == LED_GS_DOWN_SECOND) {
+        g->state = LED_GS_CONSUMED;
+        return LED_GESTURE_LONG;
+    }
+    if (g->state == LED_GS_WAIT_SECOND) {
+        g->state = LED_GS_IDLE;
+        return LED_GESTURE_PRESS;
+    }
+    return 0;
+}
+
+// 가장 이른 deadline, 없으면 U64_MAX
+u64 led_gesture_fsm_next(const struct led_gesture_fsm *fsm) {
+    u64 next = U64_MAX;
+    int i;
+
+    for (i = 0; i < SW_NUM; i++) {
+        if (fsm->sw[i].deadline_ns && fsm->sw[i].deadline_ns < next) {
+            next = fsm->sw[i].deadline_ns;
+        }
+    }
+    return next;
+}
+
+// SW[i] 의 라인이 바뀌었다. 진행 중인 제스처를 버리고 새 라인의 레벨에서 다시 시작한다.
+// 눌려 있었으면 true (뗀 것으로 친다)
+bool led_gesture_fsm_reset(struct led_gesture_fsm *fsm, int i, int level) {
+    struct led_gesture_sw *g = &fsm->sw[i];
+    bool held = fsm->held & BIT(i);
+
+    fsm->held &= ~BIT(i);
+    fsm->chord &= ~BIT(i);
+    g->state = LED_GS_IDLE;
+    g->level = !!level;
+    sw_disarm(g);
+    return held;
+}
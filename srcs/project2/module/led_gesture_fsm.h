@@ -0,0 +1,50 @@
+#ifndef LED_GESTURE_FSM_H
+#define LED_GESTURE_FSM_H
+
+// 스위치 제스처 상태 머신 (커널 API 를 쓰지 않는 순수 로직)
+// GPIO 와 시계는 다루지 않는다. 호출하는 쪽이 스위치 레벨과 엣지 시각을 넣고 돌려받은
+// 제스처(LED_GESTURE_*)를 보고한다. 스위치마다의 deadline_ns 가 바뀌면 타이머를 다시 걸고,
+// 그 시각이 되면 led_gesture_fsm_expire 를 부른다.
+
+#include <linux/types.h>
+
+#include "led_uapi.h"
+
+// 시간 설정 (ns)
+struct led_gesture_cfg {
+    u64 debounce_ns;
+    u64 long_press_ns;
+    u64 double_press_ns;  // 0 이면 두 번 누름을 보지 않고 떼는 즉시 PRESS
+    u64 chord_ns;         // 이 안에 같이 눌리면 chord
+};
+
+enum led_gesture_state {
+    LED_GS_IDLE,        // 떼어진 상태
+    LED_GS_DOWN,        // 첫 번째 누름, long press 대기
+    LED_GS_WAIT_SECOND, // 한 번 눌렀다 뗌, 두 번째 누름 대기
+    LED_GS_DOWN_SECOND, // 두 번째 누름
+    LED_GS_CONSUMED,    // long press / chord 로 처리 끝, 떼기만 기다림
+};
+
+struct led_gesture_sw {
+    int level;            // 디바운스 적용된 레벨 (0 이 뗌)
+    u64 last_edge_ns;
+    u64 down_ns;
+    u64 deadline_ns;      // long press / 두 번째 누름 대기 끝, 0 이면 없음
+    enum led_gesture_state state;
+};
+
+struct led_gesture_fsm {
+    struct led_gesture_sw sw[SW_NUM];
+    u32 held;             // 지금 눌려 있는 스위치
+    u32 chord;            // 진행 중인 chord 에 참여한 스위치
+};
+
+void led_gesture_fsm_init(struct led_gesture_fsm *fsm);
+int led_gesture_fsm_level(struct led_gesture_fsm *fsm, const struct led_gesture_cfg *cfg,
+                          int i, int level, u64 now, bool *changed, u32 *mask);
+int led_gesture_fsm_expire(struct led_gesture_fsm *fsm, int i, u64 now);
+u64 led_gesture_fsm_next(const struct led_gesture_fsm *fsm);
+bool led_gesture_fsm_reset(struct led_gesture_fsm *fsm, int i, int level);
+
+#endif
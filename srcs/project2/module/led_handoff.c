@@ -0,0 +1,61 @@
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/mutex.h>
+#include <linux/string.h>
+
+#include "led_handoff.h"
+
+// led_control 를 내렸다 다시 올릴 때 상태를 넘겨주는 보관소.
+// led_control 보다 먼저 올려 두면 led_control 은 내려갈 때 LED 를 끄지도 GPIO 를 놓지도 않고
+// 상태(모드, 위상, 패턴 위치, 출력)를 여기 맡긴 뒤, 다시 올라오면 핀을 건드리지 않은 채 이어 간다.
+// 내용은 led_control 이 정한 형식 그대로 보관만 하므로 led_control 을 바꿔도 이 모듈은 그대로 둔다.
+// 넘긴 핀을 잡고 있는 동안은 led_control 이 이 모듈의 참조를 하나 남겨 두므로 내릴 수 없다.
+
+static u8 blob[LED_HANDOFF_MAX];
+static size_t blob_len;
+static DEFINE_MUTEX(blob_mutex);
+
+static int handoff_save(const void *data, size_t len) {
+    if (len > sizeof(blob)) {
+        return -E2BIG;
+    }
+    mutex_lock(&blob_mutex);
+    memcpy(blob, data, len);
+    blob_len = len;
+    mutex_unlock(&blob_mutex);
+    return 0;
+}
+
+// 맡겨 둔 상태를 꺼낸다 (한 번만). 길이를 반환, 없으면 0
+static ssize_t handoff_take(void *buf, size_t len) {
+    ssize_t ret;
+
+    mutex_lock(&blob_mutex);
+    ret = min(blob_len, len);
+    memcpy(buf, blob, ret);
+    blob_len = 0;
+    mutex_unlock(&blob_mutex);
+    return ret;
+}
+
+const struct led_handoff_ops led_handoff = {
+    .label = "LED",
+    .save = handoff_save,
+    .take = handoff_take,
+};
+EXPORT_SYMBOL_GPL(led_handoff);
+
+static int __init led_handoff_init(void) {
+    return 0;
+}
+
+static void __exit led_handoff_exit(void) {
+    if (blob_len) {
+        printk(KERN_WARNING "led_handoff: dropping state saved by led_control\n");
+    }
+}
+
+module_init(led_handoff_init);
+module_exit(led_handoff_exit);
+MODULE_LICENSE("GPL");
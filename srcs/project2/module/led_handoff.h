@@ -0,0 +1,19 @@
+#ifndef LED_HANDOFF_H
+#define LED_HANDOFF_H
+
+// led_handoff 모듈이 내보내는 보관소 (led_control 이 symbol_get 으로 찾아 쓴다)
+
+#include <linux/types.h>
+
+#define LED_HANDOFF_MAX 4096
+
+struct led_handoff_ops {
+    // 넘겨받는 동안 LED GPIO 를 잡아 두는 이름. led_control 이 내려가도 남아 있어야 해서 여기 둔다
+    const char *label;
+    int (*save)(const void *data, size_t len);
+    ssize_t (*take)(void *buf, size_t len);
+};
+
+extern const struct led_handoff_ops led_handoff;
+
+#endif
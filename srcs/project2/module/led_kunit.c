@@ -0,0 +1,908 @@
+#include <kunit/test.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/string.h>
+
+// KUnit 시험: write 프로토콜(레코드/텍스트 해석, 요청 검사, 세션 중재), 모드 엔진(모드 표 전환,
+// tick 간격, 위상 고정, 깨어날 시각, 스위치 입력)과 스위치 제스처 상태 머신을 드라이버와 같은
+// 소스로 돌린다. GPIO 와 타이머 대신 스위치 레벨, 엣지 시각, 현재 시각을 직접 넣는다.
+// GPIO 가 없는 커널에서도 올릴 수 있도록 led_control 과 따로 빌드한다.
+//   CONFIG_KUNIT 이 켜진 커널에서 make CONFIG_LED_KUNIT_TEST=m, insmod led_kunit.ko 후
+//   결과는 dmesg 또는 /sys/kernel/debug/kunit/<suite>/results 의 KTAP 출력
+// led_bench 의 "bench <이름> ns_per_op=<n>" 줄은 그대로 모아 성능 추이를 본다.
+//
+// 같은 .o 를 두 모듈에 넣지 않으려고 소스를 직접 포함한다
+#include "led_engine.c"
+#include "led_gesture_fsm.c"
+#include "led_proto.c"
+#include "led_vm.c"
+
+#define MS(x) ((u64)(x) * 1000000ULL)
+
+// 텍스트 레코드 하나를 해석 (led_module.c 의 text_write 앞부분과 같다)
+static int parse_line(const char *text, char *buf, struct led_text *t) {
+    ssize_t len = led_text_line(text, strlen(text), buf, LED_TEXT_MAX);
+
+    if (len < 0) {
+        return len;
+    }
+    return led_text_parse(buf, t);
+}
+
+static void proto_text_mode(struct kunit *test) {
+    char buf[LED_TEXT_MAX];
+    struct led_text t;
+
+    KUNIT_EXPECT_EQ(test, parse_line("1\n", buf, &t), 0);
+    KUNIT_EXPECT_EQ(test, t.kind, LED_TEXT_MODE);
+    KUNIT_EXPECT_EQ(test, t.mode, LED_MODE_BLINK);
+    KUNIT_EXPECT_EQ(test, parse_line("  \t6  \n", buf, &t), 0);
+    KUNIT_EXPECT_EQ(test, t.mode, LED_MODE_MAX);
+    KUNIT_EXPECT_EQ(test, parse_line("+4", buf, &t), 0);
+    KUNIT_EXPECT_EQ(test, t.mode, LED_MODE_RESET);
+
+    // 범위 밖, 숫자가 아닌 것
+    KUNIT_EXPECT_EQ(test, parse_line("0\n", buf, &t), -EINVAL);
+    KUNIT_EXPECT_EQ(test, parse_line("-1\n", buf, &t), -EINVAL);
+    KUNIT_EXPECT_EQ(test, parse_line("7\n", buf, &t), -EINVAL);
+    KUNIT_EXPECT_EQ(test, parse_line("99999999999\n", buf, &t), -EINVAL);
+    KUNIT_EXPECT_EQ(test, parse_line("1x\n", buf, &t), -EINVAL);
+    KUNIT_EXPECT_EQ(test, parse_line("0x1\n", buf, &t), -EINVAL);
+    KUNIT_EXPECT_EQ(test, parse_line("-\n", buf, &t), -EINVAL);
+
+    KUNIT_EXPECT_EQ(test, parse_line(" \n", buf, &t), 0);
+    KUNIT_EXPECT_EQ(test, t.kind, LED_TEXT_EMPTY);
+}
+
+static void proto_text_command(struct kunit *test) {
+    char buf[LED_TEXT_MAX];
+    struct led_text t;
+
+    KUNIT_EXPECT_EQ(test, parse_line("  layer 2  or 0x3 value 1 \n", buf, &t), 0);
+    KUNIT_EXPECT_EQ(test, t.kind, LED_TEXT_CMD);
+    KUNIT_EXPECT_STREQ(test, t.cmd, "layer");
+    KUNIT_EXPECT_STREQ(test, t.arg, "2  or 0x3 value 1");
+
+    KUNIT_EXPECT_EQ(test, parse_line("load\n", buf, &t), 0);
+    KUNIT_EXPECT_STREQ(test, t.cmd, "load");
+    KUNIT_EXPECT_STREQ(test, t.arg, "");
+
+    KUNIT_EXPECT_EQ(test, parse_line("inject\t0x5", buf, &t), 0);
+    KUNIT_EXPECT_STREQ(test, t.cmd, "inject");
+    KUNIT_EXPECT_STREQ(test, t.arg, "0x5");
+}
+
+// 한 번의 write 에 이어 붙은 줄은 줄바꿈까지만 소비한다 (예전 input[3] 넘침 자리)
+static void proto_text_line(struct kunit *test) {
+    static const char two[] = "2\n3\n";
+    char buf[LED_TEXT_MAX], big[LED_TEXT_MAX + 8];
+
+    KUNIT_EXPECT_EQ(test, led_text_line(two, sizeof(two) - 1, buf, sizeof(buf)), 2);
+    KUNIT_EXPECT_STREQ(test, buf, "2\n");
+    KUNIT_EXPECT_EQ(test, led_text_line(two + 2, sizeof(two) - 3, buf, sizeof(buf)), 2);
+
+    memset(big, '1', sizeof(big));
+    KUNIT_EXPECT_EQ(test, led_text_line(big, sizeof(big), buf, sizeof(buf)), -EINVAL);
+    KUNIT_EXPECT_EQ(test, led_text_line(big, LED_TEXT_MAX - 1, buf, sizeof(buf)), LED_TEXT_MAX - 1);
+    KUNIT_EXPECT_EQ(test, led_text_line(big, LED_TEXT_MAX, buf, sizeof(buf)), -EINVAL);
+}
+
+static void proto_text_u32(struct kunit *test) {
+    u32 v;
+
+    KUNIT_EXPECT_EQ(test, led_text_u32("0x1f", &v), 0);
+    KUNIT_EXPECT_EQ(test, v, 0x1fu);
+    KUNIT_EXPECT_EQ(test, led_text_u32("017", &v), 0);
+    KUNIT_EXPECT_EQ(test, v, 017u);
+    KUNIT_EXPECT_EQ(test, led_text_u32("4294967295", &v), 0);
+    KUNIT_EXPECT_EQ(test, v, U32_MAX);
+    KUNIT_EXPECT_EQ(test, led_text_u32("4294967296", &v), -EINVAL);
+    KUNIT_EXPECT_EQ(test, led_text_u32("", &v), -EINVAL);
+    KUNIT_EXPECT_EQ(test, led_text_u32("0x", &v), -EINVAL);
+    KUNIT_EXPECT_EQ(test, led_text_u32("08", &v), -EINVAL);
+    KUNIT_EXPECT_EQ(test, led_text_u32("-1", &v), -EINVAL);
+}
+
+static void proto_record_type(struct kunit *test) {
+    u32 rec[2] = { LED_VM_MAGIC, 0 };
+
+    KUNIT_EXPECT_EQ(test, led_rec_type(rec, sizeof(rec)), LED_REC_PROGRAM);
+    rec[0] = LED_REQ_MAGIC;
+    KUNIT_EXPECT_EQ(test, led_rec_type(rec, sizeof(rec)), LED_REC_REQ);
+    // header 보다 짧으면 텍스트로 본다
+    KUNIT_EXPECT_EQ(test, led_rec_type(rec, sizeof(struct led_vm_header) - 1), LED_REC_TEXT);
+    KUNIT_EXPECT_EQ(test, led_rec_type("1\n2\n3\n4\n", 8), LED_REC_TEXT);
+}
+
+static void proto_record_program(struct kunit *test) {
+    struct {
+        struct led_vm_header hdr;
+        u32 insns[2];
+    } rec = {
+        .hdr = { .magic = LED_VM_MAGIC, .version = LED_VM_VERSION, .count = 2 },
+        .insns = { LED_VM_INSN(LED_OP_SET, 0, 1), LED_VM_INSN(LED_OP_END, 0, 0) },
+    };
+    struct led_vm_header hdr;
+
+    KUNIT_EXPECT_EQ(test, led_rec_program(&rec, sizeof(rec) + 3, &hdr), (ssize_t)sizeof(rec));
+    KUNIT_EXPECT_EQ(test, hdr.count, 2);
+    KUNIT_EXPECT_EQ(test, led_rec_program(&rec, sizeof(rec) - 1, &hdr), -EINVAL);
+
+    rec.hdr.version = LED_VM_VERSION + 1;
+    KUNIT_EXPECT_EQ(test, led_rec_program(&rec, sizeof(rec), &hdr), -EINVAL);
+    rec.hdr.version = LED_VM_VERSION;
+    rec.hdr.count = 0;
+    KUNIT_EXPECT_EQ(test, led_rec_program(&rec, sizeof(rec), &hdr), -EINVAL);
+    rec.hdr.count = LED_VM_MAX_INSNS + 1;
+    KUNIT_EXPECT_EQ(test, led_rec_program(&rec, LED_WRITE_MAX, &hdr), -EINVAL);
+}
+
+static void proto_record_reqs(struct kunit *test) {
+    struct {
+        struct led_req_header hdr;
+        struct led_req req[2];
+    } rec = {
+        .hdr = { .magic = LED_REQ_MAGIC, .version = LED_REQ_VERSION, .count = 2 },
+        .req = {
+            { .op = LED_REQ_CLAIM, .value = LED_MASK_ALL },
+            { .op = LED_REQ_PRIORITY, .value = 255 },
+        },
+    };
+    struct led_req_header hdr;
+
+    KUNIT_EXPECT_EQ(test, led_rec_reqs(&rec, sizeof(rec), &hdr), (ssize_t)sizeof(rec));
+    KUNIT_EXPECT_EQ(test, led_rec_reqs(&rec, sizeof(rec) - 1, &hdr), -EINVAL);
+
+    // 요청 하나라도 잘못되면 레코드 전체를 거부
+    rec.req[1].value = 256;
+    KUNIT_EXPECT_EQ(test, led_rec_reqs(&rec, sizeof(rec), &hdr), -EINVAL);
+    rec.req[1].value = 0;
+    rec.req[0].value = LED_MASK_ALL + 1;
+    KUNIT_EXPECT_EQ(test, led_rec_reqs(&rec, sizeof(rec), &hdr), -EINVAL);
+    rec.req[0].value = 1;
+    rec.req[0].op = LED_REQ_OP_COUNT;
+    KUNIT_EXPECT_EQ(test, led_rec_reqs(&rec, sizeof(rec), &hdr), -EINVAL);
+    rec.req[0].op = 0;
+    KUNIT_EXPECT_EQ(test, led_rec_reqs(&rec, sizeof(rec), &hdr), -EINVAL);
+}
+
+// LED_WRITE_MAX 에서 자른 write 의 끝에 걸친 레코드는 다음 write 로 넘긴다
+static void proto_record_complete(struct kunit *test) {
+    struct {
+        struct led_vm_header hdr;
+        u32 insns[2];
+    } prog = {
+        .hdr = { .magic = LED_VM_MAGIC, .version = LED_VM_VERSION, .count = 2 },
+    };
+    struct {
+        struct led_req_header hdr;
+        struct led_req req[3];
+    } reqs = {
+        .hdr = { .magic = LED_REQ_MAGIC, .version = LED_REQ_VERSION, .count = 3 },
+    };
+
+    KUNIT_EXPECT_TRUE(test, led_rec_complete(&prog, sizeof(prog)));
+    KUNIT_EXPECT_FALSE(test, led_rec_complete(&prog, sizeof(prog) - 1));
+    KUNIT_EXPECT_TRUE(test, led_rec_complete(&reqs, sizeof(reqs)));
+    KUNIT_EXPECT_FALSE(test, led_rec_complete(&reqs, sizeof(reqs) - 1));
+    KUNIT_EXPECT_TRUE(test, led_rec_complete("3\n4", 3));
+    KUNIT_EXPECT_FALSE(test, led_rec_complete("layer 1 o", 9));
+}
+
+static void proto_req_apply(struct kunit *test) {
+    struct led_owner o = { 0 };
+    struct led_req req;
+
+    req = (struct led_req){ .op = LED_REQ_CLAIM, .value = 0x3 };
+    led_req_apply(&o, &req);
+    req = (struct led_req){ .op = LED_REQ_SET, .value = 0x5 };
+    led_req_apply(&o, &req);
+    req = (struct led_req){ .op = LED_REQ_TOGGLE, .value = 0x3 };
+    led_req_apply(&o, &req);
+    req = (struct led_req){ .op = LED_REQ_RELEASE, .value = 0x1 };
+    led_req_apply(&o, &req);
+    req = (struct led_req){ .op = LED_REQ_PRIORITY, .value = 7 };
+    led_req_apply(&o, &req);
+
+    KUNIT_EXPECT_EQ(test, o.claim, 0x2u);
+    KUNIT_EXPECT_EQ(test, o.value, 0x6u);
+    KUNIT_EXPECT_EQ(test, o.priority, 7);
+}
+
+static void proto_arbitrate(struct kunit *test) {
+    struct led_owner first = { .priority = 1, .claim = 0x3, .value = 0x1 };
+    struct led_owner second = { .priority = 1, .claim = 0x6, .value = 0x6 };
+    struct led_owner high = { .priority = 2, .claim = 0x4, .value = 0x0 };
+    struct led_arb arb;
+    u32 claim, value;
+
+    // 같은 priority 면 먼저 연 쪽, 높은 priority 는 뒤에 열어도 이김
+    led_arb_init(&arb);
+    led_arb_add(&arb, &first);
+    led_arb_add(&arb, &second);
+    led_arb_add(&arb, &high);
+    led_arb_result(&arb, &claim, &value);
+    KUNIT_EXPECT_EQ(test, claim, 0x7u);
+    KUNIT_EXPECT_EQ(test, value, 0x1u);
+
+    led_arb_init(&arb);
+    led_arb_result(&arb, &claim, &value);
+    KUNIT_EXPECT_EQ(test, claim, 0u);
+    KUNIT_EXPECT_EQ(test, value, 0u);
+}
+
+static struct kunit_case led_proto_cases[] = {
+    KUNIT_CASE(proto_text_mode),
+    KUNIT_CASE(proto_text_command),
+    KUNIT_CASE(proto_text_line),
+    KUNIT_CASE(proto_text_u32),
+    KUNIT_CASE(proto_record_type),
+    KUNIT_CASE(proto_record_program),
+    KUNIT_CASE(proto_record_reqs),
+    KUNIT_CASE(proto_record_complete),
+    KUNIT_CASE(proto_req_apply),
+    KUNIT_CASE(proto_arbitrate),
+    {}
+};
+
+static struct kunit_suite led_proto_suite = {
+    .name = "led_proto",
+    .test_cases = led_proto_cases,
+};
+
+static int engine_test_init(struct kunit *test) {
+    struct led_engine *eng = kunit_kzalloc(test, sizeof(*eng), GFP_KERNEL);
+
+    if (!eng) {
+        return -ENOMEM;
+    }
+    led_engine_init(eng, MS(100), 256);
+    test->priv = eng;
+    return 0;
+}
+
+static void require_mode(struct kunit *test, int mode) {
+    if (!led_mode_desc(mode)) {
+        kunit_skip(test, "mode %d is not built in", mode);
+    }
+}
+
+static void load_program(struct kunit *test, struct led_engine *eng, const u32 *insns, unsigned int n) {
+    KUNIT_ASSERT_EQ(test, led_vm_verify(insns, n), 0);
+    led_vm_load(&eng->vm, insns, n);
+}
+
+static void engine_mode_table(struct kunit *test) {
+    const struct led_mode_desc *desc;
+
+    KUNIT_EXPECT_NULL(test, led_mode_desc(0));
+    KUNIT_EXPECT_NULL(test, led_mode_desc(LED_MODE_MAX + 1));
+    KUNIT_EXPECT_NULL(test, led_mode_desc(-1));
+
+    // 리셋/수동은 빌드 옵션과 상관없이 있고 tick 이 없다
+    desc = led_mode_desc(LED_MODE_RESET);
+    KUNIT_ASSERT_NOT_NULL(test, desc);
+    KUNIT_EXPECT_FALSE(test, desc->needs_timer);
+    desc = led_mode_desc(LED_MODE_MANUAL);
+    KUNIT_ASSERT_NOT_NULL(test, desc);
+    KUNIT_EXPECT_FALSE(test, desc->needs_timer);
+    KUNIT_EXPECT_NOT_NULL(test, desc->on_gesture);
+}
+
+static void engine_blink(struct kunit *test) {
+    struct led_engine *eng = test->priv;
+
+    require_mode(test, LED_MODE_BLINK);
+    // 첫 tick 은 한 주기 뒤, 출력은 그대로
+    KUNIT_EXPECT_EQ(test, led_engine_set_mode(eng, LED_MODE_BLINK), MS(100));
+    KUNIT_EXPECT_FALSE(test, eng->changed);
+
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), MS(100));
+    KUNIT_EXPECT_TRUE(test, eng->changed);
+    KUNIT_EXPECT_EQ(test, eng->mask, LED_MASK_ALL);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), MS(100));
+    KUNIT_EXPECT_EQ(test, eng->mask, 0u);
+
+    // 위상 고정: 홀수 경계면 다음 tick 에 끈다
+    led_engine_sync(eng, 3);
+    led_engine_step(eng);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0u);
+}
+
+static void engine_seq(struct kunit *test) {
+    struct led_engine *eng = test->priv;
+    int i;
+
+    require_mode(test, LED_MODE_SEQ);
+    led_engine_set_mode(eng, LED_MODE_SEQ);
+    for (i = 0; i < LED_NUM * 2; i++) {
+        KUNIT_EXPECT_EQ(test, led_engine_step(eng), MS(100));
+        KUNIT_EXPECT_EQ(test, eng->mask, (u32)BIT(i % LED_NUM));
+    }
+}
+
+static void engine_reset(struct kunit *test) {
+    struct led_engine *eng = test->priv;
+
+    eng->mask = LED_MASK_ALL;
+    KUNIT_EXPECT_EQ(test, led_engine_set_mode(eng, LED_MODE_RESET), LED_ENGINE_STOP);
+    KUNIT_EXPECT_TRUE(test, eng->changed);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0u);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), LED_ENGINE_STOP);
+}
+
+static void engine_program(struct kunit *test) {
+    static const u32 prog[] = {
+        LED_VM_INSN(LED_OP_SET, 0, 0x5),
+        LED_VM_INSN(LED_OP_WAIT, 0, 30),
+        LED_VM_INSN(LED_OP_XOR, 0, 0xf),
+        LED_VM_INSN(LED_OP_END, 0, 0),
+    };
+    struct led_engine *eng = test->priv;
+    const struct led_mode_desc *desc;
+
+    require_mode(test, LED_MODE_PROGRAM);
+    desc = led_mode_desc(LED_MODE_PROGRAM);
+    KUNIT_EXPECT_FALSE(test, desc->ready(eng));
+    load_program(test, eng, prog, ARRAY_SIZE(prog));
+    KUNIT_EXPECT_TRUE(test, desc->ready(eng));
+
+    // 바로 실행하고, WAIT 의 ms 가 다음 tick 간격이 된다
+    KUNIT_EXPECT_EQ(test, led_engine_set_mode(eng, LED_MODE_PROGRAM), 0ULL);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), MS(30));
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x5u);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), LED_ENGINE_STOP);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0xau);
+    KUNIT_EXPECT_EQ(test, eng->status, LED_ENGINE_HALTED);
+}
+
+static void engine_program_budget(struct kunit *test) {
+    static const u32 prog[] = {
+        LED_VM_INSN(LED_OP_LOAD, 0, 1000),
+        LED_VM_INSN(LED_OP_DJNZ, 0, 1),
+        LED_VM_INSN(LED_OP_END, 0, 0),
+    };
+    struct led_engine *eng = test->priv;
+
+    require_mode(test, LED_MODE_PROGRAM);
+    load_program(test, eng, prog, ARRAY_SIZE(prog));
+    led_engine_set_mode(eng, LED_MODE_PROGRAM);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), LED_ENGINE_STOP);
+    KUNIT_EXPECT_EQ(test, eng->status, LED_ENGINE_FAULT);
+}
+
+// 스위치 입력: GPIO 대신 eng->switches 를 바꿔 WAITSW 를 푼다
+static void engine_program_switch(struct kunit *test) {
+    static const u32 prog[] = {
+        LED_VM_INSN(LED_OP_WAITSW, 0x2, 500),
+        LED_VM_INSN(LED_OP_SET, 0, 0xf),
+        LED_VM_INSN(LED_OP_END, 0, 0),
+    };
+    struct led_engine *eng = test->priv;
+
+    require_mode(test, LED_MODE_PROGRAM);
+    load_program(test, eng, prog, ARRAY_SIZE(prog));
+    led_engine_set_mode(eng, LED_MODE_PROGRAM);
+
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), MS(500));
+    KUNIT_EXPECT_EQ(test, eng->vm.wait_sw, 0x2);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0u);
+
+    eng->switches = 0x2;
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), LED_ENGINE_STOP);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0xfu);
+
+    // 다른 모드로 가면 기다리던 스위치를 놓는다
+    led_engine_set_mode(eng, LED_MODE_PROGRAM);
+    eng->switches = 0;
+    led_engine_step(eng);
+    KUNIT_EXPECT_EQ(test, eng->vm.wait_sw, 0x2);
+    led_engine_set_mode(eng, LED_MODE_RESET);
+    KUNIT_EXPECT_EQ(test, eng->vm.wait_sw, 0);
+}
+
+static void engine_pattern(struct kunit *test) {
+    struct led_engine *eng = test->priv;
+    struct led_frame frames[] = { { 0x1, 10 }, { 0x8, 20 } };
+    struct led_pattern_lib *lib;
+    const struct led_mode_desc *desc;
+
+    require_mode(test, LED_MODE_PATTERN);
+    lib = kunit_kzalloc(test, sizeof(*lib) + sizeof(lib->patterns[0]), GFP_KERNEL);
+    KUNIT_ASSERT_NOT_NULL(test, lib);
+    lib->count = 1;
+    lib->patterns[0].nframes = ARRAY_SIZE(frames);
+    lib->patterns[0].frames = frames;
+
+    desc = led_mode_desc(LED_MODE_PATTERN);
+    KUNIT_EXPECT_FALSE(test, desc->ready(eng));
+    eng->patterns = lib;
+    KUNIT_EXPECT_TRUE(test, desc->ready(eng));
+
+    // 프레임 길이가 tick 간격, 반복하지 않으면 끝에서 멈춘다
+    KUNIT_EXPECT_EQ(test, led_engine_set_mode(eng, LED_MODE_PATTERN), 0ULL);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), MS(10));
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x1u);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), MS(20));
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x8u);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), LED_ENGINE_STOP);
+    KUNIT_EXPECT_EQ(test, eng->status, LED_ENGINE_FINISHED);
+
+    lib->patterns[0].loop = true;
+    led_engine_set_mode(eng, LED_MODE_PATTERN);
+    led_engine_step(eng);
+    led_engine_step(eng);
+    KUNIT_EXPECT_EQ(test, led_engine_step(eng), MS(10));
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x1u);
+}
+
+// 기본 제스처: PRESS/DOUBLE 은 SW[i] -> 모드 i + 1, 나머지는 리셋
+static void engine_gesture_default(struct kunit *test) {
+    struct led_engine *eng = test->priv;
+    int i;
+
+    for (i = 0; i < SW_NUM; i++) {
+        int mode = LED_MODE_BLINK + i;
+        int expect = led_mode_desc(mode) ? mode : 0;
+
+        KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_PRESS, BIT(i)), expect);
+        KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_DOUBLE, BIT(i)), expect);
+    }
+    KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_LONG, BIT(0)), LED_MODE_RESET);
+    KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_CHORD, 0x3), LED_MODE_RESET);
+}
+
+static void engine_gesture_manual(struct kunit *test) {
+    struct led_engine *eng = test->priv;
+
+    led_engine_set_mode(eng, LED_MODE_MANUAL);
+    KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_PRESS, BIT(2)), 0);
+    KUNIT_EXPECT_TRUE(test, eng->changed);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x4u);
+    KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_PRESS, BIT(0)), 0);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x5u);
+    KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_PRESS, BIT(2)), 0);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x1u);
+    KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_DOUBLE, BIT(3)), 0);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x8u);
+    KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_CHORD, 0x6), 0);
+    KUNIT_EXPECT_EQ(test, eng->mask, 0x6u);
+    KUNIT_EXPECT_EQ(test, led_engine_gesture(eng, LED_GESTURE_LONG, BIT(1)), LED_MODE_RESET);
+}
+
+// tick 예약은 예정 시각에 더한다 (늦게 깨어나도 밀리지 않는다)
+static void engine_next_tick(struct kunit *test) {
+    struct led_phase ph = { .start_ns = MS(1000) };
+
+    KUNIT_EXPECT_EQ(test, led_engine_next_tick(NULL, LED_SYNC_NONE, MS(100), MS(1000), MS(100), MS(1040), 0),
+                    MS(1100));
+    KUNIT_EXPECT_EQ(test, led_engine_next_tick(NULL, LED_SYNC_PERIOD, MS(100), MS(1000), LED_ENGINE_STOP,
+                                               MS(1000), 0), 0ULL);
+    // 위상 고정 중이어도 sync 를 받지 않는 모드는 그대로
+    KUNIT_EXPECT_EQ(test, led_engine_next_tick(&ph, LED_SYNC_NONE, MS(100), MS(1000), MS(30), MS(1000), 0),
+                    MS(1030));
+}
+
+static void engine_phase_boundary(struct kunit *test) {
+    struct led_phase ph = { .start_ns = MS(1000) };
+
+    // 시작 전이면 첫 경계는 시작 시각
+    led_phase_next(&ph, MS(100), MS(500), 0);
+    KUNIT_EXPECT_EQ(test, ph.step, 0ULL);
+    KUNIT_EXPECT_EQ(test, ph.boundary_ns, MS(1000));
+
+    led_phase_next(&ph, MS(100), MS(1250), 0);
+    KUNIT_EXPECT_EQ(test, ph.step, 3ULL);
+    KUNIT_EXPECT_EQ(test, ph.boundary_ns, MS(1300));
+    // 경계 위면 그 경계
+    led_phase_next(&ph, MS(100), MS(1300), 0);
+    KUNIT_EXPECT_EQ(test, ph.step, 3ULL);
+    KUNIT_EXPECT_EQ(test, ph.boundary_ns, MS(1300));
+
+    // 늦게 깨면 양수, 일찍 깨면 음수
+    KUNIT_EXPECT_EQ(test, led_phase_error(&ph, MS(100), MS(1300) + 500000, 0), 500000);
+    KUNIT_EXPECT_EQ(test, led_phase_error(&ph, MS(100), MS(1300) - 200000, 0), -200000);
+
+    // REALTIME 이 엔진 시계보다 10 초 앞서면 경계는 엔진 시각으로 10 초 앞이다
+    ph.start_ns = MS(10000);
+    led_phase_next(&ph, MS(100), MS(620), MS(10000));
+    KUNIT_EXPECT_EQ(test, ph.step, 7ULL);
+    KUNIT_EXPECT_EQ(test, ph.boundary_ns, MS(700));
+    KUNIT_EXPECT_EQ(test, led_phase_error(&ph, MS(100), MS(701), MS(10000)), (s64)MS(1));
+    // 시계가 조정되면 다음 경계부터 따라간다
+    led_phase_next(&ph, MS(100), MS(701), MS(10000) - MS(50));
+    KUNIT_EXPECT_EQ(test, ph.step, 7ULL);
+    KUNIT_EXPECT_EQ(test, ph.boundary_ns, MS(750));
+}
+
+// 주기 경계마다 tick, 경계 번호가 전체/순차 모드 위상이 된다
+static void engine_sync_period(struct kunit *test) {
+    struct led_engine *eng = test->priv;
+    struct led_phase ph = { .start_ns = MS(1000) };
+
+    led_phase_next(&ph, MS(100), MS(1250), 0);
+    KUNIT_EXPECT_EQ(test, led_engine_next_tick(&ph, LED_SYNC_PERIOD, MS(100), ph.boundary_ns, MS(100),
+                                               MS(1302), 0), MS(1400));
+    KUNIT_EXPECT_EQ(test, ph.step, 4ULL);
+    // 경계에 딱 맞춰 깨어나도 다음 경계로 넘어간다
+    KUNIT_EXPECT_EQ(test, led_engine_next_tick(&ph, LED_SYNC_PERIOD, MS(100), MS(1400), MS(100), MS(1400), 0),
+                    MS(1500));
+    KUNIT_EXPECT_EQ(test, ph.step, 5ULL);
+
+    require_mode(test, LED_MODE_SEQ);
+    led_engine_set_mode(eng, LED_MODE_SEQ);
+    led_engine_sync(eng, ph.step);
+    led_engine_step(eng);
+    KUNIT_EXPECT_EQ(test, eng->mask, (u32)BIT(5 % LED_NUM));
+}
+
+// 경계마다 처음부터: 경계 전 프레임은 그대로, 경계를 넘는 프레임은 자른다
+static void engine_sync_restart(struct kunit *test) {
+    struct led_phase ph = { .start_ns = MS(1000) };
+
+    led_phase_next(&ph, MS(1000), MS(1001), 0);
+    KUNIT_EXPECT_EQ(test, ph.boundary_ns, MS(2000));
+    KUNIT_EXPECT_EQ(test, led_engine_next_tick(&ph, LED_SYNC_RESTART, MS(1000), MS(1500), MS(100), MS(1510), 0),
+                    MS(1600));
+    KUNIT_EXPECT_EQ(test, led_engine_next_tick(&ph, LED_SYNC_RESTART, MS(1000), MS(1950), MS(100), MS(1950), 0),
+                    MS(2000));
+    KUNIT_EXPECT_EQ(test, led_engine_next_tick(&ph, LED_SYNC_RESTART, MS(1000), MS(1500), LED_ENGINE_STOP,
+                                               MS(1500), 0), MS(2000));
+}
+
+static void engine_next_wake(struct kunit *test) {
+    struct led_wake w = {};
+
+    KUNIT_EXPECT_EQ(test, led_engine_next_wake(&w), U64_MAX);
+
+    w.armed = true;
+    w.tick_ns = MS(5);
+    w.layer_ns = MS(3);
+    KUNIT_EXPECT_EQ(test, led_engine_next_wake(&w), MS(3));
+    w.mmio_ns = MS(4);
+    KUNIT_EXPECT_EQ(test, led_engine_next_wake(&w), MS(3));
+    w.pwm = true;
+    w.pwm_ns = MS(2);
+    KUNIT_EXPECT_EQ(test, led_engine_next_wake(&w), MS(2));
+
+    // 예약이 풀린 tick 시각은 보지 않는다
+    w = (struct led_wake){ .tick_ns = MS(1), .mmio_ns = MS(4) };
+    KUNIT_EXPECT_EQ(test, led_engine_next_wake(&w), MS(4));
+    // 가상 시계 0 에 예약된 tick 도 tick 이다
+    w.armed = true;
+    w.tick_ns = 0;
+    KUNIT_EXPECT_EQ(test, led_engine_next_wake(&w), 0ULL);
+
+    // 밀린 세션 요청은 바로
+    w = (struct led_wake){ .pending = true, .armed = true, .tick_ns = MS(5) };
+    KUNIT_EXPECT_EQ(test, led_engine_next_wake(&w), 0ULL);
+}
+
+static struct kunit_case led_engine_cases[] = {
+    KUNIT_CASE(engine_mode_table),
+    KUNIT_CASE(engine_blink),
+    KUNIT_CASE(engine_seq),
+    KUNIT_CASE(engine_reset),
+    KUNIT_CASE(engine_program),
+    KUNIT_CASE(engine_program_budget),
+    KUNIT_CASE(engine_program_switch),
+    KUNIT_CASE(engine_pattern),
+    KUNIT_CASE(engine_gesture_default),
+    KUNIT_CASE(engine_gesture_manual),
+    KUNIT_CASE(engine_next_tick),
+    KUNIT_CASE(engine_phase_boundary),
+    KUNIT_CASE(engine_sync_period),
+    KUNIT_CASE(engine_sync_restart),
+    KUNIT_CASE(engine_next_wake),
+    {}
+};
+
+static struct kunit_suite led_engine_suite = {
+    .name = "led_engine",
+    .init = engine_test_init,
+    .test_cases = led_engine_cases,
+};
+
+// 제스처 상태 머신: GPIO 대신 (레벨, 엣지 시각) 을 넣고, 타이머 대신 deadline 에 expire 를 부른다.
+// 시각은 가상 시계처럼 1 초(T0)에서 시작한다
+#define T0 MS(1000)
+
+struct gesture_test {
+    struct led_gesture_fsm fsm;
+    struct led_gesture_cfg cfg;
+    bool changed;
+    u32 mask;
+};
+
+static int gesture_test_init(struct kunit *test) {
+    struct gesture_test *gt = kunit_kzalloc(test, sizeof(*gt), GFP_KERNEL);
+
+    if (!gt) {
+        return -ENOMEM;
+    }
+    led_gesture_fsm_init(&gt->fsm);
+    // 모듈 기본값
+    gt->cfg.debounce_ns = MS(20);
+    gt->cfg.long_press_ns = MS(700);
+    gt->cfg.double_press_ns = MS(250);
+    gt->cfg.chord_ns = MS(80);
+    test->priv = gt;
+    return 0;
+}
+
+// IRQ 스레드가 SW[i] 에서 level 을 읽었고, 하드 IRQ 가 t 에 찍었다
+static int edge(struct gesture_test *gt, int i, int level, u64 t) {
+    gt->changed = false;
+    gt->mask = 0;
+    return led_gesture_fsm_level(&gt->fsm, &gt->cfg, i, level, t, &gt->changed, &gt->mask);
+}
+
+// 짧게 한 번: 두 번째 누름 창이 지나야 확정
+static void gesture_press(struct kunit *test) {
+    struct gesture_test *gt = test->priv;
+    u64 deadline;
+
+    KUNIT_EXPECT_EQ(test, edge(gt, 1, 1, T0), 0);
+    KUNIT_EXPECT_TRUE(test, gt->changed);
+    KUNIT_EXPECT_EQ(test, gt->fsm.held, 0x2u);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), T0 + MS(700));
+
+    KUNIT_EXPECT_EQ(test, edge(gt, 1, 0, T0 + MS(100)), 0);
+    KUNIT_EXPECT_TRUE(test, gt->changed);
+    KUNIT_EXPECT_EQ(test, gt->fsm.held, 0u);
+    deadline = led_gesture_fsm_next(&gt->fsm);
+    KUNIT_EXPECT_EQ(test, deadline, T0 + MS(350));
+
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_expire(&gt->fsm, 1, deadline - 1), 0);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_expire(&gt->fsm, 1, deadline), LED_GESTURE_PRESS);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), U64_MAX);
+    // 한 번만 보고
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_expire(&gt->fsm, 1, deadline + MS(1)), 0);
+
+    // 두 번 누름을 끄면 떼는 즉시
+    gt->cfg.double_press_ns = 0;
+    edge(gt, 1, 1, T0 + MS(500));
+    KUNIT_EXPECT_EQ(test, edge(gt, 1, 0, T0 + MS(600)), LED_GESTURE_PRESS);
+    KUNIT_EXPECT_EQ(test, gt->mask, 0x2u);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), U64_MAX);
+}
+
+// 디바운스는 엣지 시각으로 잰다. IRQ 스레드가 같은 레벨을 다시 읽어도 엣지가 아니다
+static void gesture_debounce(struct kunit *test) {
+    struct gesture_test *gt = test->priv;
+
+    edge(gt, 0, 1, T0);
+    KUNIT_EXPECT_EQ(test, edge(gt, 0, 0, T0 + MS(5)), 0);
+    KUNIT_EXPECT_FALSE(test, gt->changed);
+    KUNIT_EXPECT_EQ(test, gt->fsm.held, 0x1u);
+    KUNIT_EXPECT_EQ(test, edge(gt, 0, 1, T0 + MS(8)), 0);
+    KUNIT_EXPECT_FALSE(test, gt->changed);
+    // 튕김이 끝나고 같은 레벨을 읽음
+    KUNIT_EXPECT_EQ(test, edge(gt, 0, 1, T0 + MS(40)), 0);
+    KUNIT_EXPECT_FALSE(test, gt->changed);
+
+    KUNIT_EXPECT_EQ(test, edge(gt, 0, 0, T0 + MS(50)), 0);
+    KUNIT_EXPECT_TRUE(test, gt->changed);
+    KUNIT_EXPECT_EQ(test, gt->fsm.held, 0u);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), T0 + MS(300));
+    // 뗀 직후의 튕김도 걸러진다
+    KUNIT_EXPECT_EQ(test, edge(gt, 0, 1, T0 + MS(60)), 0);
+    KUNIT_EXPECT_FALSE(test, gt->changed);
+}
+
+static void gesture_long(struct kunit *test) {
+    struct gesture_test *gt = test->priv;
+
+    edge(gt, 2, 1, T0);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_expire(&gt->fsm, 2, T0 + MS(699)), 0);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_expire(&gt->fsm, 2, T0 + MS(700)), LED_GESTURE_LONG);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), U64_MAX);
+    KUNIT_EXPECT_EQ(test, gt->fsm.held, 0x4u);
+
+    // 떼도 다시 보고하지 않고, 다음 누름 창도 없다
+    KUNIT_EXPECT_EQ(test, edge(gt, 2, 0, T0 + MS(900)), 0);
+    KUNIT_EXPECT_TRUE(test, gt->changed);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), U64_MAX);
+}
+
+static void gesture_double(struct kunit *test) {
+    struct gesture_test *gt = test->priv;
+
+    edge(gt, 3, 1, T0);
+    edge(gt, 3, 0, T0 + MS(100));
+    KUNIT_EXPECT_EQ(test, edge(gt, 3, 1, T0 + MS(200)), 0);
+    // 두 번째 누름도 길게 누르면 long press
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), T0 + MS(900));
+    // 처음 창(T0 + 350ms)에 걸어 둔 타이머가 늦게 와도 무시
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_expire(&gt->fsm, 3, T0 + MS(350)), 0);
+
+    KUNIT_EXPECT_EQ(test, edge(gt, 3, 0, T0 + MS(300)), LED_GESTURE_DOUBLE);
+    KUNIT_EXPECT_EQ(test, gt->mask, 0x8u);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), U64_MAX);
+
+    // 창이 지난 뒤의 누름은 새 한 번
+    edge(gt, 3, 1, T0 + MS(1000));
+    edge(gt, 3, 0, T0 + MS(1100));
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_expire(&gt->fsm, 3, T0 + MS(1350)), LED_GESTURE_PRESS);
+    KUNIT_EXPECT_EQ(test, edge(gt, 3, 1, T0 + MS(1400)), 0);
+    KUNIT_EXPECT_EQ(test, edge(gt, 3, 0, T0 + MS(1500)), 0);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), T0 + MS(1750));
+}
+
+static void gesture_chord(struct kunit *test) {
+    struct gesture_test *gt = test->priv;
+
+    edge(gt, 0, 1, T0);
+    edge(gt, 1, 1, T0 + MS(30));
+    KUNIT_EXPECT_EQ(test, gt->fsm.chord, 0x3u);
+    // chord 에 들어간 스위치는 long press 를 기다리지 않는다
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), U64_MAX);
+
+    // 나중에 눌린 스위치도 합류
+    edge(gt, 3, 1, T0 + MS(500));
+    KUNIT_EXPECT_EQ(test, gt->fsm.chord, 0xbu);
+
+    // 마지막 스위치가 떨어질 때 한 번만
+    KUNIT_EXPECT_EQ(test, edge(gt, 0, 0, T0 + MS(600)), 0);
+    KUNIT_EXPECT_EQ(test, edge(gt, 3, 0, T0 + MS(610)), 0);
+    KUNIT_EXPECT_EQ(test, edge(gt, 1, 0, T0 + MS(620)), LED_GESTURE_CHORD);
+    KUNIT_EXPECT_EQ(test, gt->mask, 0xbu);
+    KUNIT_EXPECT_EQ(test, gt->fsm.chord, 0u);
+
+    // chord_ms 보다 늦게 눌리면 따로따로
+    edge(gt, 0, 1, T0 + MS(2000));
+    edge(gt, 2, 1, T0 + MS(2100));
+    KUNIT_EXPECT_EQ(test, gt->fsm.chord, 0u);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), T0 + MS(2700));
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_expire(&gt->fsm, 0, T0 + MS(2700)), LED_GESTURE_LONG);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), T0 + MS(2800));
+}
+
+// led_gesture_bind 가 라인을 바꾼 자리: 눌려 있었으면 뗀 것으로 치고 진행 중인 제스처를 버린다
+static void gesture_rebind(struct kunit *test) {
+    struct gesture_test *gt = test->priv;
+
+    // long press 를 기다리던 스위치
+    edge(gt, 3, 1, T0);
+    KUNIT_EXPECT_TRUE(test, led_gesture_fsm_reset(&gt->fsm, 3, 0));
+    KUNIT_EXPECT_EQ(test, gt->fsm.held, 0u);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), U64_MAX);
+    KUNIT_EXPECT_FALSE(test, led_gesture_fsm_reset(&gt->fsm, 3, 0));
+
+    // chord 에 들어가 있던 스위치는 chord 에서 빠진다
+    edge(gt, 0, 1, T0 + MS(1000));
+    edge(gt, 1, 1, T0 + MS(1030));
+    KUNIT_EXPECT_TRUE(test, led_gesture_fsm_reset(&gt->fsm, 0, 0));
+    KUNIT_EXPECT_EQ(test, gt->fsm.held, 0x2u);
+    KUNIT_EXPECT_EQ(test, gt->fsm.chord, 0x2u);
+    KUNIT_EXPECT_EQ(test, edge(gt, 1, 0, T0 + MS(1100)), LED_GESTURE_CHORD);
+    KUNIT_EXPECT_EQ(test, gt->mask, 0x2u);
+
+    // 새 라인이 눌린 채로 붙으면 그 레벨에서 시작: 떼기만 엣지이고 제스처는 없다
+    KUNIT_EXPECT_FALSE(test, led_gesture_fsm_reset(&gt->fsm, 2, 1));
+    KUNIT_EXPECT_EQ(test, edge(gt, 2, 1, T0 + MS(1300)), 0);
+    KUNIT_EXPECT_FALSE(test, gt->changed);
+    KUNIT_EXPECT_EQ(test, edge(gt, 2, 0, T0 + MS(1400)), 0);
+    KUNIT_EXPECT_TRUE(test, gt->changed);
+    KUNIT_EXPECT_EQ(test, led_gesture_fsm_next(&gt->fsm), U64_MAX);
+}
+
+static struct kunit_case led_gesture_cases[] = {
+    KUNIT_CASE(gesture_press),
+    KUNIT_CASE(gesture_debounce),
+    KUNIT_CASE(gesture_long),
+    KUNIT_CASE(gesture_double),
+    KUNIT_CASE(gesture_chord),
+    KUNIT_CASE(gesture_rebind),
+    {}
+};
+
+static struct kunit_suite led_gesture_suite = {
+    .name = "led_gesture",
+    .init = gesture_test_init,
+    .test_cases = led_gesture_cases,
+};
+
+// 마이크로벤치마크: 한 번에 걸린 평균 시간을 "bench <이름> ns_per_op=<n>" 으로 남긴다
+#define BENCH_ITERS 100000
+
+static void bench_report(struct kunit *test, const char *name, u64 start) {
+    kunit_info(test, "bench %s ns_per_op=%llu\n", name, div_u64(ktime_get_ns() - start, BENCH_ITERS));
+}
+
+static void bench_tick(struct kunit *test) {
+    static const u32 prog[] = {
+        LED_VM_INSN(LED_OP_XOR, 0, 0xf),
+        LED_VM_INSN(LED_OP_WAIT, 0, 1),
+        LED_VM_INSN(LED_OP_JMP, 0, 0),
+    };
+    static const char *const names[] = {
+        [LED_MODE_BLINK] = "tick_blink",
+        [LED_MODE_SEQ] = "tick_seq",
+        [LED_MODE_PROGRAM] = "tick_program",
+    };
+    struct led_engine *eng = test->priv;
+    int modes[] = { LED_MODE_BLINK, LED_MODE_SEQ, LED_MODE_PROGRAM };
+    u64 start;
+    int i, n;
+
+    load_program(test, eng, prog, ARRAY_SIZE(prog));
+    for (i = 0; i < ARRAY_SIZE(modes); i++) {
+        if (!led_mode_desc(modes[i])) {
+            continue;
+        }
+        led_engine_set_mode(eng, modes[i]);
+        start = ktime_get_ns();
+        for (n = 0; n < BENCH_ITERS; n++) {
+            led_engine_step(eng);
+        }
+        bench_report(test, names[modes[i]], start);
+    }
+}
+
+static void bench_set_mode(struct kunit *test) {
+    struct led_engine *eng = test->priv;
+    u64 start;
+    int n;
+
+    start = ktime_get_ns();
+    for (n = 0; n < BENCH_ITERS; n++) {
+        led_engine_set_mode(eng, n & 1 ? LED_MODE_MANUAL : LED_MODE_RESET);
+    }
+    bench_report(test, "set_mode", start);
+}
+
+static void bench_parse(struct kunit *test) {
+    static const char line[] = "layer 2 or 0x3 value 1\n";
+    struct {
+        struct led_req_header hdr;
+        struct led_req req[8];
+    } rec = {
+        .hdr = { .magic = LED_REQ_MAGIC, .version = LED_REQ_VERSION, .count = 8 },
+    };
+    struct led_req_header hdr;
+    char buf[LED_TEXT_MAX];
+    struct led_text t;
+    u64 start, sum = 0;
+    int n;
+
+    // 결과를 모아 확인해야 호출이 최적화로 빠지지 않는다
+    start = ktime_get_ns();
+    for (n = 0; n < BENCH_ITERS; n++) {
+        sum += led_text_line(line, sizeof(line) - 1, buf, sizeof(buf));
+        sum += led_text_parse(buf, &t) == 0 && t.kind == LED_TEXT_CMD;
+    }
+    bench_report(test, "parse_text", start);
+    KUNIT_EXPECT_EQ(test, sum, (u64)BENCH_ITERS * sizeof(line));
+
+    for (n = 0; n < ARRAY_SIZE(rec.req); n++) {
+        rec.req[n] = (struct led_req){ .op = LED_REQ_TOGGLE, .value = BIT(n % LED_NUM) };
+    }
+    sum = 0;
+    start = ktime_get_ns();
+    for (n = 0; n < BENCH_ITERS; n++) {
+        sum += led_rec_reqs(&rec, sizeof(rec), &hdr);
+    }
+    bench_report(test, "parse_req8", start);
+    KUNIT_EXPECT_EQ(test, sum, (u64)BENCH_ITERS * sizeof(rec));
+}
+
+static struct kunit_case led_bench_cases[] = {
+    KUNIT_CASE(bench_tick),
+    KUNIT_CASE(bench_set_mode),
+    KUNIT_CASE(bench_parse),
+    {}
+};
+
+static struct kunit_suite led_bench_suite = {
+    .name = "led_bench",
+    .init = engine_test_init,
+    .test_cases = led_bench_cases,
+};
+
+kunit_test_suites(&led_proto_suite, &led_engine_suite, &led_gesture_suite, &led_bench_suite);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("KUnit tests for the led_control protocol, mode engine and switch gestures");
@@ -0,0 +1,179 @@
+#include <linux/kernel.h>
+#include <linux/bitops.h>
+#include <linux/ktime.h>
+#include <linux/string.h>
+
+#include "led_control.h"
+
+// 합성 레이어
+// 레이어마다 mask, blend 와 현재 값(고정 값 또는 패턴 프레임)을 가지고,
+// 출력은 모드 출력에서 시작해 켜진 레이어를 번호 순서로 비트 연산해 만든다.
+// 레이어 수만큼의 비트 연산뿐이라 tick 이 잦아도 비용이 거의 없다.
+// 모든 함수는 led_lock 잡은 상태에서 호출한다.
+
+struct led_layer {
+    u8 blend;
+    u32 mask;
+    u32 value;                       // 지금 내는 값
+    const struct led_pattern *pat;   // NULL 이면 고정 값
+    char name[LED_PAT_NAME_LEN];     // 라이브러리 교체 때 다시 찾을 이름
+    u16 frame;
+    u64 next_ns;                     // 다음 프레임 시각 (CLOCK_MONOTONIC)
+};
+
+static struct led_layer layers[LED_LAYER_MAX];
+static u32 layer_active;   // 켜진 레이어
+static u32 layer_playing;  // 그 중 패턴을 재생 중인 레이어
+
+static const char *const blend_names[LED_BLEND_COUNT] = {
+    [LED_BLEND_OR] = "or",
+    [LED_BLEND_AND] = "and",
+    [LED_BLEND_OVERRIDE] = "override",
+    [LED_BLEND_PRIORITY] = "priority",
+};
+
+int led_blend_parse(const char *name) {
+    int i;
+
+    for (i = 0; i < LED_BLEND_COUNT; i++) {
+        if (strcmp(name, blend_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -EINVAL;
+}
+
+static void layer_start(struct led_layer *l, int n, u64 now) {
+    l->frame = 0;
+    l->value = l->pat->frames[0].mask;
+    l->next_ns = now + (u64)l->pat->frames[0].duration_ms * NSEC_PER_MSEC;
+    layer_playing |= BIT(n);
+}
+
+// pat 이 NULL 이면 value 고정
+int led_layer_set(int n, int blend, u32 mask, const struct led_pattern *pat, u32 value) {
+    struct led_layer *l;
+
+    if (n < 0 || n >= LED_LAYER_MAX || blend < 0 || blend >= LED_BLEND_COUNT) {
+        return -EINVAL;
+    }
+    l = &layers[n];
+    l->blend = blend;
+    l->mask = mask & LED_MASK_ALL;
+    l->pat = pat;
+    layer_playing &= ~BIT(n);
+    if (pat) {
+        strscpy(l->name, pat->name, sizeof(l->name));
+        layer_start(l, n, led_clock_ns());
+    } else {
+        l->value = value & LED_MASK_ALL;
+    }
+
+    layer_active |= BIT(n);
+    led_emit_event(LED_EV_LAYER, n, 1);
+    return 0;
+}
+
+int led_layer_off(int n) {
+    if (n < 0 || n >= LED_LAYER_MAX) {
+        return -EINVAL;
+    }
+    if (layer_active & BIT(n)) {
+        layer_active &= ~BIT(n);
+        layer_playing &= ~BIT(n);
+        led_emit_event(LED_EV_LAYER, n, 0);
+    }
+    return 0;
+}
+
+// 패턴 라이브러리가 바뀌면 이름으로 다시 찾고, 없어진 패턴의 레이어는 끈다
+void led_layer_relink(const struct led_pattern_lib *lib) {
+    u32 playing = layer_playing;
+    int n, i;
+
+    while (playing) {
+        n = __ffs(playing);
+        playing &= playing - 1;
+
+        i = led_pattern_find(lib, layers[n].name);
+        if (i < 0) {
+            led_layer_off(n);
+            continue;
+        }
+        layers[n].pat = &lib->patterns[i];
+        layer_start(&layers[n], n, led_clock_ns());
+    }
+}
+
+// 가장 이른 다음 프레임 시각, 재생 중인 레이어가 없으면 0
+u64 led_layer_next(void) {
+    u32 playing = layer_playing;
+    u64 next = 0;
+    int n;
+
+    while (playing) {
+        n = __ffs(playing);
+        playing &= playing - 1;
+        if (!next || layers[n].next_ns < next) {
+            next = layers[n].next_ns;
+        }
+    }
+    return next;
+}
+
+// now 까지 도달한 프레임을 넘긴다
+void led_layer_step(u64 now) {
+    u32 playing = layer_playing;
+    struct led_layer *l;
+    int n;
+
+    while (playing) {
+        n = __ffs(playing);
+        playing &= playing - 1;
+        l = &layers[n];
+
+        while (l->next_ns <= now) {
+            if (++l->frame >= l->pat->nframes) {
+                if (!l->pat->loop) {
+                    led_layer_off(n);
+                    break;
+                }
+                l->frame = 0;
+            }
+            l->value = l->pat->frames[l->frame].mask;
+            // 한참 밀렸으면 지금부터 다시 센다
+            l->next_ns = max(l->next_ns, now - min(now, (u64)NSEC_PER_SEC)) +
+                         (u64)l->pat->frames[l->frame].duration_ms * NSEC_PER_MSEC;
+        }
+    }
+}
+
+u32 led_layer_compose(u32 out) {
+    u32 active = layer_active;
+    const struct led_layer *l;
+    int n;
+
+    while (active) {
+        n = __ffs(active);
+        active &= active - 1;
+        l = &layers[n];
+
+        switch (l->blend) {
+        case LED_BLEND_OR:
+            out |= l->value & l->mask;
+            break;
+        case LED_BLEND_AND:
+            out &= l->value | ~l->mask;
+            break;
+        case LED_BLEND_PRIORITY:
+            if (!(l->value & l->mask)) {
+                break;
+            }
+            fallthrough;
+        case LED_BLEND_OVERRIDE:
+            out = (out & ~l->mask) | (l->value & l->mask);
+            break;
+        }
+    }
+    return out;
+}
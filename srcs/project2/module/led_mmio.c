@@ -0,0 +1,131 @@
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/ktime.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/version.h>
+#include <linux/vmalloc.h>
+
+#include "led_control.h"
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6, 3, 0)
+// 6.3 부터 vm_flags 는 읽기 전용이고 vm_flags_set 으로만 바꾼다
+static inline void vm_flags_set(struct vm_area_struct *vma, vm_flags_t flags) {
+    vma->vm_flags |= flags;
+}
+#endif
+
+// mmap 창 (struct led_mmio)
+// 실제 GPIO 레지스터를 넘기지 않고 메모리 한 페이지를 한 세션에만 매핑해 준다.
+// 엔진 스레드가 mmio_poll_us 마다 창을 읽어 그 세션의 값/CLAIM 으로 반영하므로
+// 중재와 소유권은 드라이버가 그대로 쥐고, close 하면 창을 거둔다.
+// 잠금 순서: led_lock -> mmio_lock -> session_lock
+
+static unsigned int mmio_poll_us = 100;
+module_param(mmio_poll_us, uint, 0644);
+MODULE_PARM_DESC(mmio_poll_us, "how often the engine reads a granted mmap window (us)");
+
+static DEFINE_MUTEX(mmio_mutex);    // 창 주고 거두기
+static DEFINE_SPINLOCK(mmio_lock);  // 엔진 스레드와 주고 거두기 사이
+static struct led_session *mmio_owner;
+static struct led_mmio *mmio_win;
+static u64 mmio_next_ns;
+
+int led_mmio_mmap(struct led_session *sess, struct vm_area_struct *vma) {
+    struct led_mmio *win;
+    unsigned long flags;
+    int ret;
+
+    if (vma->vm_pgoff != 0 || vma->vm_end - vma->vm_start != PAGE_SIZE) {
+        return -EINVAL;
+    }
+
+    mutex_lock(&mmio_mutex);
+    if (mmio_owner) {
+        // 한 번에 한 세션만
+        ret = -EBUSY;
+        goto out;
+    }
+
+    win = vmalloc_user(PAGE_SIZE);
+    if (!win) {
+        ret = -ENOMEM;
+        goto out;
+    }
+    ret = remap_vmalloc_range(vma, win, 0);
+    if (ret < 0) {
+        vfree(win);
+        goto out;
+    }
+    // fork 한 자식에게는 넘어가지 않고, mremap 으로 늘릴 수도 없다
+    vm_flags_set(vma, VM_DONTCOPY | VM_DONTEXPAND);
+
+    spin_lock_irqsave(&mmio_lock, flags);
+    mmio_win = win;
+    mmio_owner = sess;
+    mmio_next_ns = led_clock_ns();
+    spin_unlock_irqrestore(&mmio_lock, flags);
+    led_engine_kick();
+out:
+    mutex_unlock(&mmio_mutex);
+    return ret;
+}
+
+// 파일이 닫힐 때 (매핑도 이미 모두 풀린 뒤) 창을 거둔다
+void led_mmio_release(struct led_session *sess) {
+    struct led_mmio *win = NULL;
+    unsigned long flags;
+
+    mutex_lock(&mmio_mutex);
+    spin_lock_irqsave(&mmio_lock, flags);
+    if (mmio_owner == sess) {
+        win = mmio_win;
+        mmio_win = NULL;
+        mmio_owner = NULL;
+    }
+    spin_unlock_irqrestore(&mmio_lock, flags);
+    mutex_unlock(&mmio_mutex);
+
+    vfree(win);
+}
+
+// 다음에 창을 읽을 시각, 준 창이 없으면 0 (led_lock 잡은 상태에서 호출)
+u64 led_mmio_next(void) {
+    return READ_ONCE(mmio_win) ? READ_ONCE(mmio_next_ns) : 0;
+}
+
+// 창을 읽어 세션에 반영. 출력이 바뀌면 true (엔진 스레드, led_lock 잡은 상태에서 호출)
+bool led_mmio_poll(u64 now) {
+    struct led_mmio *win;
+    bool changed = false;
+    u32 set, clr;
+
+    spin_lock(&mmio_lock);
+    win = mmio_win;
+    if (win) {
+        set = xchg(&win->set, 0);
+        clr = xchg(&win->clr, 0);
+        changed = led_session_update(mmio_owner, set & LED_MASK_ALL, clr & LED_MASK_ALL,
+                                     READ_ONCE(win->claim) & LED_MASK_ALL);
+        WRITE_ONCE(win->polls, win->polls + 1);
+        mmio_next_ns = now + (u64)max(mmio_poll_us, 10U) * NSEC_PER_USEC;
+    }
+    spin_unlock(&mmio_lock);
+
+    return changed;
+}
+
+// 합성 출력을 창에 알려 준다 (led_lock 잡은 상태에서 호출)
+void led_mmio_publish(u32 out) {
+    struct led_mmio *win;
+
+    spin_lock(&mmio_lock);
+    win = mmio_win;
+    if (win) {
+        WRITE_ONCE(win->out, out);
+        smp_wmb();
+        WRITE_ONCE(win->seq, win->seq + 1);
+    }
+    spin_unlock(&mmio_lock);
+}
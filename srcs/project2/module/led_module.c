@@ -1,100 +1,1210 @@
 #include <linux/init.h>
 #include <linux/module.h>
 #include <linux/kernel.h>
-#include <linux/gpio.h>
+#include <linux/gpio/consumer.h>
+#include <linux/hrtimer.h>
 #include <linux/interrupt.h>
-#include <linux/timer.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 #include <linux/fs.h>
 #include <linux/cdev.h>
+#include <linux/ctype.h>
 #include <linux/device.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
 #include <linux/uaccess.h>
+#include <linux/uio.h>
+#include <linux/version.h>
+
+#include "led_control.h"
+#include "led_handoff.h"
 
 #define DEVICE_NAME "led_control"
+#define EVENTS_NAME "led_events"
 #define CLASS_NAME "led_class"
 
-#define HIGH 1
-#define LOW  0
+#define CONTROL_MINOR 0
+#define EVENTS_MINOR 1
+
+int sw[SW_NUM] = {4, 17, 27, 22};
+int led[LED_NUM] = {23, 24, 25, 1};
+// 라즈베리파이 핀이 기본값. gpio-sim 같은 다른 칩에 올릴 때 전역 GPIO 번호로 바꾼다.
+// -1 은 그 자리를 비워 둔다. 올린 뒤에는 configfs 로 바꾸며 (led_pinmap.c) 여기에는 지금 번호가 보인다
+module_param_array(sw, int, NULL, 0444);
+MODULE_PARM_DESC(sw, "switch GPIO numbers (4 entries)");
+module_param_array(led, int, NULL, 0444);
+MODULE_PARM_DESC(led, "LED GPIO numbers (4 entries)");
+
+static struct task_struct *engine_task;
+static bool engine_armed;
+static u64 tick_ns;  // 다음 tick 의 예정 시각 (CLOCK_MONOTONIC)
+static int led_state[LED_NUM] = {0, 0, 0, 0};
+static u32 out_mask;  // 마지막으로 내보낸 합성 출력
+// dev_write, 엔진 스레드, 스위치 IRQ 가 같이 건드리는 상태 보호
+static DEFINE_SPINLOCK(led_lock);
+// 모드 로직 (led_engine.c). period_ns 는 전체/순차 모드 주기, 동기화 중에는 패턴 한 주기
+static struct led_engine eng;
+static struct led_pattern_lib *patterns;
+// 넘겨받은 패턴 모드는 라이브러리가 올라온 뒤에 이 이름의 패턴으로 이어 간다
+static char resume_pattern[LED_PAT_NAME_LEN];
+static u64 resume_tick_ns;
+
+// 외부 시계 기준 위상 고정: start_ns + k * period_ns 경계마다 다시 맞춘다
+struct led_sync {
+    bool enabled;
+    int clock;            // CLOCK_MONOTONIC 또는 CLOCK_REALTIME
+    struct led_phase ph;  // clock 기준 시작 시각과 다음 경계 (led_engine.c)
+    s64 last_error_ns;    // 경계에서 실제로 깨어난 시각 - 경계
+    s64 max_error_ns;     // |오차| 최대
+    u64 abs_error_sum_ns;
+    u64 samples;
+};
+static struct led_sync sync;
+
+// 소프트웨어 PWM 밝기: 켜진 LED 를 pwm_period_us 주기로 brightness % 만큼만 켠다
+static unsigned int brightness = 100;
+static bool pwm_on;
+static u64 pwm_next_ns;
+
+// 엔진 통계 (sysfs stats)
+static u64 engine_ticks;
+static u64 engine_last_late_ns;  // tick 예정 시각보다 늦게 깨어난 정도
+static u64 engine_max_late_ns;
+static u64 engine_last_cost_ns;  // engine_step 한 번에 걸린 시간 (출력 반영, 이벤트 포함)
+static u64 engine_max_cost_ns;
+static u64 engine_cost_sum_ns;
+
+// LED 별 사용량 (전력 예산용, sysfs stats). 핀 레벨이 바뀔 때만 시각 차이를 더하고
+// 창 평균은 바뀌거나 읽을 때 끝난 창만큼 넘긴다. PWM 으로 끈 구간도 꺼진 것으로 센다
+struct led_usage {
+    u64 on_ns;       // 마지막 전환까지 켜져 있던 시간
+    u64 on_since;    // 켜진 시각 (켜져 있을 때만 의미)
+    u64 toggles;
+    u64 win_on_ns;   // 지금 창이 시작할 때의 누적 켜진 시간
+    u32 duty;        // 지난 창의 duty (permille)
+};
+static struct led_usage usage[LED_NUM];
+static u32 usage_pins;       // 핀에 나가 있는 레벨
+static u64 usage_start_ns;   // 집계 시작
+static u64 usage_win_start;  // 지금 창의 시작
+static u64 usage_win_ns;     // 지금 창의 길이
+
+static unsigned int usage_window_ms = 1000;
+module_param(usage_window_ms, uint, 0644);
+MODULE_PARM_DESC(usage_window_ms, "window for the per-LED duty averages in stats (ms)");
+
+// dev_write 한 번(레코드 파싱부터 처리까지)에 걸린 시간
+static DEFINE_SPINLOCK(write_stats_lock);
+static u64 write_count;
+static u64 write_max_cost_ns;
+static u64 write_cost_sum_ns;
 
-int sw[4] = {4, 17, 27, 22};
-int led[4] = {23, 24, 25, 1};
+static char *pattern_fw = "default";
+module_param(pattern_fw, charp, 0444);
+MODULE_PARM_DESC(pattern_fw, "pattern library loaded at init from led-patterns/<name>.bin ([A-Za-z0-9_-])");
 
-static struct timer_list timer;
-static int mode = 4;
-static int led_state[4] = {0, 0, 0, 0};
-static int flag = 0;
-static int led_index = 0;
+// 프로그램이 엔진 스레드를 붙잡지 못하도록 한 번 실행할 때의 예산
+static unsigned int vm_insn_budget = 256;
+module_param(vm_insn_budget, uint, 0644);
+MODULE_PARM_DESC(vm_insn_budget, "max bytecode instructions per engine tick");
+
+static unsigned int vm_time_budget_us = 50;
+module_param(vm_time_budget_us, uint, 0644);
+MODULE_PARM_DESC(vm_time_budget_us, "max time per engine tick spent in the bytecode VM (us)");
+
+static unsigned int pwm_period_us = 10000;
+module_param(pwm_period_us, uint, 0644);
+MODULE_PARM_DESC(pwm_period_us, "software PWM period used when brightness is below 100 (us)");
 
 static int major_number;
 static struct class *led_class = NULL;
 static struct device *led_device = NULL;
+static struct device *events_device = NULL;
 static struct cdev led_cdev;
 
-static void timer_cb(struct timer_list *timer) {
+static const struct attribute_group *led_device_groups[] = {
+    &led_sched_group,
+    NULL,
+};
+
+static u32 led_output_mask(void) {
+    u32 mask = 0;
+    int i;
+
+    for (i = 0; i < LED_NUM; i++) {
+        if (led_state[i]) {
+            mask |= BIT(i);
+        }
+    }
+    return mask;
+}
+
+// 시각 t 까지의 누적 켜진 시간. t 는 마지막 전환 이후여야 한다
+static u64 usage_on_at(int i, u64 t) {
+    const struct led_usage *u = &usage[i];
+
+    return u->on_ns + ((usage_pins & BIT(i)) ? t - u->on_since : 0);
+}
+
+// 집계를 새로 시작한다. pins 는 지금 핀 레벨 (led_lock 잡은 상태 또는 엔진 스레드 전)
+static void usage_reset(u32 pins) {
+    u64 now = led_clock_ns();
     int i;
 
-    if (mode == 1) {
-        for (i = 0; i < 4; i++) {
-            gpio_set_value(led[i], flag ? LOW : HIGH);
+    memset(usage, 0, sizeof(usage));
+    for (i = 0; i < LED_NUM; i++) {
+        usage[i].on_since = now;
+    }
+    usage_pins = pins;
+    usage_start_ns = now;
+    usage_win_start = now;
+    usage_win_ns = (u64)max(READ_ONCE(usage_window_ms), 1u) * NSEC_PER_MSEC;
+}
+
+// 끝난 창이 있으면 duty 를 구하고 창을 넘긴다. 바뀔 때마다 먼저 부르므로 마지막 전환은
+// 항상 지금 창 안에 있고, 창 경계에서의 누적 값은 레벨이 그대로라 바로 구할 수 있다 (led_lock)
+static void usage_roll(u64 now) {
+    u64 k, end, start_on, end_on;
+    int i;
+
+    if (now - usage_win_start < usage_win_ns) {
+        return;
+    }
+    k = div64_u64(now - usage_win_start, usage_win_ns);
+    end = usage_win_start + k * usage_win_ns;
+    for (i = 0; i < LED_NUM; i++) {
+        // 여러 창을 건너뛰었으면 마지막 창 동안은 레벨이 그대로였다
+        start_on = k == 1 ? usage[i].win_on_ns : usage_on_at(i, end - usage_win_ns);
+        end_on = usage_on_at(i, end);
+        usage[i].duty = div64_u64((end_on - start_on) * 1000, usage_win_ns);
+        usage[i].win_on_ns = end_on;
+    }
+    usage_win_start = end;
+    // 창 길이를 바꾸면 다음 창부터
+    usage_win_ns = (u64)max(READ_ONCE(usage_window_ms), 1u) * NSEC_PER_MSEC;
+}
+
+// 핀 레벨이 바뀐 LED 만 켜진 시간과 전환 횟수를 더한다 (led_lock)
+static void usage_account(u32 pins) {
+    u64 now = led_clock_ns();
+    u32 diff = pins ^ usage_pins;
+    int i;
+
+    usage_roll(now);
+    for (i = 0; i < LED_NUM; i++) {
+        if (!(diff & BIT(i))) {
+            continue;
         }
-        flag = !flag;
-    } else if (mode == 2) {
-        for (i = 0; i < 4; i++) {
-            gpio_set_value(led[i], (i == led_index) ? HIGH : LOW);
+        usage[i].toggles++;
+        if (pins & BIT(i)) {
+            usage[i].on_since = now;
+        } else {
+            usage[i].on_ns += now - usage[i].on_since;
         }
-        led_index = (led_index + 1) % 4;
     }
+    usage_pins = pins;
+}
 
-    mod_timer(timer, jiffies + HZ * 2);
+static bool pwm_active(void) {
+    return brightness > 0 && brightness < 100 && out_mask != 0;
 }
 
-// File operations
-static ssize_t dev_read(struct file *file, char __user *buf, size_t len, loff_t *offset) {
-    char mode_str[3];
+// 모드 출력(led_state) 위에 레이어, 세션 overlay 순서로 합성해 GPIO 에 반영.
+// 밝기가 100 미만이면 PWM off 구간에는 끈다. (led_lock 잡은 상태에서 호출)
+static void led_output_commit(void) {
+    u32 mask = led_session_compose(led_layer_compose(led_output_mask()));
+    bool lit = brightness >= 100 || (brightness > 0 && pwm_on);
+    u32 pins = lit ? mask : 0;
+
+    led_pinmap_write(pins);
+    if (pins != usage_pins) {
+        usage_account(pins);
+    }
+
+    if (mask != out_mask) {
+        out_mask = mask;
+        led_sysfs_notify(LED_ATTR_LED_MASK);
+        led_mmio_publish(mask);
+    }
+}
+
+// 핀 배치가 바뀐 뒤 지금 출력을 새 라인에 바로 내보낸다
+void led_output_refresh(void) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&led_lock, flags);
+    led_output_commit();
+    spin_unlock_irqrestore(&led_lock, flags);
+}
+
+// 엔진 스레드를 깨워 할 일(대기 시각, 세션 큐)을 다시 보게 한다. 어느 context 에서든 호출 가능
+void led_engine_kick(void) {
+    struct task_struct *task = READ_ONCE(engine_task);
+
+    if (task) {
+        wake_up_process(task);
+    }
+}
+
+// LED 출력 (led_lock 잡은 상태에서 호출)
+static void led_apply_mask(u32 mask) {
+    int i;
+
+    for (i = 0; i < LED_NUM; i++) {
+        led_state[i] = (mask & BIT(i)) ? HIGH : LOW;
+    }
+    led_output_commit();
+
+    if (pwm_active()) {
+        led_engine_kick();
+    }
+}
+
+// PWM on/off 구간 전환 (엔진 스레드, led_lock 잡은 상태에서 호출)
+static void pwm_toggle(u64 now) {
+    u64 pwm_period_ns = max(pwm_period_us, 100U) * NSEC_PER_USEC;
+    u64 on_ns = div_u64(pwm_period_ns * brightness, 100);
+
+    pwm_on = !pwm_on;
+    pwm_next_ns = now + (pwm_on ? on_ns : pwm_period_ns - on_ns);
+    led_output_commit();
+}
+
+// 가상 시계에서는 REALTIME 도 같은 가상 시각으로 본다
+static s64 sync_clock_offset(void) {
+    if (led_clock_is_virtual()) {
+        return 0;
+    }
+    return sync.clock == CLOCK_REALTIME ? ktime_get_real_ns() - ktime_get_ns() : 0;
+}
+
+// now (CLOCK_MONOTONIC) 이후 첫 경계를 찾는다
+static void sync_next_boundary(u64 now) {
+    led_phase_next(&sync.ph, eng.period_ns, now, sync_clock_offset());
+}
+
+// 경계에서 깨어났을 때 위상 오차 기록
+static void sync_measure(u64 now) {
+    s64 err = led_phase_error(&sync.ph, eng.period_ns, now, sync_clock_offset());
+
+    sync.last_error_ns = err;
+    if (abs(err) > sync.max_error_ns) {
+        sync.max_error_ns = abs(err);
+    }
+    sync.abs_error_sum_ns += abs(err);
+    sync.samples++;
+    led_emit_event(LED_EV_SYNC, 0, (u32)(s32)clamp_t(s64, err, S32_MIN, S32_MAX));
+}
+
+// 엔진이 멈춘 이유를 이벤트로 (led_lock 잡은 상태에서 호출)
+static void engine_report(void) {
+    switch (eng.status) {
+    case LED_ENGINE_HALTED:
+        led_emit_event(LED_EV_PROGRAM, LED_PROG_HALTED, eng.vm.pc);
+        break;
+    case LED_ENGINE_FAULT:
+        printk(KERN_WARNING "LED program exceeded its budget at pc %d, stopped\n", eng.vm.pc);
+        led_emit_event(LED_EV_PROGRAM, LED_PROG_FAULT, eng.vm.pc);
+        break;
+    case LED_ENGINE_FINISHED:
+        led_emit_event(LED_EV_PATTERN, LED_PAT_EV_FINISHED, eng.pattern_sel);
+        break;
+    }
+}
+
+// 현재 모드의 한 tick. 다음 tick 시각(CLOCK_MONOTONIC)을 반환, 0 이면 정지
+// (led_lock 잡은 상태에서 호출)
+static u64 engine_step(u64 now) {
+    const struct led_mode_desc *desc = led_mode_desc(eng.mode);
+    enum led_mode_sync mode_sync = desc ? desc->sync : LED_SYNC_NONE;
+    u64 start, delay;
+
+    if (sync.enabled && mode_sync == LED_SYNC_PERIOD) {
+        sync_measure(now);
+        led_engine_sync(&eng, sync.ph.step);
+    } else if (sync.enabled && mode_sync == LED_SYNC_RESTART && tick_ns >= sync.ph.boundary_ns) {
+        sync_measure(now);
+        eng.frame_index = 0;
+        sync_next_boundary(now + 1);
+    }
+
+    eng.switches = led_gesture_held();
+    eng.insn_budget = READ_ONCE(vm_insn_budget);
+    start = ktime_get_ns();
+    delay = led_engine_step(&eng);
+    if (eng.mode == LED_MODE_PROGRAM && delay != LED_ENGINE_STOP &&
+        ktime_get_ns() - start > (u64)vm_time_budget_us * NSEC_PER_USEC) {
+        delay = LED_ENGINE_STOP;
+        eng.status = LED_ENGINE_FAULT;
+    }
+    if (eng.changed) {
+        led_apply_mask(eng.mask);
+    }
+    engine_report();
+
+    return led_engine_next_tick(sync.enabled ? &sync.ph : NULL, mode_sync, eng.period_ns,
+                                tick_ns, delay, now, sync_clock_offset());
+}
+
+// 다음 tick 예약 (led_lock 잡은 상태에서 호출, IRQ context 가능)
+static void engine_arm(u64 when) {
+    tick_ns = when;
+    engine_armed = true;
+    led_engine_kick();
+}
+
+static void engine_stop(void) {
+    engine_armed = false;
+}
+
+// 타이머 모드 시작. 동기화 중이면 다음 경계에서 시작한다. (led_lock 잡은 상태에서 호출)
+static void engine_start(u64 delay_ns) {
+    u64 now = led_clock_ns();
+
+    if (sync.enabled) {
+        sync_next_boundary(now);
+        engine_arm(sync.ph.boundary_ns);
+    } else {
+        engine_arm(now + delay_ns);
+    }
+}
+
+// 엔진 스레드: tick_ns (PWM 중이면 다음 PWM 전환 시각 포함) 까지 절대 시각으로
+// 잠들었다가 한 tick 씩 실행한다.
+// 스케줄링 정책, 우선순위, CPU 는 led_sched.c 의 sysfs 속성으로 바꾼다.
+// 다음에 깨어날 시각. 할 일이 없으면 U64_MAX (led_lock 잡은 상태에서 호출)
+static u64 engine_next_wake(void) {
+    struct led_wake w = {
+        .pending = led_session_pending(),
+        .armed = engine_armed,
+        .tick_ns = tick_ns,
+        .layer_ns = led_layer_next(),
+        .mmio_ns = led_mmio_next(),
+        .pwm = pwm_active(),
+        .pwm_ns = pwm_next_ns,
+    };
+
+    return led_engine_next_wake(&w);
+}
+
+// 엔진 스레드가 다음에 깨어날 시각 (가상 시계가 여기까지 건너뛴다)
+u64 led_engine_next_due(void) {
+    unsigned long flags;
+    u64 wake;
+
+    spin_lock_irqsave(&led_lock, flags);
+    wake = engine_next_wake();
+    spin_unlock_irqrestore(&led_lock, flags);
+    return wake;
+}
+
+// now 까지 밀린 일을 모두 처리. 엔진 스레드와 가상 시계가 호출한다
+void led_engine_run(u64 now) {
+    unsigned long flags;
+    u64 next, layer_next, mmio_next, start;
+    bool dirty;
+
+    spin_lock_irqsave(&led_lock, flags);
+    // 세션 요청과 레이어 프레임은 깨어날 때마다 모아서 한 번에 반영
+    dirty = led_session_pending() && led_session_drain();
+    layer_next = led_layer_next();
+    if (layer_next && layer_next <= now) {
+        led_layer_step(now);
+        dirty = true;
+    }
+    mmio_next = led_mmio_next();
+    if (mmio_next && mmio_next <= now && led_mmio_poll(now)) {
+        dirty = true;
+    }
+    if (dirty) {
+        led_output_commit();
+    }
+    if (pwm_active() && pwm_next_ns <= now) {
+        pwm_toggle(now);
+    }
+    if (engine_armed && tick_ns <= now) {
+        engine_ticks++;
+        engine_last_late_ns = now - tick_ns;
+        engine_max_late_ns = max(engine_max_late_ns, engine_last_late_ns);
+        start = ktime_get_ns();
+        next = engine_step(now);
+        engine_last_cost_ns = ktime_get_ns() - start;
+        engine_max_cost_ns = max(engine_max_cost_ns, engine_last_cost_ns);
+        engine_cost_sum_ns += engine_last_cost_ns;
+        if (next) {
+            // 한참 밀렸으면 몰아서 따라잡지 않고 지금부터 다시 센다
+            tick_ns = max(next, now);
+        } else {
+            engine_armed = false;
+        }
+    }
+    spin_unlock_irqrestore(&led_lock, flags);
+}
+
+static int engine_thread_fn(void *arg) {
+    ktime_t expires;
+    u64 now, wake;
+
+    while (!kthread_should_stop()) {
+        set_current_state(TASK_INTERRUPTIBLE);
+
+        wake = led_engine_next_due();
+        if (wake == U64_MAX) {
+            schedule();
+            continue;
+        }
+        now = led_clock_ns();
+        if (now < wake) {
+            // 가상 시계면 시각이 되어도 clock_ns 를 쓴 쪽이 직접 처리한다. 깨울 때(kick)까지만 잔다
+            if (led_clock_is_virtual()) {
+                schedule();
+                continue;
+            }
+            expires = ns_to_ktime(wake);
+            schedule_hrtimeout_range(&expires, 0, HRTIMER_MODE_ABS);
+            continue;
+        }
+        __set_current_state(TASK_RUNNING);
+        led_engine_run(now);
+    }
+
+    __set_current_state(TASK_RUNNING);
+    return 0;
+}
+
+// 모드 전환 (led_lock 잡은 상태에서 호출)
+static void led_set_mode(int new_mode) {
+    u64 delay = led_engine_set_mode(&eng, new_mode);
+
+    if (delay == LED_ENGINE_STOP) {
+        engine_stop();
+    } else {
+        engine_start(delay);
+    }
+    if (eng.changed) {
+        led_apply_mask(eng.mask);
+    }
+
+    led_emit_event(LED_EV_MODE, 0, new_mode);
+    led_sysfs_notify(LED_ATTR_MODE);
+}
+
+// 스위치 제스처 -> 모드 동작. 모드마다 무엇을 할지는 모드 표(led_engine.c)가 정한다
+void led_handle_gesture(int gesture, u32 sw_mask) {
+    unsigned long flags;
+    int new_mode;
+
+    spin_lock_irqsave(&led_lock, flags);
+    new_mode = led_engine_gesture(&eng, gesture, sw_mask);
+    if (new_mode) {
+        led_set_mode(new_mode);
+    } else if (eng.changed) {
+        led_apply_mask(eng.mask);
+    }
+    spin_unlock_irqrestore(&led_lock, flags);
+}
+
+// 스위치 레벨 변화: WAITSW 로 기다리는 프로그램을 바로 깨운다
+void led_switch_edge(u32 held) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&led_lock, flags);
+    if (eng.mode == LED_MODE_PROGRAM && (eng.vm.wait_sw & held)) {
+        eng.vm.wait_sw = 0;
+        engine_arm(led_clock_ns());
+    }
+    spin_unlock_irqrestore(&led_lock, flags);
+}
+
+// 새 패턴 라이브러리로 교체 (firmware 콜백에서 호출)
+void led_pattern_install(struct led_pattern_lib *lib) {
+    struct led_pattern_lib *old;
+    unsigned long flags;
+    int i;
+
+    spin_lock_irqsave(&led_lock, flags);
+    old = patterns;
+    patterns = lib;
+    eng.patterns = lib;
+    if (eng.pattern_sel >= lib->count) {
+        eng.pattern_sel = 0;
+    }
+    led_layer_relink(lib);
+    led_output_commit();
+    i = resume_pattern[0] ? led_pattern_find(lib, resume_pattern) : -ENOENT;
+    resume_pattern[0] = '\0';
+    if (eng.mode == LED_MODE_PATTERN && i >= 0) {
+        // 넘겨받은 패턴: 같은 프레임에서 이어 간다 (끝난 패턴이면 그대로 멈춰 있다)
+        eng.pattern_sel = i;
+        if (resume_tick_ns) {
+            engine_arm(max(resume_tick_ns, led_clock_ns()));
+        }
+    } else if (eng.mode == LED_MODE_PATTERN) {
+        led_set_mode(LED_MODE_PATTERN);
+    }
+    spin_unlock_irqrestore(&led_lock, flags);
+
+    led_pattern_free(old);
+    led_emit_event(LED_EV_PATTERN, LED_PAT_EV_LOADED, lib->count);
+}
+
+// sysfs 에서 쓰는 접근 함수 (led_sysfs.c)
+int led_mode_get(void) {
+    return READ_ONCE(eng.mode);
+}
+
+// dev_write 와 /sys/kernel/led_control/mode 공통
+int led_mode_set(int new_mode) {
+    const struct led_mode_desc *desc = led_mode_desc(new_mode);
+    unsigned long flags;
+
+    if (!desc) {
+        return -EOPNOTSUPP;
+    }
+    spin_lock_irqsave(&led_lock, flags);
+    if (desc->ready && !desc->ready(&eng)) {
+        spin_unlock_irqrestore(&led_lock, flags);
+        return -ENOENT;
+    }
+    led_trace_input(LED_EV_INPUT_MODE, 0, new_mode);
+    led_set_mode(new_mode);
+    spin_unlock_irqrestore(&led_lock, flags);
+    return 0;
+}
+
+// 세션 overlay 까지 합친 실제 출력
+u32 led_mask_get(void) {
+    return READ_ONCE(out_mask);
+}
+
+// LED 를 직접 지정하면 수동 모드로 바뀐다
+void led_mask_set(u32 mask) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&led_lock, flags);
+    led_trace_input(LED_EV_INPUT_MASK, 0, mask & LED_MASK_ALL);
+    if (eng.mode != LED_MODE_MANUAL) {
+        led_set_mode(LED_MODE_MANUAL);
+    }
+    // 수동 모드 제스처가 이어서 토글할 수 있도록 엔진 출력에도 남긴다
+    eng.mask = mask & LED_MASK_ALL;
+    led_apply_mask(eng.mask);
+    spin_unlock_irqrestore(&led_lock, flags);
+}
+
+u64 led_period_get(void) {
+    return READ_ONCE(eng.period_ns);
+}
+
+// 위상 고정 중에는 sync 명령으로 준 주기를 쓴다
+int led_period_set(u64 ns) {
+    unsigned long flags;
+
+    if (ns < NSEC_PER_MSEC) {
+        return -EINVAL;
+    }
+    spin_lock_irqsave(&led_lock, flags);
+    if (sync.enabled) {
+        spin_unlock_irqrestore(&led_lock, flags);
+        return -EBUSY;
+    }
+    eng.period_ns = ns;
+    spin_unlock_irqrestore(&led_lock, flags);
+
+    led_sysfs_notify(LED_ATTR_PERIOD);
+    return 0;
+}
+
+unsigned int led_brightness_get(void) {
+    return READ_ONCE(brightness);
+}
+
+int led_brightness_set(unsigned int pct) {
+    unsigned long flags;
+
+    if (pct > 100) {
+        return -EINVAL;
+    }
+    spin_lock_irqsave(&led_lock, flags);
+    brightness = pct;
+    led_output_commit();
+    led_engine_kick();
+    spin_unlock_irqrestore(&led_lock, flags);
+
+    led_sysfs_notify(LED_ATTR_BRIGHTNESS);
+    return 0;
+}
+
+void led_stats_get(struct led_stats *st) {
+    unsigned long flags;
+    u64 now;
+    int i;
+
+    spin_lock_irqsave(&led_lock, flags);
+    st->ticks = engine_ticks;
+    st->last_late_ns = engine_last_late_ns;
+    st->max_late_ns = engine_max_late_ns;
+    st->sync_enabled = sync.enabled;
+    st->sync_samples = sync.samples;
+    st->sync_last_error_ns = sync.last_error_ns;
+    st->sync_max_error_ns = sync.max_error_ns;
+    st->sync_abs_error_sum_ns = sync.abs_error_sum_ns;
+    st->tick_last_cost_ns = engine_last_cost_ns;
+    st->tick_max_cost_ns = engine_max_cost_ns;
+    st->tick_cost_sum_ns = engine_cost_sum_ns;
+    now = led_clock_ns();
+    usage_roll(now);
+    st->usage_ns = now - usage_start_ns;
+    st->usage_window_ns = usage_win_ns;
+    for (i = 0; i < LED_NUM; i++) {
+        st->led_on_ns[i] = usage_on_at(i, now);
+        st->led_toggles[i] = usage[i].toggles;
+        st->led_duty[i] = usage[i].duty;
+    }
+    spin_unlock_irqrestore(&led_lock, flags);
+
+    spin_lock_irqsave(&write_stats_lock, flags);
+    st->writes = write_count;
+    st->write_max_cost_ns = write_max_cost_ns;
+    st->write_cost_sum_ns = write_cost_sum_ns;
+    spin_unlock_irqrestore(&write_stats_lock, flags);
+}
+
+// 패턴 선택: 번호 또는 이름 (led_lock 잡은 상태에서 호출)
+static int pattern_select(const char *arg) {
+    int i = led_pattern_find(patterns, arg);
+
+    if (!led_mode_desc(LED_MODE_PATTERN)) {
+        return -EOPNOTSUPP;
+    }
+    if (i < 0) {
+        return i;
+    }
+
+    eng.pattern_sel = i;
+    led_set_mode(LED_MODE_PATTERN);
+    return 0;
+}
+
+// 위상 고정 설정: "mono|real <start_ns> <period_ns>" 또는 "off" (led_lock 잡은 상태에서 호출)
+static int sync_configure(char *arg) {
+    char *clock = strsep(&arg, " ");
+    u64 start, period;
+
+    if (strcmp(clock, "off") == 0) {
+        sync.enabled = false;
+        return 0;
+    }
+    if (!arg || sscanf(arg, "%llu %llu", &start, &period) != 2 || period < NSEC_PER_MSEC) {
+        return -EINVAL;
+    }
+    if (strcmp(clock, "mono") == 0) {
+        sync.clock = CLOCK_MONOTONIC;
+    } else if (strcmp(clock, "real") == 0) {
+        sync.clock = CLOCK_REALTIME;
+    } else {
+        return -EINVAL;
+    }
+
+    sync.ph.start_ns = start;
+    sync.last_error_ns = 0;
+    sync.max_error_ns = 0;
+    sync.abs_error_sum_ns = 0;
+    sync.samples = 0;
+    sync.enabled = true;
+    eng.period_ns = period;
+    led_sysfs_notify(LED_ATTR_PERIOD);
+
+    // 돌고 있던 타이머 모드는 다음 경계에서 다시 시작
+    if (led_mode_desc(eng.mode) && led_mode_desc(eng.mode)->needs_timer) {
+        led_set_mode(eng.mode);
+    }
+    return 0;
+}
+
+// 레이어 설정: "<n> off" 또는 "<n> <blend> <mask> pattern|value <arg>" (led_lock 잡은 상태에서 호출)
+static int layer_configure(char *arg) {
+    char blend[16], kind[16], what[LED_PAT_NAME_LEN];
+    u32 value = 0;
+    int n, b, i, mask, ret;
+
+    if (sscanf(arg, "%d %15s", &n, blend) != 2) {
+        return -EINVAL;
+    }
+    if (strcmp(blend, "off") == 0) {
+        ret = led_layer_off(n);
+    } else {
+        if (sscanf(arg, "%d %15s %i %15s %15s", &n, blend, &mask, kind, what) != 5) {
+            return -EINVAL;
+        }
+        b = led_blend_parse(blend);
+        if (b < 0) {
+            return b;
+        }
+        if (strcmp(kind, "pattern") == 0) {
+            i = led_pattern_find(patterns, what);
+            if (i < 0) {
+                return i;
+            }
+            ret = led_layer_set(n, b, mask, &patterns->patterns[i], 0);
+        } else if (strcmp(kind, "value") == 0 && kstrtou32(what, 0, &value) == 0) {
+            ret = led_layer_set(n, b, mask, NULL, value);
+        } else {
+            return -EINVAL;
+        }
+    }
+
+    if (ret == 0) {
+        led_output_commit();
+        led_engine_kick();
+    }
+    return ret;
+}
+
+// 텍스트 명령
+//  pattern <번호|이름>                   : 패턴 재생
+//  load [이름]                           : led-patterns/<이름>.bin 다시 읽기 (기본값 pattern_fw)
+//  sync mono|real <start_ns> <period_ns> : 절대 시각 기준으로 주기 경계를 맞춤
+//  sync off                              : 위상 고정 해제
+//  layer <n> <blend> <mask> pattern <p>  : 레이어 n 에 패턴 p 를 얹음 (blend: or|and|override|priority)
+//  layer <n> <blend> <mask> value <bits> : 레이어 n 에 고정 값
+//  layer <n> off                         : 레이어 끄기
+//  inject <mask>                         : 스위치가 mask 처럼 눌린 것으로 엣지 주입 (allow_inject=1 일 때만)
+// cmd, arg 는 led_text_parse 로 나눈 것
+int led_command(const char *cmd, char *arg) {
+    unsigned long flags;
     int ret;
 
-    sprintf(mode_str, "%d\n", mode);
-    ret = copy_to_user(buf, mode_str, strlen(mode_str));
-    if (ret != 0) {
-        return -EFAULT;
+    if (strcmp(cmd, "pattern") == 0) {
+        spin_lock_irqsave(&led_lock, flags);
+        ret = pattern_select(arg);
+        spin_unlock_irqrestore(&led_lock, flags);
+        return ret;
+    }
+    if (strcmp(cmd, "sync") == 0) {
+        spin_lock_irqsave(&led_lock, flags);
+        ret = sync_configure(arg);
+        spin_unlock_irqrestore(&led_lock, flags);
+        return ret;
+    }
+    if (strcmp(cmd, "layer") == 0) {
+        spin_lock_irqsave(&led_lock, flags);
+        ret = layer_configure(arg);
+        spin_unlock_irqrestore(&led_lock, flags);
+        return ret;
     }
-    return strlen(mode_str);
+    if (strcmp(cmd, "load") == 0) {
+        return led_pattern_request(led_device, *arg ? arg : pattern_fw);
+    }
+    if (strcmp(cmd, "inject") == 0) {
+        u32 held;
+
+        if (led_text_u32(arg, &held) < 0) {
+            return -EINVAL;
+        }
+        return led_gesture_inject(held);
+    }
+    return -EINVAL;
 }
 
-static ssize_t dev_write(struct file *file, const char __user *buf, size_t len, loff_t *offset) {
-    char input[3];
-    int new_mode, i;
+// File operations
+static int dev_open(struct inode *inode, struct file *file) {
+    // minor 1 (/dev/led_events) 은 이벤트 스트림
+    if (iminor(inode) == EVENTS_MINOR) {
+        replace_fops(file, &led_event_fops);
+        return file->f_op->open(inode, file);
+    }
 
-    if (copy_from_user(input, buf, len)) {
+    file->private_data = led_session_open();
+    if (!file->private_data) {
+        return -ENOMEM;
+    }
+    file->f_mode |= FMODE_NOWAIT;
+    return 0;
+}
+
+static int dev_mmap(struct file *file, struct vm_area_struct *vma) {
+    return led_mmio_mmap(file->private_data, vma);
+}
+
+static int dev_release(struct inode *inode, struct file *file) {
+    led_mmio_release(file->private_data);
+    led_session_close(file->private_data);
+    return 0;
+}
+
+// 읽을 때마다 현재 모드 한 줄. 읽으면 SIGIO 가 다시 무장된다.
+static ssize_t dev_read_iter(struct kiocb *iocb, struct iov_iter *to) {
+    char mode_str[16];
+    int len;
+
+    led_session_consumed(iocb->ki_filp->private_data);
+    len = scnprintf(mode_str, sizeof(mode_str), "%d\n", READ_ONCE(eng.mode));
+    len = min_t(size_t, len, iov_iter_count(to));
+    if (copy_to_iter(mode_str, len, to) != len) {
         return -EFAULT;
     }
-    input[len] = '\0';
-    if (kstrtoint(input, 10, &new_mode) != 0 || new_mode < -1 || new_mode > 4) {
+    return len;
+}
+
+// 바이트코드 프로그램 올리기: header + 명령어 배열. 소비한 길이를 반환
+static ssize_t program_write(const void *data, size_t avail, bool nonblock) {
+    struct led_vm_header hdr;
+    unsigned long flags;
+    ssize_t size;
+    u32 *insns;
+    int ret;
+
+    if (!led_mode_desc(LED_MODE_PROGRAM)) {
+        return -EOPNOTSUPP;
+    }
+    size = led_rec_program(data, avail, &hdr);
+    if (size < 0) {
+        return size;
+    }
+
+    // 레코드가 정렬돼 있지 않을 수 있어 복사해서 검증. nonblock 이면 메모리 회수를 기다리지 않는다
+    insns = kmemdup(data + sizeof(hdr), hdr.count * sizeof(u32), nonblock ? GFP_NOWAIT | __GFP_NOWARN : GFP_KERNEL);
+    if (!insns) {
+        return nonblock ? -EAGAIN : -ENOMEM;
+    }
+
+    ret = led_vm_verify(insns, hdr.count);
+    if (ret < 0) {
+        printk(KERN_ERR "LED program rejected by verifier (%d)\n", ret);
+        kfree(insns);
+        return ret;
+    }
+
+    spin_lock_irqsave(&led_lock, flags);
+    led_vm_load(&eng.vm, insns, hdr.count);
+    if (eng.mode == LED_MODE_PROGRAM) {
+        led_set_mode(LED_MODE_PROGRAM);
+    }
+    spin_unlock_irqrestore(&led_lock, flags);
+
+    kfree(insns);
+    return size;
+}
+
+// 텍스트 한 줄: 모드 번호 또는 명령. 소비한 길이(줄바꿈 포함)를 반환
+static ssize_t text_write(const char *data, size_t avail) {
+    char input[LED_TEXT_MAX];
+    struct led_text t;
+    ssize_t len;
+    int ret;
+
+    len = led_text_line(data, avail, input, sizeof(input));
+    if (len < 0) {
+        return len;
+    }
+    if (led_text_parse(input, &t) < 0) {
         printk(KERN_ERR "Invalid mode: %s\n", input);
         return -EINVAL;
     }
+    switch (t.kind) {
+    case LED_TEXT_CMD:
+        ret = led_command(t.cmd, t.arg);
+        break;
+    case LED_TEXT_MODE:
+        ret = led_mode_set(t.mode);
+        break;
+    default:
+        ret = 0;
+        break;
+    }
+    return ret < 0 ? ret : len;
+}
+
+// 레코드 하나 처리. 레코드는 스스로 길이를 알 수 있으므로 (binary 는 header 의 count,
+// 텍스트는 줄바꿈) 한 번의 write/writev/io_uring 요청에 여러 개를 이어 붙일 수 있다.
+static ssize_t record_write(struct led_session *sess, const char *data, size_t avail, bool nonblock) {
+    switch (led_rec_type(data, avail)) {
+    case LED_REC_PROGRAM:
+        return program_write(data, avail, nonblock);
+    case LED_REC_REQ:
+        return led_session_write(sess, data, avail, nonblock);
+    default:
+        return text_write(data, avail);
+    }
+}
+
+// IOCB_NOWAIT (io_uring) 나 O_NONBLOCK 이면 세션 큐가 차거나 메모리를 바로 못 얻을 때 기다리지 않고 -EAGAIN.
+// 앞쪽 레코드가 처리된 뒤 실패하면 처리한 길이만 돌려준다.
+// LED_WRITE_MAX 를 넘는 write 는 앞의 LED_WRITE_MAX 바이트 안에서 끝나는 레코드까지만 처리하고
+// 짧은 길이를 돌려준다 (나머지는 다음 write 로)
+static ssize_t dev_write_iter(struct kiocb *iocb, struct iov_iter *from) {
+    struct file *file = iocb->ki_filp;
+    bool nonblock = (iocb->ki_flags & IOCB_NOWAIT) || (file->f_flags & O_NONBLOCK);
+    bool cut = iov_iter_count(from) > LED_WRITE_MAX;
+    size_t len = min_t(size_t, iov_iter_count(from), LED_WRITE_MAX), done = 0;
+    ssize_t ret = 0;
+    unsigned long flags;
+    u64 start, cost;
+    char *kbuf;
 
-    mode = new_mode;
+    if (len == 0) {
+        return 0;
+    }
 
-    if (mode == 4) {
-        del_timer(&timer);
-        for (i = 0; i < 4; i++) {
-            gpio_set_value(led[i], LOW);
+    kbuf = kmalloc(len, nonblock ? GFP_NOWAIT | __GFP_NOWARN : GFP_KERNEL);
+    if (!kbuf) {
+        return nonblock ? -EAGAIN : -ENOMEM;
+    }
+    if (!copy_from_iter_full(kbuf, len, from)) {
+        kfree(kbuf);
+        return -EFAULT;
+    }
+
+    start = ktime_get_ns();
+    while (done < len) {
+        if (cut && done > 0 && !led_rec_complete(kbuf + done, len - done)) {
+            break;
         }
-    } else {
-        mod_timer(&timer, jiffies + HZ * 2);
+        ret = record_write(file->private_data, kbuf + done, len - done, nonblock);
+        if (ret <= 0) {
+            break;
+        }
+        done += ret;
     }
+    cost = ktime_get_ns() - start;
+    kfree(kbuf);
 
-    return len;
+    spin_lock_irqsave(&write_stats_lock, flags);
+    write_count++;
+    write_max_cost_ns = max(write_max_cost_ns, cost);
+    write_cost_sum_ns += cost;
+    spin_unlock_irqrestore(&write_stats_lock, flags);
+
+    if (done < len) {
+        iov_iter_revert(from, len - done);
+    }
+    return done ? done : ret;
 }
 
 static struct file_operations fops = {
     .owner = THIS_MODULE,
-    .read = dev_read,
-    .write = dev_write,
+    .open = dev_open,
+    .release = dev_release,
+    .read_iter = dev_read_iter,
+    .write_iter = dev_write_iter,
+    .fasync = led_session_fasync,
+    .mmap = dev_mmap,
+};
+
+// 모듈을 다시 올릴 때 led_handoff 에 맡기는 상태.
+// 앞부분(magic..led)은 형식이 바뀌어도 읽어서 넘겨받은 핀만은 정리할 수 있어야 한다
+#define HANDOFF_MAGIC   0x4f48444cu  // "LDHO"
+#define HANDOFF_VERSION 1
+#define HANDOFF_F_PINS  0x1          // LED GPIO 를 놓지 않은 채 넘겼다
+
+struct handoff_state {
+    u32 magic;
+    u16 version;
+    u16 flags;
+    int led[LED_NUM];        // 잡아 둔 GPIO 번호
+    u32 size;
+    bool virtual_clock;      // tick_ns 가 어느 시계 기준인지
+    int mode;
+    u64 period_ns;
+    u64 tick_ns;             // 다음 tick 예정 시각, 0 이면 멈춤
+    int flag;                // 전체/순차 위상
+    int led_index;
+    char pattern[LED_PAT_NAME_LEN];
+    int frame_index;
+    struct led_vm vm;
+    u32 mode_mask;           // 모드 출력 (led_state)
+    u32 eng_mask;
+    u32 out_mask;            // 핀에 나가 있던 합성 출력
+    unsigned int brightness;
+    bool sync_enabled;
+    int sync_clock;
+    u64 sync_start_ns;
 };
 
+// 0 으로 두고 내리면 led_handoff 가 있어도 예전처럼 LED 를 끄고 핀을 놓는다 (완전히 내릴 때)
+static bool handoff_on_exit = true;
+module_param_named(handoff, handoff_on_exit, bool, 0644);
+MODULE_PARM_DESC(handoff, "keep LED outputs and hand state to led_handoff on unload");
+
+static const struct led_handoff_ops *handoff;  // led_handoff 모듈이 있을 때만, 참조를 잡고 있다
+static struct handoff_state resume;
+static bool resume_pins;   // 넘겨받은 LED 핀 (다시 잡지 않고 그대로 쓴다)
+static bool resume_state;  // 상태도 이어 간다
+
+// 지금 상태를 담는다 (led_lock 잡은 상태에서 호출)
+static void handoff_fill(struct handoff_state *h) {
+    memset(h, 0, sizeof(*h));
+    h->magic = HANDOFF_MAGIC;
+    h->version = HANDOFF_VERSION;
+    h->flags = HANDOFF_F_PINS;
+    memcpy(h->led, led, sizeof(h->led));
+    h->size = sizeof(*h);
+    h->virtual_clock = led_clock_is_virtual();
+    h->mode = eng.mode;
+    h->period_ns = eng.period_ns;
+    h->tick_ns = engine_armed ? tick_ns : 0;
+    h->flag = eng.flag;
+    h->led_index = eng.led_index;
+    if (patterns && eng.pattern_sel < patterns->count) {
+        strscpy(h->pattern, patterns->patterns[eng.pattern_sel].name, sizeof(h->pattern));
+    }
+    h->frame_index = eng.frame_index;
+    h->vm = eng.vm;
+    h->mode_mask = led_output_mask();
+    h->eng_mask = eng.mask;
+    h->out_mask = out_mask;
+    h->brightness = brightness;
+    h->sync_enabled = sync.enabled;
+    h->sync_clock = sync.clock;
+    h->sync_start_ns = sync.ph.start_ns;
+}
+
+// 맡겨 둔 상태를 꺼낸다. 핀을 넘겨받았으면 앞 모듈이 남겨 둔 led_handoff 참조도 이제 우리 것
+static void handoff_take(void) {
+    ssize_t len;
+
+    handoff = symbol_get(led_handoff);
+    if (!handoff) {
+        return;
+    }
+    len = handoff->take(&resume, sizeof(resume));
+    if (len < offsetof(struct handoff_state, size) || resume.magic != HANDOFF_MAGIC ||
+        !(resume.flags & HANDOFF_F_PINS)) {
+        return;
+    }
+    resume_pins = true;
+    symbol_put(led_handoff);
+    resume_state = len == sizeof(resume) && resume.version == HANDOFF_VERSION && resume.size == sizeof(resume);
+    if (!resume_state) {
+        printk(KERN_WARNING "led_control: handed-off state is from an incompatible version, starting fresh\n");
+    }
+}
+
+// 앞 모듈이 놓지 않고 넘겨준 핀인지
+static bool handoff_holds(int pin) {
+    int k;
+
+    for (k = 0; pin >= 0 && resume_pins && k < LED_NUM; k++) {
+        if (resume.led[k] == pin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool led_pin_used(int pin) {
+    int i;
+
+    for (i = 0; i < LED_NUM; i++) {
+        if (led[i] == pin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// LED 핀 확보. 넘겨받은 핀은 건드리지 않고, 새로 잡는 핀은 넘겨받은 출력 레벨로 시작한다
+static int handoff_claim_leds(void) {
+    u32 handed = 0;
+    int i, k;
+
+    // 핀 번호를 바꿔 올렸으면 더 안 쓰는 핀은 놓는다
+    for (k = 0; resume_pins && k < LED_NUM; k++) {
+        if (resume.led[k] >= 0 && !led_pin_used(resume.led[k])) {
+            gpiod_put(gpio_to_desc(resume.led[k]));
+        }
+    }
+
+    for (i = 0; i < LED_NUM; i++) {
+        if (!handoff_holds(led[i])) {
+            continue;
+        }
+        handed |= BIT(i);
+        // 상태를 못 받았으면 새로 올린 것과 같게 끈다
+        if (!resume_state) {
+            gpiod_set_value_cansleep(gpio_to_desc(led[i]), LOW);
+        }
+    }
+    return led_pinmap_setup(led_device, handoff ? handoff->label : "LED", handed,
+                            resume_state ? resume.out_mask : 0);
+}
+
+// 넘겨받은 상태로 엔진을 이어 간다. 엔진 스레드를 띄우기 전에 호출
+static void handoff_restore(void) {
+    const struct handoff_state *h = &resume;
+    const struct led_mode_desc *desc = led_mode_desc(h->mode);
+    u64 now = led_clock_ns();
+    int i;
+
+    if (!resume_state || !desc) {
+        return;
+    }
+    eng.mode = h->mode;
+    eng.period_ns = h->period_ns;
+    eng.flag = h->flag;
+    eng.led_index = h->led_index;
+    eng.frame_index = h->frame_index;
+    eng.vm = h->vm;
+    eng.mask = h->eng_mask;
+    for (i = 0; i < LED_NUM; i++) {
+        led_state[i] = (h->mode_mask & BIT(i)) ? HIGH : LOW;
+    }
+    out_mask = h->out_mask;
+    brightness = h->brightness;
+    // 핀은 넘겨받은 레벨 그대로다
+    usage_reset(brightness >= 100 ? out_mask : 0);
+    sync.enabled = h->sync_enabled;
+    sync.clock = h->sync_clock;
+    sync.ph.start_ns = h->sync_start_ns;
+    if (sync.enabled) {
+        sync_next_boundary(now);
+    }
+    // 패턴은 라이브러리가 올라온 뒤 led_pattern_install 에서 이름으로 다시 찾는다
+    if (h->mode == LED_MODE_PATTERN) {
+        strscpy(resume_pattern, h->pattern, sizeof(resume_pattern));
+    }
+
+    if (!h->tick_ns) {
+        return;
+    }
+    // 시계가 바뀌었으면 예정 시각은 의미가 없으므로 바로 다음 tick
+    resume_tick_ns = h->virtual_clock == led_clock_is_virtual() ? h->tick_ns : now;
+    if (h->mode == LED_MODE_PATTERN) {
+        return;
+    }
+    if (sync.enabled && desc->sync == LED_SYNC_PERIOD) {
+        engine_arm(sync.ph.boundary_ns);
+    } else {
+        // 내려가 있는 동안 지나간 tick 은 몰아서 하지 않고 바로 이어 간다
+        engine_arm(max(resume_tick_ns, now));
+    }
+}
+
+// 상태와 LED 핀을 led_handoff 에 넘긴다. 넘겼으면 true (핀은 놓지 않는다)
+static bool handoff_save(void) {
+    int ret;
+
+    if (!handoff || !READ_ONCE(handoff_on_exit)) {
+        return false;
+    }
+    ret = handoff->save(&resume, sizeof(resume));
+    if (ret < 0) {
+        printk(KERN_ERR "led_control: state handoff failed (%d)\n", ret);
+        return false;
+    }
+    printk(KERN_INFO "led_control: state handed off, LED outputs left as they are\n");
+    return true;
+}
+
 static int __init led_module_init(void) {
-    int ret, i;
+    int ret;
+
+    led_engine_init(&eng, 2ULL * NSEC_PER_SEC, vm_insn_budget);
+    usage_reset(0);
 
     major_number = register_chrdev(0, DEVICE_NAME, &fops);
     if (major_number < 0) {
@@ -102,52 +1212,119 @@ static int __init led_module_init(void) {
         return major_number;
     }
 
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6, 4, 0)
     led_class = class_create(THIS_MODULE, CLASS_NAME);
+#else
+    led_class = class_create(CLASS_NAME);
+#endif
     if (IS_ERR(led_class)) {
         unregister_chrdev(major_number, DEVICE_NAME);
         return PTR_ERR(led_class);
     }
 
-    led_device = device_create(led_class, NULL, MKDEV(major_number, 0), NULL, DEVICE_NAME);
+    led_device = device_create_with_groups(led_class, NULL, MKDEV(major_number, CONTROL_MINOR), NULL,
+                                           led_device_groups, DEVICE_NAME);
     if (IS_ERR(led_device)) {
-        class_destroy(led_class);
-        unregister_chrdev(major_number, DEVICE_NAME);
-        return PTR_ERR(led_device);
+        ret = PTR_ERR(led_device);
+        goto cleanup_class;
     }
 
-    for (i = 0; i < 4; i++) {
-        ret = gpio_request(led[i], "LED");
-        if (ret < 0) {
-            printk(KERN_ERR "LED gpio_request failed for pin %d\n", led[i]);
-            goto cleanup_gpio_led;
-        }
-        gpio_direction_output(led[i], LOW);
+    events_device = device_create(led_class, NULL, MKDEV(major_number, EVENTS_MINOR), NULL, EVENTS_NAME);
+    if (IS_ERR(events_device)) {
+        ret = PTR_ERR(events_device);
+        goto cleanup_device;
+    }
+
+    handoff_take();
+    ret = handoff_claim_leds();
+    if (ret < 0) {
+        goto cleanup_events;
+    }
+    handoff_restore();
+
+    engine_task = kthread_create(engine_thread_fn, NULL, "led_engine");
+    if (IS_ERR(engine_task)) {
+        ret = PTR_ERR(engine_task);
+        goto cleanup_gpio_led;
+    }
+    led_sched_init(engine_task);
+    wake_up_process(engine_task);
+
+    led_gesture_init();
+    ret = led_pinmap_init();
+    if (ret < 0) {
+        goto cleanup_gesture;
+    }
+
+    ret = led_sysfs_init();
+    if (ret < 0) {
+        goto cleanup_pinmap;
     }
 
-    timer_setup(&timer, timer_cb, 0);
+    ret = led_netlink_init();
+    if (ret < 0) {
+        led_sysfs_exit();
+        goto cleanup_pinmap;
+    }
+
+    // 패턴 파일이 없어도 모듈은 그대로 동작
+    if (led_pattern_request(led_device, pattern_fw) < 0) {
+        printk(KERN_ERR "Invalid pattern_fw name \"%s\"\n", pattern_fw);
+    }
 
     return 0;
 
+cleanup_pinmap:
+    led_pinmap_exit();
+cleanup_gesture:
+    led_gesture_exit();
+    led_sched_exit();
+    kthread_stop(engine_task);
 cleanup_gpio_led:
-    for (i = 0; i < 4; i++) {
-        gpio_free(led[i]);
+    led_pinmap_release(false);
+cleanup_events:
+    if (handoff) {
+        symbol_put(led_handoff);
     }
-    device_destroy(led_class, MKDEV(major_number, 0));
+    device_destroy(led_class, MKDEV(major_number, EVENTS_MINOR));
+cleanup_device:
+    device_destroy(led_class, MKDEV(major_number, CONTROL_MINOR));
+cleanup_class:
     class_destroy(led_class);
     unregister_chrdev(major_number, DEVICE_NAME);
     return ret;
 }
 
 static void __exit led_module_exit(void) {
-    int i;
+    struct task_struct *task;
+    unsigned long flags;
+    bool kept;
 
-    del_timer(&timer);
+    led_pinmap_exit();
+    led_netlink_exit();
+    led_gesture_exit();
+    led_sched_exit();
+    // 이후 sysfs 쓰기가 들어와도 멈춘 스레드를 깨우지 않도록 먼저 떼어 둔다
+    spin_lock_irqsave(&led_lock, flags);
+    handoff_fill(&resume);
+    eng.mode = LED_MODE_RESET;
+    engine_stop();
+    task = engine_task;
+    engine_task = NULL;
+    spin_unlock_irqrestore(&led_lock, flags);
+    kthread_stop(task);
+    led_sysfs_exit();
 
-    for (i = 0; i < 4; i++) {
-        gpio_free(led[i]);
+    // 넘겼으면 핀과 led_handoff 참조는 다음 모듈이 가져간다
+    kept = handoff_save();
+    led_pinmap_release(kept);
+    if (handoff && !kept) {
+        symbol_put(led_handoff);
     }
+    led_pattern_free(patterns);
 
-    device_destroy(led_class, MKDEV(major_number, 0));
+    device_destroy(led_class, MKDEV(major_number, EVENTS_MINOR));
+    device_destroy(led_class, MKDEV(major_number, CONTROL_MINOR));
     class_destroy(led_class);
     unregister_chrdev(major_number, DEVICE_NAME);
 }
@@ -155,4 +1332,3 @@ static void __exit led_module_exit(void) {
 module_init(led_module_init);
 module_exit(led_module_exit);
 MODULE_LICENSE("GPL");
-
@@ -0,0 +1,297 @@
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/ktime.h>
+#include <linux/string.h>
+#include <linux/workqueue.h>
+#include <net/genetlink.h>
+
+#include "led_control.h"
+
+// generic netlink 채널
+// 이벤트 링을 모듈 안의 reader 하나(nl_tail)로 따라가면서 모은 이벤트를
+// 메시지 하나에 묶어 multicast 한다. 구독자가 몇이든 드라이버 쪽 복사는 한 번뿐이다.
+// 명령(GET/SET/EXEC)은 sysfs, dev_write 와 같은 함수를 그대로 쓴다.
+#define NL_EVENT_BATCH 16
+
+static unsigned int nl_stats_ms = 1000;
+module_param(nl_stats_ms, uint, 0644);
+MODULE_PARM_DESC(nl_stats_ms, "interval for multicast stats deltas, 0 disables (ms)");
+
+static struct genl_family led_genl_family;
+static bool nl_ready;
+static u32 nl_tail;  // 이벤트 링에서 다음에 보낼 위치 (nl_event_work 만 사용)
+static struct led_stats nl_last_stats;
+static u32 nl_last_head;
+static u64 nl_last_ns;
+static bool nl_stats_live;  // 지난번 stats 작업 때 구독자가 있었는지
+
+// 구독자가 없는 동안은 work 를 돌리지 않아 nl_tail 이 멈춰 있다.
+// 첫 구독자가 붙을 때의 링 위치를 적어 두면 nl_event_work 가 그 전 이벤트를 건너뛴다
+static DEFINE_SPINLOCK(nl_resync_lock);
+static bool nl_resync;
+static u32 nl_resync_head;
+
+enum {
+    LED_MCGRP_EVENTS,
+};
+
+static const struct genl_multicast_group led_mcgrps[] = {
+    [LED_MCGRP_EVENTS] = { .name = LED_GENL_MCGRP },
+};
+
+static const struct nla_policy led_genl_policy[LED_A_MAX + 1] = {
+    [LED_A_MODE] = NLA_POLICY_RANGE(NLA_U32, LED_MODE_BLINK, LED_MODE_MAX),
+    [LED_A_MASK] = NLA_POLICY_MAX(NLA_U32, LED_MASK_ALL),
+    [LED_A_PERIOD_NS] = { .type = NLA_U64 },
+    [LED_A_BRIGHTNESS] = NLA_POLICY_MAX(NLA_U32, 100),
+    [LED_A_COMMAND] = { .type = NLA_NUL_STRING, .len = 63 },
+};
+
+static bool nl_listening(void) {
+    return genl_has_listeners(&led_genl_family, &init_net, LED_MCGRP_EVENTS);
+}
+
+static void nl_event_work_fn(struct work_struct *work) {
+    struct led_event ev[NL_EVENT_BATCH];
+    struct sk_buff *skb;
+    void *hdr;
+    int n, i;
+
+    spin_lock_irq(&nl_resync_lock);
+    // 그 사이 이미 더 보냈으면 되돌리지 않는다
+    if (nl_resync && (s32)(nl_resync_head - nl_tail) > 0) {
+        nl_tail = nl_resync_head;
+    }
+    nl_resync = false;
+    spin_unlock_irq(&nl_resync_lock);
+
+    while ((n = led_event_fetch(&nl_tail, ev, NL_EVENT_BATCH)) > 0) {
+        // 구독자가 없으면 위치만 넘긴다
+        if (!nl_listening()) {
+            continue;
+        }
+
+        skb = genlmsg_new(n * nla_total_size(sizeof(struct led_event)), GFP_KERNEL);
+        if (!skb) {
+            return;
+        }
+        hdr = genlmsg_put(skb, 0, 0, &led_genl_family, 0, LED_CMD_EVENTS);
+        if (!hdr) {
+            nlmsg_free(skb);
+            return;
+        }
+        for (i = 0; i < n; i++) {
+            if (nla_put(skb, LED_A_EVENT, sizeof(ev[i]), &ev[i])) {
+                genlmsg_cancel(skb, hdr);
+                nlmsg_free(skb);
+                return;
+            }
+        }
+        genlmsg_end(skb, hdr);
+        genlmsg_multicast(&led_genl_family, skb, 0, LED_MCGRP_EVENTS, GFP_KERNEL);
+    }
+}
+static DECLARE_WORK(nl_event_work, nl_event_work_fn);
+
+static void nl_stats_work_fn(struct work_struct *work);
+static DECLARE_DELAYED_WORK(nl_stats_work, nl_stats_work_fn);
+
+static void nl_stats_send(void) {
+    struct led_stats_delta delta;
+    struct led_stats st;
+    struct sk_buff *skb;
+    u64 now = ktime_get_ns();
+    u32 head = led_event_head();
+    void *hdr;
+
+    led_stats_get(&st);
+    // 바뀐 게 없으면 보내지 않는다
+    if (st.ticks == nl_last_stats.ticks && head == nl_last_head) {
+        return;
+    }
+
+    delta.interval_ns = now - nl_last_ns;
+    delta.ticks = st.ticks - nl_last_stats.ticks;
+    delta.events = head - nl_last_head;
+    delta.sync_samples = st.sync_samples - nl_last_stats.sync_samples;
+    delta.max_late_ns = st.max_late_ns;
+    delta.sync_last_error_ns = st.sync_last_error_ns;
+
+    nl_last_stats = st;
+    nl_last_head = head;
+    nl_last_ns = now;
+
+    skb = genlmsg_new(nla_total_size(sizeof(delta)), GFP_KERNEL);
+    if (!skb) {
+        return;
+    }
+    hdr = genlmsg_put(skb, 0, 0, &led_genl_family, 0, LED_CMD_STATS);
+    if (!hdr || nla_put(skb, LED_A_STATS, sizeof(delta), &delta)) {
+        nlmsg_free(skb);
+        return;
+    }
+    genlmsg_end(skb, hdr);
+    genlmsg_multicast(&led_genl_family, skb, 0, LED_MCGRP_EVENTS, GFP_KERNEL);
+}
+
+// 구독자가 없던 동안은 기준값을 다시 잡고 다음 주기부터 보낸다
+static void nl_stats_rebase(void) {
+    led_stats_get(&nl_last_stats);
+    nl_last_head = led_event_head();
+    nl_last_ns = ktime_get_ns();
+}
+
+static void nl_stats_work_fn(struct work_struct *work) {
+    unsigned int ms = READ_ONCE(nl_stats_ms);
+    bool live = ms && nl_listening();
+
+    if (live && !nl_stats_live) {
+        nl_stats_rebase();
+    } else if (live) {
+        nl_stats_send();
+    }
+    nl_stats_live = live;
+    // 꺼 두었다가 다시 켜도 따라오도록 1초마다는 확인한다
+    schedule_delayed_work(&nl_stats_work, msecs_to_jiffies(ms ? ms : 1000));
+}
+
+// led_emit_event 에서 호출 (IRQ context 가능)
+void led_netlink_kick(void) {
+    if (READ_ONCE(nl_ready) && nl_listening()) {
+        schedule_work(&nl_event_work);
+    }
+}
+
+// 소켓이 그룹에 들어오기 직전에 불린다 (이때 nl_listening 에는 아직 없다)
+static int nl_mcast_bind(struct net *net, int group) {
+    if (group == LED_MCGRP_EVENTS && !nl_listening()) {
+        spin_lock_irq(&nl_resync_lock);
+        nl_resync = true;
+        nl_resync_head = led_event_head();
+        spin_unlock_irq(&nl_resync_lock);
+    }
+    return 0;
+}
+
+static int led_nl_get(struct sk_buff *skb, struct genl_info *info) {
+    struct sk_buff *msg;
+    void *hdr;
+
+    msg = genlmsg_new(NLMSG_DEFAULT_SIZE, GFP_KERNEL);
+    if (!msg) {
+        return -ENOMEM;
+    }
+    hdr = genlmsg_put(msg, info->snd_portid, info->snd_seq, &led_genl_family, 0, LED_CMD_GET);
+    if (!hdr) {
+        nlmsg_free(msg);
+        return -EMSGSIZE;
+    }
+    if (nla_put_u32(msg, LED_A_MODE, led_mode_get()) ||
+        nla_put_u32(msg, LED_A_MASK, led_mask_get()) ||
+        nla_put_u64_64bit(msg, LED_A_PERIOD_NS, led_period_get(), LED_A_PAD) ||
+        nla_put_u32(msg, LED_A_BRIGHTNESS, led_brightness_get())) {
+        genlmsg_cancel(msg, hdr);
+        nlmsg_free(msg);
+        return -EMSGSIZE;
+    }
+    genlmsg_end(msg, hdr);
+    return genlmsg_reply(msg, info);
+}
+
+static int led_nl_set(struct sk_buff *skb, struct genl_info *info) {
+    struct nlattr **attrs = info->attrs;
+    int ret;
+
+    if (attrs[LED_A_PERIOD_NS]) {
+        ret = led_period_set(nla_get_u64(attrs[LED_A_PERIOD_NS]));
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    if (attrs[LED_A_BRIGHTNESS]) {
+        ret = led_brightness_set(nla_get_u32(attrs[LED_A_BRIGHTNESS]));
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    if (attrs[LED_A_MODE]) {
+        ret = led_mode_set(nla_get_u32(attrs[LED_A_MODE]));
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    // mask 는 수동 모드로 바꾸므로 마지막에
+    if (attrs[LED_A_MASK]) {
+        led_mask_set(nla_get_u32(attrs[LED_A_MASK]));
+    }
+    return 0;
+}
+
+static int led_nl_exec(struct sk_buff *skb, struct genl_info *info) {
+    char input[LED_TEXT_MAX];
+    struct led_text t;
+
+    if (!info->attrs[LED_A_COMMAND]) {
+        return -EINVAL;
+    }
+    nla_strscpy(input, info->attrs[LED_A_COMMAND], sizeof(input));
+    // 모드 번호는 LED_A_MODE 로 받는다
+    if (led_text_parse(input, &t) < 0 || t.kind != LED_TEXT_CMD) {
+        return -EINVAL;
+    }
+    return led_command(t.cmd, t.arg);
+}
+
+static const struct genl_small_ops led_genl_ops[] = {
+    {
+        .cmd = LED_CMD_GET,
+        .doit = led_nl_get,
+    },
+    {
+        .cmd = LED_CMD_SET,
+        .doit = led_nl_set,
+        .flags = GENL_ADMIN_PERM,
+    },
+    {
+        .cmd = LED_CMD_EXEC,
+        .doit = led_nl_exec,
+        .flags = GENL_ADMIN_PERM,
+    },
+};
+
+static struct genl_family led_genl_family = {
+    .name = LED_GENL_NAME,
+    .version = LED_GENL_VERSION,
+    .maxattr = LED_A_MAX,
+    .policy = led_genl_policy,
+    .module = THIS_MODULE,
+    .small_ops = led_genl_ops,
+    .n_small_ops = ARRAY_SIZE(led_genl_ops),
+    .resv_start_op = LED_CMD_GET,
+    .mcgrps = led_mcgrps,
+    .n_mcgrps = ARRAY_SIZE(led_mcgrps),
+    .mcast_bind = nl_mcast_bind,
+};
+
+int led_netlink_init(void) {
+    int ret;
+
+    ret = genl_register_family(&led_genl_family);
+    if (ret < 0) {
+        printk(KERN_ERR "Failed to register generic netlink family\n");
+        return ret;
+    }
+
+    nl_tail = led_event_head();
+    nl_stats_rebase();
+    WRITE_ONCE(nl_ready, true);
+    schedule_delayed_work(&nl_stats_work, msecs_to_jiffies(nl_stats_ms ? nl_stats_ms : 1000));
+    return 0;
+}
+
+void led_netlink_exit(void) {
+    WRITE_ONCE(nl_ready, false);
+    cancel_delayed_work_sync(&nl_stats_work);
+    cancel_work_sync(&nl_event_work);
+    genl_unregister_family(&led_genl_family);
+}
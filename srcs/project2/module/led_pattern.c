@@ -0,0 +1,208 @@
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/crc32.h>
+#include <linux/ctype.h>
+#include <linux/device.h>
+#include <linux/firmware.h>
+#include <linux/overflow.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <asm/unaligned.h>
+
+#include "led_control.h"
+
+// 패턴 라이브러리 (request_firmware 로 읽는 RLE 파일) 디코딩
+
+// 라이브러리는 펌웨어 디렉터리의 led-patterns/<이름>.bin 만 읽는다.
+// 이름은 [A-Za-z0-9_-] 로만 받아서 세션이 다른 경로("/", "..")를 찾아보지 못하게 한다
+#define PATTERN_FW_DIR "led-patterns/"
+#define PATTERN_FW_EXT ".bin"
+#define PATTERN_FW_NAME_MAX 32
+
+MODULE_FIRMWARE(PATTERN_FW_DIR "default" PATTERN_FW_EXT);
+
+// 한 패턴의 run 들을 검사하고 프레임 수를 센다. 같은 mask 가 이어지는 run 은 한 프레임으로 합친다.
+// out 이 있으면 프레임 테이블도 채운다.
+static int pattern_scan(const u8 *p, u16 runs, u16 frame_ms, struct led_frame *out) {
+    const struct led_pat_run *run = (const void *)p;
+    int nframes = 0, prev = -1;
+    u16 i;
+
+    for (i = 0; i < runs; i++, run++) {
+        if (run->count == 0 || (run->mask & ~LED_MASK_ALL)) {
+            return -EINVAL;
+        }
+        if (run->mask != prev) {
+            if (nframes == LED_PAT_MAX_FRAMES) {
+                return -E2BIG;
+            }
+            if (out) {
+                out[nframes].mask = run->mask;
+                out[nframes].duration_ms = 0;
+            }
+            nframes++;
+            prev = run->mask;
+        }
+        if (out) {
+            out[nframes - 1].duration_ms += run->count * frame_ms;
+        }
+    }
+
+    return nframes;
+}
+
+// 파일 전체를 두 번 훑는다: 1) 검증하며 크기 계산 2) 한 번에 할당해 채우기
+int led_pattern_decode(const u8 *data, size_t size, struct led_pattern_lib **out) {
+    const struct led_pat_file_header *fh = (const void *)data;
+    struct led_pattern_lib *lib;
+    struct led_frame *frames;
+    size_t pos, total = 0;
+    u16 count, i;
+    int pass, n;
+
+    if (size < sizeof(*fh) + sizeof(u32) ||
+        get_unaligned_le32(&fh->magic) != LED_PAT_MAGIC ||
+        get_unaligned_le16(&fh->version) != LED_PAT_VERSION) {
+        return -EINVAL;
+    }
+    if ((crc32_le(~0, data, size - sizeof(u32)) ^ ~0) != get_unaligned_le32(data + size - sizeof(u32))) {
+        return -EBADMSG;
+    }
+    size -= sizeof(u32);
+
+    count = get_unaligned_le16(&fh->count);
+    if (count == 0 || count > LED_PAT_MAX) {
+        return -EINVAL;
+    }
+
+    lib = NULL;
+    frames = NULL;
+    for (pass = 0; pass < 2; pass++) {
+        pos = sizeof(*fh);
+        for (i = 0; i < count; i++) {
+            const struct led_pat_header *ph = (const void *)(data + pos);
+            u16 runs, frame_ms;
+
+            if (pos + sizeof(*ph) > size) {
+                goto invalid;
+            }
+            runs = get_unaligned_le16(&ph->runs);
+            frame_ms = get_unaligned_le16(&ph->frame_ms);
+            pos += sizeof(*ph);
+            if (runs == 0 || frame_ms == 0 || pos + runs * sizeof(struct led_pat_run) > size) {
+                goto invalid;
+            }
+
+            n = pattern_scan(data + pos, runs, frame_ms, pass ? frames : NULL);
+            if (n < 0) {
+                kfree(lib);
+                return n;
+            }
+            pos += runs * sizeof(struct led_pat_run);
+
+            if (pass == 0) {
+                total += n;
+                continue;
+            }
+            memcpy(lib->patterns[i].name, ph->name, LED_PAT_NAME_LEN);
+            lib->patterns[i].name[LED_PAT_NAME_LEN - 1] = '\0';
+            lib->patterns[i].loop = ph->flags & LED_PAT_LOOP;
+            lib->patterns[i].nframes = n;
+            lib->patterns[i].frames = frames;
+            frames += n;
+        }
+        if (pos != size) {
+            goto invalid;
+        }
+
+        if (pass == 0) {
+            lib = kzalloc(struct_size(lib, patterns, count) + total * sizeof(struct led_frame), GFP_KERNEL);
+            if (!lib) {
+                return -ENOMEM;
+            }
+            lib->count = count;
+            frames = (struct led_frame *)&lib->patterns[count];
+        }
+    }
+
+    *out = lib;
+    return 0;
+
+invalid:
+    kfree(lib);
+    return -EINVAL;
+}
+
+void led_pattern_free(struct led_pattern_lib *lib) {
+    kfree(lib);
+}
+
+// 번호 또는 이름으로 찾는다. 없으면 -ENOENT
+int led_pattern_find(const struct led_pattern_lib *lib, const char *arg) {
+    int i;
+
+    if (!lib) {
+        return -ENOENT;
+    }
+    if (kstrtoint(arg, 10, &i) != 0) {
+        for (i = 0; i < lib->count; i++) {
+            if (strcmp(lib->patterns[i].name, arg) == 0) {
+                break;
+            }
+        }
+    }
+    return (i < 0 || i >= lib->count) ? -ENOENT : i;
+}
+
+static void pattern_fw_loaded(const struct firmware *fw, void *context) {
+    struct led_pattern_lib *lib;
+    int ret;
+
+    if (!fw) {
+        printk(KERN_INFO "LED pattern file not available\n");
+        led_emit_event(LED_EV_PATTERN, LED_PAT_EV_FAILED, -ENOENT);
+        return;
+    }
+
+    ret = led_pattern_decode(fw->data, fw->size, &lib);
+    release_firmware(fw);
+    if (ret < 0) {
+        printk(KERN_ERR "Invalid LED pattern file (%d)\n", ret);
+        led_emit_event(LED_EV_PATTERN, LED_PAT_EV_FAILED, ret);
+        return;
+    }
+
+    printk(KERN_INFO "Loaded %d LED patterns\n", lib->count);
+    led_pattern_install(lib);
+}
+
+// 라이브러리 이름 -> 펌웨어 경로. 허용하지 않는 글자가 있으면 -EINVAL
+int led_pattern_fw_path(char *buf, size_t size, const char *name) {
+    size_t len = strlen(name);
+    size_t i;
+
+    if (len == 0 || len > PATTERN_FW_NAME_MAX) {
+        return -EINVAL;
+    }
+    for (i = 0; i < len; i++) {
+        if (!isalnum(name[i]) && name[i] != '_' && name[i] != '-') {
+            return -EINVAL;
+        }
+    }
+    if (snprintf(buf, size, PATTERN_FW_DIR "%s" PATTERN_FW_EXT, name) >= size) {
+        return -ENAMETOOLONG;
+    }
+    return 0;
+}
+
+// 비동기로 읽는다. 끝나면 led_pattern_install 로 교체된다.
+int led_pattern_request(struct device *dev, const char *name) {
+    char path[sizeof(PATTERN_FW_DIR) + PATTERN_FW_NAME_MAX + sizeof(PATTERN_FW_EXT)];
+    int ret;
+
+    ret = led_pattern_fw_path(path, sizeof(path), name);
+    if (ret < 0) {
+        return ret;
+    }
+    return request_firmware_nowait(THIS_MODULE, FW_ACTION_UEVENT, path, dev, GFP_KERNEL, NULL, pattern_fw_loaded);
+}
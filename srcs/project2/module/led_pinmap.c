@@ -0,0 +1,777 @@
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/configfs.h>
+#include <linux/gpio/consumer.h>
+#include <linux/gpio/driver.h>
+#include <linux/gpio/machine.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
+#include <linux/overflow.h>
+#include <linux/rcupdate.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/workqueue.h>
+
+#include "led_control.h"
+
+// 핀 배치 (configfs, 모듈을 다시 올리지 않고 LED/스위치 라인을 바꾼다)
+// /sys/kernel/config/led_control
+//   banks/<이름>/chip        : gpiochip label. 이 bank 를 쓰는 라인은 칩 안의 offset 으로 고른다
+//                              (gpiod lookup table 로 찾으므로 전역 번호를 몰라도 된다)
+//   leds/<0-3>/bank, offset  : LED[i] 라인. bank 가 비어 있으면 offset 이 전역 GPIO 번호, -1 이면 안 쓴다
+//   switches/<0-3>/bank, offset
+//   apply                    : 1 을 쓰면 적어 둔 배치로 바꾼다. 새 라인과 스위치 IRQ 를 다 잡은 뒤에
+//                              한 번에 바꾸므로 실패하면 예전 배치가 그대로 남는다.
+//                              LED 와 스위치 사이에서 라인을 옮길 때는 한 번 비워 두고 다시 apply
+//   active                   : 지금 쓰는 전역 GPIO 번호 (led/sw 파라미터와 같은 값)
+// 디렉터리를 만들지 않은 LED/스위치는 지금 라인을 그대로 쓴다. 첫 배치는 led/sw 파라미터.
+// I2C 확장 칩처럼 잠들 수 있는 칩의 LED 는 led_lock 밖의 work 에서 쓴다.
+
+// 출력 쪽이 RCU 로 읽는 LED 배치. 바꿀 때는 새로 만들어 통째로 바꾼다
+struct led_pinmap {
+    unsigned int nlines;                  // 쓰는 LED 라인 수
+    bool cansleep;                        // 잠들 수 있는 라인이 있으면 pin_work 로 쓴다
+    struct gpio_desc *desc[LED_NUM];      // 쓰는 라인만 LED 번호 순서로
+    unsigned long bits[LED_MASK_ALL + 1]; // LED 마스크 -> desc 순서 비트맵 (미리 계산)
+};
+
+static struct led_pinmap boot_map;  // 모듈을 올릴 때의 배치 (해제하지 않는다)
+static struct led_pinmap __rcu *pinmap;
+static struct device *pin_dev;
+static const char *pin_label = "LED";
+static DEFINE_MUTEX(pinmap_mutex);  // 아래 설정과 apply
+
+// 잠드는 칩에 낼 마지막 마스크. pin_work 가 pin_write_mutex 를 잡고 내보내고,
+// 배치도 같은 mutex 안에서 바꾸므로 work 가 놓인 라인에 쓰는 일은 없다
+static u32 pin_pending;
+static DEFINE_MUTEX(pin_write_mutex);
+
+#define PIN_NAME_LEN 32
+
+// 라인 하나. chip 이 비어 있으면 offset 이 전역 GPIO 번호, offset 이 -1 이면 안 쓴다
+struct pin_spec {
+    char chip[PIN_NAME_LEN];
+    int offset;
+};
+
+// 지금 잡고 있는 라인 (pinmap_mutex)
+static struct pin_spec led_cur[LED_NUM];
+static struct pin_spec sw_cur[SW_NUM];
+static struct gpio_desc *led_desc[LED_NUM];
+static struct gpio_desc *sw_desc[SW_NUM];
+static struct led_sw_line *sw_line[SW_NUM];
+
+struct pin_bank {
+    struct config_item item;
+    struct list_head node;
+    char chip[PIN_NAME_LEN];
+};
+
+struct pin_line {
+    struct config_item item;
+    int index;
+    char bank[PIN_NAME_LEN];
+    int offset;
+};
+
+static LIST_HEAD(banks);
+static struct pin_line *cfg_led[LED_NUM];
+static struct pin_line *cfg_sw[SW_NUM];
+
+static void pinmap_build(struct led_pinmap *map, struct gpio_desc *const *descs) {
+    unsigned int m, i, k;
+
+    memset(map, 0, sizeof(*map));
+    for (i = 0; i < LED_NUM; i++) {
+        if (descs[i]) {
+            map->cansleep |= gpiod_cansleep(descs[i]);
+            map->desc[map->nlines++] = descs[i];
+        }
+    }
+    for (m = 0; m <= LED_MASK_ALL; m++) {
+        for (i = 0, k = 0; i < LED_NUM; i++) {
+            if (!descs[i]) {
+                continue;
+            }
+            if (m & BIT(i)) {
+                map->bits[m] |= BIT(k);
+            }
+            k++;
+        }
+    }
+}
+
+static void pin_work_fn(struct work_struct *work) {
+    struct led_pinmap *map;
+
+    mutex_lock(&pin_write_mutex);
+    map = rcu_dereference_protected(pinmap, lockdep_is_held(&pin_write_mutex));
+    if (map && map->nlines) {
+        gpiod_set_array_value_cansleep(map->nlines, map->desc, NULL,
+                                       &map->bits[READ_ONCE(pin_pending) & LED_MASK_ALL]);
+    }
+    mutex_unlock(&pin_write_mutex);
+}
+static DECLARE_WORK(pin_work, pin_work_fn);
+
+// LED 마스크를 한 번에 내보낸다 (led_lock 잡은 상태에서 호출)
+void led_pinmap_write(u32 mask) {
+    struct led_pinmap *map;
+
+    rcu_read_lock();
+    map = rcu_dereference(pinmap);
+    if (map && map->cansleep) {
+        // 여러 번 쌓여도 마지막 값만 나가면 된다
+        WRITE_ONCE(pin_pending, mask);
+        queue_work(system_highpri_wq, &pin_work);
+    } else if (map && map->nlines) {
+        gpiod_set_array_value(map->nlines, map->desc, NULL, &map->bits[mask & LED_MASK_ALL]);
+    }
+    rcu_read_unlock();
+}
+
+static void pinmap_swap(struct led_pinmap *map) {
+    mutex_lock(&pin_write_mutex);
+    rcu_assign_pointer(pinmap, map);
+    mutex_unlock(&pin_write_mutex);
+}
+
+static struct gpio_desc *pin_get(const struct pin_spec *s, const char *label, enum gpiod_flags flags);
+
+// 모듈을 올릴 때 led[] 로 첫 배치를 만든다. handed 의 LED 는 앞 모듈이 잡은 채 넘겨준 라인이라
+// 그대로 쓰고, 나머지는 level 의 값으로 켜거나 끈 채 잡는다. 실패하면 넘겨받은 라인까지 모두 놓는다
+int led_pinmap_setup(struct device *dev, const char *label, u32 handed, u32 level) {
+    struct gpio_desc *desc;
+    int i;
+
+    pin_dev = dev;
+    pin_label = label;
+    for (i = 0; i < LED_NUM; i++) {
+        led_cur[i].chip[0] = '\0';
+        led_cur[i].offset = led[i];
+        if (led[i] < 0) {
+            continue;
+        }
+        if (handed & BIT(i)) {
+            led_desc[i] = gpio_to_desc(led[i]);
+            continue;
+        }
+        desc = pin_get(&led_cur[i], label, (level & BIT(i)) ? GPIOD_OUT_HIGH : GPIOD_OUT_LOW);
+        if (IS_ERR(desc)) {
+            goto fail;
+        }
+        led_desc[i] = desc;
+    }
+    pinmap_build(&boot_map, led_desc);
+    pinmap_swap(&boot_map);
+    return 0;
+
+fail:
+    for (i = 0; i < LED_NUM; i++) {
+        if (led_desc[i]) {
+            gpiod_put(led_desc[i]);
+        }
+        led_desc[i] = NULL;
+    }
+    return PTR_ERR(desc);
+}
+
+// LED 라인을 모두 놓는다. keep 이면 핀은 넘겼으므로 배치만 정리
+void led_pinmap_release(bool keep) {
+    struct led_pinmap *map = rcu_dereference_protected(pinmap, true);
+    int i;
+
+    // 넘길 때는 밀려 있던 마지막 값까지 내보낸 뒤 놓는다
+    flush_work(&pin_work);
+    pinmap_swap(NULL);
+    synchronize_rcu();
+    cancel_work_sync(&pin_work);
+    for (i = 0; i < LED_NUM; i++) {
+        if (led_desc[i] && !keep) {
+            gpiod_set_value_cansleep(led_desc[i], 0);
+            gpiod_put(led_desc[i]);
+        }
+        led_desc[i] = NULL;
+    }
+    if (map != &boot_map) {
+        kfree(map);
+    }
+}
+
+static bool spec_same(const struct pin_spec *a, const struct pin_spec *b) {
+    return a->offset == b->offset && !strcmp(a->chip, b->chip);
+}
+
+// 지금 잡고 있는 라인이면 그 desc. 전역 번호로 적었으면 어느 칩 라인이든 번호로 맞춰 본다.
+// 번호로 잡은 라인을 bank 로 다시 적으면 찾지 못해 새로 잡으려다 -EBUSY 가 된다
+static struct gpio_desc *spec_held(const struct pin_spec *s, const struct pin_spec *cur,
+                                   struct gpio_desc *const *descs, int n) {
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (!descs[i]) {
+            continue;
+        }
+        if (spec_same(s, &cur[i]) || (!s->chip[0] && desc_to_gpio(descs[i]) == s->offset)) {
+            return descs[i];
+        }
+    }
+    return NULL;
+}
+
+// 칩 label + offset 으로 라인을 잡는다. 우리 장치 이름으로 lookup table 을 잠깐 걸고 gpiod_get
+static struct gpio_desc *pin_get_bank(const struct pin_spec *s, const char *label, enum gpiod_flags flags) {
+    struct gpiod_lookup_table *t;
+    struct gpio_desc *desc;
+
+    t = kzalloc(struct_size(t, table, 2), GFP_KERNEL);
+    if (!t) {
+        return ERR_PTR(-ENOMEM);
+    }
+    t->dev_id = dev_name(pin_dev);
+    t->table[0] = (struct gpiod_lookup)GPIO_LOOKUP(s->chip, s->offset, label, GPIO_ACTIVE_HIGH);
+    gpiod_add_lookup_table(t);
+    desc = gpiod_get(pin_dev, label, flags);
+    gpiod_remove_lookup_table(t);
+    kfree(t);
+    // 칩이 없으면 probe 를 미루라고 하지만 여기서는 기다릴 곳이 없다
+    if (desc == ERR_PTR(-EPROBE_DEFER)) {
+        return ERR_PTR(-ENODEV);
+    }
+    return desc;
+}
+
+// 전역 번호로 적은 라인은 그 번호가 속한 칩 label + offset 으로 바꿔 같은 gpiod_get 으로 잡는다.
+// 그래서 어느 쪽으로 잡은 라인이든 gpiod_put 으로 놓는다
+static struct gpio_desc *pin_get_number(int gpio, const char *label, enum gpiod_flags flags) {
+    struct gpio_desc *desc = gpio_to_desc(gpio);
+    struct gpio_chip *gc;
+    struct pin_spec s;
+
+    gc = desc ? gpiod_to_chip(desc) : NULL;
+    if (!gc) {
+        return ERR_PTR(-EINVAL);
+    }
+    if (strscpy(s.chip, gc->label, sizeof(s.chip)) < 0) {
+        return ERR_PTR(-ENAMETOOLONG);
+    }
+    s.offset = gpio - gc->base;
+    return pin_get_bank(&s, label, flags);
+}
+
+// LED 는 출력, 스위치는 입력 (flags) 으로 잡는다
+static struct gpio_desc *pin_get(const struct pin_spec *s, const char *label, enum gpiod_flags flags) {
+    struct gpio_desc *desc;
+
+    if (s->chip[0]) {
+        desc = pin_get_bank(s, label, flags);
+    } else {
+        desc = pin_get_number(s->offset, label, flags);
+    }
+    if (IS_ERR(desc)) {
+        printk(KERN_ERR "led_control: cannot get line %s:%d (%ld)\n",
+               s->chip[0] ? s->chip : "gpio", s->offset, PTR_ERR(desc));
+    }
+    return desc;
+}
+
+static struct pin_bank *bank_find(const char *name) {
+    struct pin_bank *b;
+
+    list_for_each_entry(b, &banks, node) {
+        if (!strcmp(config_item_name(&b->item), name)) {
+            return b;
+        }
+    }
+    return NULL;
+}
+
+// 적어 둔 라인 -> pin_spec. 디렉터리가 없으면 cur 그대로
+static int line_resolve(const struct pin_line *ln, const struct pin_spec *cur, struct pin_spec *s) {
+    struct pin_bank *b;
+
+    if (!ln) {
+        *s = *cur;
+        return 0;
+    }
+    s->chip[0] = '\0';
+    s->offset = ln->offset;
+    if (ln->offset < 0 || !ln->bank[0]) {
+        return ln->offset < 0 || gpio_to_desc(ln->offset) ? 0 : -EINVAL;
+    }
+    b = bank_find(ln->bank);
+    if (!b || !b->chip[0]) {
+        return -ENOENT;
+    }
+    strscpy(s->chip, b->chip, sizeof(s->chip));
+    return 0;
+}
+
+// 새 배치. 라인과 스위치 IRQ 를 먼저 다 잡고(새 IRQ 는 엣지를 버리며 대기),
+// 그 다음 LED 배치와 스위치를 한 번에 바꾼다. 중간에 실패하면 새로 잡은 것만 놓으므로
+// 예전 배치가 그대로 남는다. 더 안 쓰는 라인은 읽는 쪽이 다 빠진 뒤 놓는다
+static int pinmap_apply(void) {
+    struct pin_spec specs[LED_NUM + SW_NUM];
+    struct pin_spec *new_led = specs, *new_sw = specs + LED_NUM;
+    struct gpio_desc *descs[LED_NUM + SW_NUM] = { NULL };
+    struct gpio_desc **nled = descs, **nsw = descs + LED_NUM;
+    struct led_sw_line *lines[SW_NUM] = { NULL };
+    bool fresh[LED_NUM + SW_NUM] = { false };
+    struct led_pinmap *map = NULL, *old;
+    int ret, i, k;
+
+    mutex_lock(&pinmap_mutex);
+    for (i = 0; i < LED_NUM; i++) {
+        ret = line_resolve(cfg_led[i], &led_cur[i], &new_led[i]);
+        if (ret < 0) {
+            goto out;
+        }
+    }
+    for (i = 0; i < SW_NUM; i++) {
+        ret = line_resolve(cfg_sw[i], &sw_cur[i], &new_sw[i]);
+        if (ret < 0) {
+            goto out;
+        }
+    }
+    // 한 라인을 두 곳에서 쓸 수 없다
+    for (i = 1; i < LED_NUM + SW_NUM; i++) {
+        for (k = 0; specs[i].offset >= 0 && k < i; k++) {
+            if (spec_same(&specs[i], &specs[k])) {
+                ret = -EBUSY;
+                goto out;
+            }
+        }
+    }
+
+    map = kzalloc(sizeof(*map), GFP_KERNEL);
+    if (!map) {
+        ret = -ENOMEM;
+        goto out;
+    }
+    // 같은 역할로 이미 잡고 있으면 그대로 쓰고, 다른 역할로 잡고 있으면 옮길 수 없다
+    for (i = 0; i < LED_NUM + SW_NUM; i++) {
+        bool is_led = i < LED_NUM;
+        const struct pin_spec *cur = is_led ? led_cur : sw_cur;
+        struct gpio_desc **held = is_led ? led_desc : sw_desc;
+        int n = is_led ? LED_NUM : SW_NUM;
+
+        if (specs[i].offset < 0) {
+            continue;
+        }
+        descs[i] = spec_held(&specs[i], cur, held, n);
+        if (descs[i]) {
+            continue;
+        }
+        if (spec_held(&specs[i], is_led ? sw_cur : led_cur, is_led ? sw_desc : led_desc,
+                      is_led ? SW_NUM : LED_NUM)) {
+            ret = -EBUSY;
+            goto cleanup;
+        }
+        descs[i] = pin_get(&specs[i], is_led ? pin_label : "SW", is_led ? GPIOD_OUT_LOW : GPIOD_IN);
+        if (IS_ERR(descs[i])) {
+            ret = PTR_ERR(descs[i]);
+            descs[i] = NULL;
+            goto cleanup;
+        }
+        fresh[i] = true;
+    }
+    for (i = 0; i < SW_NUM; i++) {
+        if (!fresh[LED_NUM + i]) {
+            for (k = 0; nsw[i] && k < SW_NUM; k++) {
+                if (sw_desc[k] == nsw[i]) {
+                    lines[i] = sw_line[k];
+                }
+            }
+            continue;
+        }
+        lines[i] = led_gesture_line_get(nsw[i]);
+        if (IS_ERR(lines[i])) {
+            ret = PTR_ERR(lines[i]);
+            lines[i] = NULL;
+            goto cleanup;
+        }
+    }
+    pinmap_build(map, nled);
+
+    // 여기부터는 실패하지 않는다
+    old = rcu_dereference_protected(pinmap, lockdep_is_held(&pinmap_mutex));
+    pinmap_swap(map);
+    led_output_refresh();
+    led_gesture_bind(lines);
+    for (i = 0; i < LED_NUM + SW_NUM; i++) {
+        int *num = i < LED_NUM ? &led[i] : &sw[i - LED_NUM];
+
+        *num = descs[i] ? desc_to_gpio(descs[i]) : -1;
+    }
+    synchronize_rcu();
+
+    for (i = 0; i < LED_NUM; i++) {
+        for (k = 0; led_desc[i] && k < LED_NUM; k++) {
+            if (nled[k] == led_desc[i]) {
+                break;
+            }
+        }
+        if (led_desc[i] && k == LED_NUM) {
+            gpiod_set_value_cansleep(led_desc[i], 0);
+            gpiod_put(led_desc[i]);
+        }
+    }
+    for (i = 0; i < SW_NUM; i++) {
+        for (k = 0; sw_desc[i] && k < SW_NUM; k++) {
+            if (nsw[k] == sw_desc[i]) {
+                break;
+            }
+        }
+        if (sw_desc[i] && k == SW_NUM) {
+            led_gesture_line_put(sw_line[i]);
+            gpiod_put(sw_desc[i]);
+        }
+    }
+    memcpy(led_cur, new_led, sizeof(led_cur));
+    memcpy(sw_cur, new_sw, sizeof(sw_cur));
+    memcpy(led_desc, nled, sizeof(led_desc));
+    memcpy(sw_desc, nsw, sizeof(sw_desc));
+    memcpy(sw_line, lines, sizeof(sw_line));
+    if (old != &boot_map) {
+        kfree(old);
+    }
+    ret = 0;
+    goto out;
+
+cleanup:
+    for (i = 0; i < SW_NUM; i++) {
+        if (fresh[LED_NUM + i] && lines[i]) {
+            led_gesture_line_put(lines[i]);
+        }
+    }
+    for (i = 0; i < LED_NUM + SW_NUM; i++) {
+        if (fresh[i]) {
+            gpiod_put(descs[i]);
+        }
+    }
+    kfree(map);
+out:
+    mutex_unlock(&pinmap_mutex);
+    return ret;
+}
+
+static void attr_copy(char *dst, size_t size, const char *page) {
+    strscpy(dst, page, size);
+    dst[strcspn(dst, "\n")] = '\0';
+}
+
+// banks/<이름>
+static inline struct pin_bank *to_pin_bank(struct config_item *item) {
+    return container_of(item, struct pin_bank, item);
+}
+
+static ssize_t bank_chip_show(struct config_item *item, char *page) {
+    struct pin_bank *b = to_pin_bank(item);
+    ssize_t len;
+
+    mutex_lock(&pinmap_mutex);
+    len = scnprintf(page, PAGE_SIZE, "%s\n", b->chip);
+    mutex_unlock(&pinmap_mutex);
+    return len;
+}
+
+static ssize_t bank_chip_store(struct config_item *item, const char *page, size_t count) {
+    struct pin_bank *b = to_pin_bank(item);
+
+    mutex_lock(&pinmap_mutex);
+    attr_copy(b->chip, sizeof(b->chip), page);
+    mutex_unlock(&pinmap_mutex);
+    return count;
+}
+
+CONFIGFS_ATTR(bank_, chip);
+
+static struct configfs_attribute *bank_attrs[] = {
+    &bank_attr_chip,
+    NULL,
+};
+
+static void bank_release(struct config_item *item) {
+    kfree(to_pin_bank(item));
+}
+
+static struct configfs_item_operations bank_item_ops = {
+    .release = bank_release,
+};
+
+static const struct config_item_type bank_type = {
+    .ct_item_ops = &bank_item_ops,
+    .ct_attrs = bank_attrs,
+    .ct_owner = THIS_MODULE,
+};
+
+static struct config_item *banks_make_item(struct config_group *group, const char *name) {
+    struct pin_bank *b = kzalloc(sizeof(*b), GFP_KERNEL);
+
+    if (!b) {
+        return ERR_PTR(-ENOMEM);
+    }
+    config_item_init_type_name(&b->item, name, &bank_type);
+    mutex_lock(&pinmap_mutex);
+    list_add_tail(&b->node, &banks);
+    mutex_unlock(&pinmap_mutex);
+    return &b->item;
+}
+
+static void banks_drop_item(struct config_group *group, struct config_item *item) {
+    mutex_lock(&pinmap_mutex);
+    list_del(&to_pin_bank(item)->node);
+    mutex_unlock(&pinmap_mutex);
+    config_item_put(item);
+}
+
+static struct configfs_group_operations banks_group_ops = {
+    .make_item = banks_make_item,
+    .drop_item = banks_drop_item,
+};
+
+static const struct config_item_type banks_type = {
+    .ct_group_ops = &banks_group_ops,
+    .ct_owner = THIS_MODULE,
+};
+
+// leds/<i>, switches/<i>
+static inline struct pin_line *to_pin_line(struct config_item *item) {
+    return container_of(item, struct pin_line, item);
+}
+
+static ssize_t line_bank_show(struct config_item *item, char *page) {
+    struct pin_line *ln = to_pin_line(item);
+    ssize_t len;
+
+    mutex_lock(&pinmap_mutex);
+    len = scnprintf(page, PAGE_SIZE, "%s\n", ln->bank);
+    mutex_unlock(&pinmap_mutex);
+    return len;
+}
+
+static ssize_t line_bank_store(struct config_item *item, const char *page, size_t count) {
+    struct pin_line *ln = to_pin_line(item);
+
+    mutex_lock(&pinmap_mutex);
+    attr_copy(ln->bank, sizeof(ln->bank), page);
+    mutex_unlock(&pinmap_mutex);
+    return count;
+}
+
+static ssize_t line_offset_show(struct config_item *item, char *page) {
+    return scnprintf(page, PAGE_SIZE, "%d\n", READ_ONCE(to_pin_line(item)->offset));
+}
+
+static ssize_t line_offset_store(struct config_item *item, const char *page, size_t count) {
+    int offset, ret;
+
+    ret = kstrtoint(page, 0, &offset);
+    if (ret < 0) {
+        return ret;
+    }
+    WRITE_ONCE(to_pin_line(item)->offset, offset < 0 ? -1 : offset);
+    return count;
+}
+
+CONFIGFS_ATTR(line_, bank);
+CONFIGFS_ATTR(line_, offset);
+
+static struct configfs_attribute *line_attrs[] = {
+    &line_attr_bank,
+    &line_attr_offset,
+    NULL,
+};
+
+static void line_release(struct config_item *item) {
+    kfree(to_pin_line(item));
+}
+
+static struct configfs_item_operations line_item_ops = {
+    .release = line_release,
+};
+
+static const struct config_item_type line_type = {
+    .ct_item_ops = &line_item_ops,
+    .ct_attrs = line_attrs,
+    .ct_owner = THIS_MODULE,
+};
+
+// 이름은 번호 ("0".."n-1"). 처음 값은 지금 쓰는 전역 GPIO 번호
+static struct config_item *line_make(struct pin_line **slots, const int *cur, unsigned int n, const char *name) {
+    struct pin_line *ln;
+    unsigned int i;
+
+    if (kstrtouint(name, 10, &i) < 0 || i >= n) {
+        return ERR_PTR(-EINVAL);
+    }
+    ln = kzalloc(sizeof(*ln), GFP_KERNEL);
+    if (!ln) {
+        return ERR_PTR(-ENOMEM);
+    }
+    config_item_init_type_name(&ln->item, name, &line_type);
+    ln->index = i;
+    mutex_lock(&pinmap_mutex);
+    ln->offset = cur[i];
+    slots[i] = ln;
+    mutex_unlock(&pinmap_mutex);
+    return &ln->item;
+}
+
+static void line_drop(struct pin_line **slots, struct config_item *item) {
+    mutex_lock(&pinmap_mutex);
+    slots[to_pin_line(item)->index] = NULL;
+    mutex_unlock(&pinmap_mutex);
+    config_item_put(item);
+}
+
+static struct config_item *leds_make_item(struct config_group *group, const char *name) {
+    return line_make(cfg_led, led, LED_NUM, name);
+}
+
+static void leds_drop_item(struct config_group *group, struct config_item *item) {
+    line_drop(cfg_led, item);
+}
+
+static struct config_item *switches_make_item(struct config_group *group, const char *name) {
+    return line_make(cfg_sw, sw, SW_NUM, name);
+}
+
+static void switches_drop_item(struct config_group *group, struct config_item *item) {
+    line_drop(cfg_sw, item);
+}
+
+static struct configfs_group_operations leds_group_ops = {
+    .make_item = leds_make_item,
+    .drop_item = leds_drop_item,
+};
+
+static struct configfs_group_operations switches_group_ops = {
+    .make_item = switches_make_item,
+    .drop_item = switches_drop_item,
+};
+
+static const struct config_item_type leds_type = {
+    .ct_group_ops = &leds_group_ops,
+    .ct_owner = THIS_MODULE,
+};
+
+static const struct config_item_type switches_type = {
+    .ct_group_ops = &switches_group_ops,
+    .ct_owner = THIS_MODULE,
+};
+
+// 최상위: apply, active
+static ssize_t pinmap_apply_store(struct config_item *item, const char *page, size_t count) {
+    bool on;
+    int ret;
+
+    ret = kstrtobool(page, &on);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = on ? pinmap_apply() : 0;
+    return ret < 0 ? ret : count;
+}
+
+static ssize_t pinmap_active_show(struct config_item *item, char *page) {
+    ssize_t len = 0;
+    int i;
+
+    mutex_lock(&pinmap_mutex);
+    for (i = 0; i < LED_NUM; i++) {
+        len += scnprintf(page + len, PAGE_SIZE - len, "led%d %d\n", i, led[i]);
+    }
+    for (i = 0; i < SW_NUM; i++) {
+        len += scnprintf(page + len, PAGE_SIZE - len, "sw%d %d\n", i, sw[i]);
+    }
+    mutex_unlock(&pinmap_mutex);
+    return len;
+}
+
+CONFIGFS_ATTR_WO(pinmap_, apply);
+CONFIGFS_ATTR_RO(pinmap_, active);
+
+static struct configfs_attribute *pinmap_attrs[] = {
+    &pinmap_attr_apply,
+    &pinmap_attr_active,
+    NULL,
+};
+
+static const struct config_item_type pinmap_type = {
+    .ct_attrs = pinmap_attrs,
+    .ct_owner = THIS_MODULE,
+};
+
+static struct config_group banks_group;
+static struct config_group leds_group;
+static struct config_group switches_group;
+static struct configfs_subsystem pin_subsys;
+
+// 스위치 라인을 모두 떼고 놓는다
+static void pinmap_put_switches(void) {
+    static struct led_sw_line *const none[SW_NUM];
+    int i;
+
+    led_gesture_bind(none);
+    for (i = 0; i < SW_NUM; i++) {
+        if (sw_desc[i]) {
+            led_gesture_line_put(sw_line[i]);
+            gpiod_put(sw_desc[i]);
+        }
+        sw_desc[i] = NULL;
+        sw_line[i] = NULL;
+    }
+}
+
+// sw[] 로 첫 스위치 라인을 잡아 붙이고 configfs 를 연다
+int led_pinmap_init(void) {
+    struct gpio_desc *desc;
+    int ret, i;
+
+    for (i = 0; i < SW_NUM; i++) {
+        sw_cur[i].chip[0] = '\0';
+        sw_cur[i].offset = sw[i];
+        if (sw[i] < 0) {
+            continue;
+        }
+        desc = pin_get(&sw_cur[i], "SW", GPIOD_IN);
+        if (IS_ERR(desc)) {
+            ret = PTR_ERR(desc);
+            goto cleanup;
+        }
+        sw_desc[i] = desc;
+        sw_line[i] = led_gesture_line_get(desc);
+        if (IS_ERR(sw_line[i])) {
+            ret = PTR_ERR(sw_line[i]);
+            sw_line[i] = NULL;
+            goto cleanup;
+        }
+    }
+    led_gesture_bind(sw_line);
+
+    config_group_init_type_name(&pin_subsys.su_group, "led_control", &pinmap_type);
+    mutex_init(&pin_subsys.su_mutex);
+    config_group_init_type_name(&banks_group, "banks", &banks_type);
+    configfs_add_default_group(&banks_group, &pin_subsys.su_group);
+    config_group_init_type_name(&leds_group, "leds", &leds_type);
+    configfs_add_default_group(&leds_group, &pin_subsys.su_group);
+    config_group_init_type_name(&switches_group, "switches", &switches_type);
+    configfs_add_default_group(&switches_group, &pin_subsys.su_group);
+
+    ret = configfs_register_subsystem(&pin_subsys);
+    if (ret < 0) {
+        printk(KERN_ERR "Failed to register configfs subsystem\n");
+        goto cleanup;
+    }
+    return 0;
+
+cleanup:
+    pinmap_put_switches();
+    return ret;
+}
+
+void led_pinmap_exit(void) {
+    configfs_unregister_subsystem(&pin_subsys);
+    pinmap_put_switches();
+}
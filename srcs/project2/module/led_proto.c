@@ -0,0 +1,264 @@
+#include <linux/bits.h>
+#include <linux/errno.h>
+#include <linux/limits.h>
+#include <linux/string.h>
+#include <linux/types.h>
+
+#include "led_proto.h"
+
+// userspace 에서도 빌드하므로 ctype / kstrto* 대신 직접 본다
+static bool text_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static bool text_alpha(char c) {
+    return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+static char *text_trim(char *s) {
+    char *end;
+
+    while (text_space(*s)) {
+        s++;
+    }
+    end = s + strlen(s);
+    while (end > s && text_space(end[-1])) {
+        end--;
+    }
+    *end = '\0';
+    return s;
+}
+
+int led_rec_type(const void *data, size_t avail) {
+    u32 magic;
+
+    if (avail < sizeof(struct led_vm_header)) {
+        return LED_REC_TEXT;
+    }
+    memcpy(&magic, data, sizeof(magic));
+    if (magic == LED_VM_MAGIC) {
+        return LED_REC_PROGRAM;
+    }
+    if (magic == LED_REQ_MAGIC) {
+        return LED_REC_REQ;
+    }
+    return LED_REC_TEXT;
+}
+
+ssize_t led_rec_program(const void *data, size_t avail, struct led_vm_header *hdr) {
+    size_t size;
+
+    if (avail < sizeof(*hdr)) {
+        return -EINVAL;
+    }
+    memcpy(hdr, data, sizeof(*hdr));
+    size = sizeof(*hdr) + hdr->count * sizeof(u32);
+    if (hdr->magic != LED_VM_MAGIC || hdr->version != LED_VM_VERSION || hdr->count == 0 ||
+        hdr->count > LED_VM_MAX_INSNS || size > avail) {
+        return -EINVAL;
+    }
+    return size;
+}
+
+ssize_t led_rec_reqs(const void *data, size_t avail, struct led_req_header *hdr) {
+    const struct led_req *reqs = (const void *)((const char *)data + sizeof(*hdr));
+    struct led_req req;
+    size_t size;
+    int ret, i;
+
+    if (avail < sizeof(*hdr)) {
+        return -EINVAL;
+    }
+    memcpy(hdr, data, sizeof(*hdr));
+    size = sizeof(*hdr) + hdr->count * sizeof(struct led_req);
+    if (hdr->magic != LED_REQ_MAGIC || hdr->version != LED_REQ_VERSION || hdr->count == 0 ||
+        hdr->count > LED_REQ_MAX || size > avail) {
+        return -EINVAL;
+    }
+    // 레코드가 정렬돼 있지 않을 수 있어 하나씩 복사해서 본다
+    for (i = 0; i < hdr->count; i++) {
+        memcpy(&req, &reqs[i], sizeof(req));
+        ret = led_req_check(&req);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return size;
+}
+
+// 줄바꿈이 아직 없는 텍스트 줄, 길이가 avail 을 넘는 LEVM/LEDQ 는 뒤가 잘린 것으로 본다
+bool led_rec_complete(const void *data, size_t avail) {
+    struct led_vm_header vm;
+    struct led_req_header req;
+
+    switch (led_rec_type(data, avail)) {
+    case LED_REC_PROGRAM:
+        memcpy(&vm, data, sizeof(vm));
+        return sizeof(vm) + vm.count * sizeof(u32) <= avail;
+    case LED_REC_REQ:
+        memcpy(&req, data, sizeof(req));
+        return sizeof(req) + req.count * sizeof(struct led_req) <= avail;
+    default:
+        return memchr(data, '\n', avail) != NULL;
+    }
+}
+
+ssize_t led_text_line(const char *data, size_t avail, char *buf, size_t size) {
+    const char *nl = memchr(data, '\n', avail);
+    size_t len = nl ? (size_t)(nl - data + 1) : avail;
+
+    if (len >= size) {
+        return -EINVAL;
+    }
+    memcpy(buf, data, len);
+    buf[len] = '\0';
+    return len;
+}
+
+// 모드 번호는 부호 있는 10 진수 (kstrtoint 와 같이 앞의 + 도 받는다)
+static int text_mode(const char *s, int *mode) {
+    bool neg = false;
+    int v = 0, n = 0;
+
+    if (*s == '+' || *s == '-') {
+        neg = *s++ == '-';
+    }
+    for (; *s >= '0' && *s <= '9'; s++, n++) {
+        if (v > LED_MODE_MAX) {
+            return -EINVAL;
+        }
+        v = v * 10 + (*s - '0');
+    }
+    if (n == 0 || *s != '\0') {
+        return -EINVAL;
+    }
+    *mode = neg ? -v : v;
+    return 0;
+}
+
+int led_text_parse(char *line, struct led_text *t) {
+    char *cmd = text_trim(line), *arg;
+
+    memset(t, 0, sizeof(*t));
+    if (cmd[0] == '\0') {
+        t->kind = LED_TEXT_EMPTY;
+        return 0;
+    }
+    if (text_alpha(cmd[0])) {
+        for (arg = cmd; *arg && !text_space(*arg); arg++) {
+        }
+        if (*arg) {
+            *arg++ = '\0';
+        }
+        t->kind = LED_TEXT_CMD;
+        t->cmd = cmd;
+        t->arg = text_trim(arg);
+        return 0;
+    }
+    if (text_mode(cmd, &t->mode) < 0 || t->mode < LED_MODE_BLINK || t->mode > LED_MODE_MAX) {
+        return -EINVAL;
+    }
+    t->kind = LED_TEXT_MODE;
+    return 0;
+}
+
+int led_text_u32(const char *s, u32 *out) {
+    unsigned int base = 10, d;
+    u64 v = 0;
+    int n = 0;
+
+    if (*s == '+') {
+        s++;
+    }
+    if (s[0] == '0' && (s[1] | 0x20) == 'x') {
+        base = 16;
+        s += 2;
+    } else if (s[0] == '0' && s[1]) {
+        base = 8;
+        s++;
+    }
+    for (; *s; s++, n++) {
+        if (*s >= '0' && *s <= '9') {
+            d = *s - '0';
+        } else if ((*s | 0x20) >= 'a' && (*s | 0x20) <= 'f') {
+            d = (*s | 0x20) - 'a' + 10;
+        } else {
+            return -EINVAL;
+        }
+        if (d >= base) {
+            return -EINVAL;
+        }
+        v = v * base + d;
+        if (v > U32_MAX) {
+            return -EINVAL;
+        }
+    }
+    if (n == 0) {
+        return -EINVAL;
+    }
+    *out = v;
+    return 0;
+}
+
+int led_req_check(const struct led_req *req) {
+    if (req->op == 0 || req->op >= LED_REQ_OP_COUNT) {
+        return -EINVAL;
+    }
+    if (req->op == LED_REQ_PRIORITY) {
+        return req->value > U8_MAX ? -EINVAL : 0;
+    }
+    return (req->value & ~LED_MASK_ALL) ? -EINVAL : 0;
+}
+
+void led_req_apply(struct led_owner *o, const struct led_req *req) {
+    switch (req->op) {
+    case LED_REQ_CLAIM:
+        o->claim |= req->value;
+        break;
+    case LED_REQ_RELEASE:
+        o->claim &= ~req->value;
+        break;
+    case LED_REQ_SET:
+        o->value = req->value;
+        break;
+    case LED_REQ_ON:
+        o->value |= req->value;
+        break;
+    case LED_REQ_OFF:
+        o->value &= ~req->value;
+        break;
+    case LED_REQ_TOGGLE:
+        o->value ^= req->value;
+        break;
+    case LED_REQ_PRIORITY:
+        o->priority = req->value;
+        break;
+    }
+}
+
+void led_arb_init(struct led_arb *arb) {
+    memset(arb, 0, sizeof(*arb));
+}
+
+void led_arb_add(struct led_arb *arb, const struct led_owner *o) {
+    int i;
+
+    for (i = 0; i < LED_NUM; i++) {
+        if ((o->claim & BIT(i)) && (!arb->owner[i] || o->priority > arb->owner[i]->priority)) {
+            arb->owner[i] = o;
+        }
+    }
+}
+
+void led_arb_result(const struct led_arb *arb, u32 *claim, u32 *value) {
+    int i;
+
+    *claim = 0;
+    *value = 0;
+    for (i = 0; i < LED_NUM; i++) {
+        if (arb->owner[i]) {
+            *claim |= BIT(i);
+            *value |= arb->owner[i]->value & BIT(i);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef LED_PROTO_H
+#define LED_PROTO_H
+
+// /dev/led_control write 프로토콜: 레코드 구분, 텍스트 줄 해석, 세션 요청 검사와 LED 중재
+// (커널 API 를 쓰지 않는 순수 로직). 모듈과 native 의 ledcuse, ledsim 이 같은 소스를 빌드한다.
+// 잠금, 큐, 출력은 다루지 않는다.
+
+#include <linux/types.h>
+
+#include "led_uapi.h"
+
+// 레코드 종류 (앞 4 바이트의 magic 으로 구분)
+enum led_rec_type {
+    LED_REC_TEXT,
+    LED_REC_PROGRAM,  // LEVM: header + 명령어 배열
+    LED_REC_REQ,      // LEDQ: header + 요청 배열
+};
+
+#define LED_TEXT_MAX 64  // 텍스트 한 줄 (줄바꿈 포함) 은 이보다 짧아야 한다
+
+enum led_text_kind {
+    LED_TEXT_EMPTY,  // 빈 줄
+    LED_TEXT_MODE,   // 모드 번호
+    LED_TEXT_CMD,    // 영문자로 시작하는 명령
+};
+
+struct led_text {
+    int kind;
+    int mode;   // LED_TEXT_MODE
+    char *cmd;  // LED_TEXT_CMD: 첫 단어
+    char *arg;  // LED_TEXT_CMD: 나머지 (앞뒤 공백 없음, 없으면 "")
+};
+
+// 세션 하나가 중재에 내는 값
+struct led_owner {
+    u8 priority;
+    u32 claim;  // 잡은 LED
+    u32 value;  // 잡은 LED 에 낼 값
+};
+
+// LED 마다의 주인 (led_arb_add 를 연 순서대로 불러 모은다)
+struct led_arb {
+    const struct led_owner *owner[LED_NUM];
+};
+
+int led_rec_type(const void *data, size_t avail);
+// header 를 검사해 hdr 에 채운다. 레코드 길이 또는 -EINVAL
+ssize_t led_rec_program(const void *data, size_t avail, struct led_vm_header *hdr);
+// header 와 요청을 모두 검사한다. 레코드 길이 또는 -EINVAL
+ssize_t led_rec_reqs(const void *data, size_t avail, struct led_req_header *hdr);
+// 레코드가 avail 안에서 끝나는지 (LED_WRITE_MAX 에서 자른 write 의 끝에 걸친 레코드를 가린다)
+bool led_rec_complete(const void *data, size_t avail);
+
+// 한 줄을 buf 로 옮긴다. 소비한 길이(줄바꿈 포함) 또는 -EINVAL
+ssize_t led_text_line(const char *data, size_t avail, char *buf, size_t size);
+// 줄 하나를 다듬어 나눈다 (line 을 고쳐 쓴다). 0 또는 -EINVAL
+int led_text_parse(char *line, struct led_text *t);
+// 0x.. / 0.. / 10 진수 u32. 0 또는 -EINVAL
+int led_text_u32(const char *s, u32 *out);
+
+int led_req_check(const struct led_req *req);
+void led_req_apply(struct led_owner *o, const struct led_req *req);
+
+void led_arb_init(struct led_arb *arb);
+// priority 가 더 높을 때만 주인이 바뀐다 (같으면 먼저 넣은 쪽이 이김)
+void led_arb_add(struct led_arb *arb, const struct led_owner *o);
+void led_arb_result(const struct led_arb *arb, u32 *claim, u32 *value);
+
+#endif
@@ -0,0 +1,199 @@
+#include <linux/kernel.h>
+#include <linux/cpumask.h>
+#include <linux/device.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/sched.h>
+#include <linux/sched/types.h>
+#include <linux/string.h>
+
+#include "led_control.h"
+
+// 엔진 스레드 스케줄링 / CPU 고정, 스위치 IRQ affinity
+// /sys/class/led_class/led_control/ 아래 속성으로 바꾼다
+//   engine_sched : "normal <nice>" | "fifo <1-99>" | "rr <1-99>"
+//   engine_cpus  : 엔진 스레드를 돌릴 CPU 목록 (예: 2-3)
+//   irq_cpus     : 스위치 IRQ 를 받을 CPU 목록
+
+// 기본은 다른 커널 스레드와 같은 SCHED_NORMAL nice 0. RT 는 필요한 보드에서만 켠다
+static unsigned int engine_rt_prio;
+module_param(engine_rt_prio, uint, 0444);
+MODULE_PARM_DESC(engine_rt_prio, "start the engine thread as SCHED_FIFO at this priority (1-99, 0 = SCHED_NORMAL)");
+
+static struct task_struct *engine_task;
+static int engine_policy = SCHED_NORMAL;
+static int engine_prio;  // RT 면 우선순위, normal 이면 nice
+static struct cpumask engine_cpus;
+static struct cpumask irq_cpus;
+static DEFINE_MUTEX(sched_lock);
+
+static const char *const policy_names[] = {
+    [SCHED_NORMAL] = "normal",
+    [SCHED_FIFO] = "fifo",
+    [SCHED_RR] = "rr",
+};
+
+// sched_lock 잡은 상태에서 호출
+static int sched_apply(int policy, int prio) {
+    struct sched_attr attr = {
+        .size = sizeof(attr),
+        .sched_policy = policy,
+    };
+
+    if (policy == SCHED_NORMAL) {
+        if (prio < MIN_NICE || prio > MAX_NICE) {
+            return -EINVAL;
+        }
+        attr.sched_nice = prio;
+    } else {
+        if (prio < 1 || prio >= MAX_RT_PRIO) {
+            return -EINVAL;
+        }
+        attr.sched_priority = prio;
+    }
+
+    if (!engine_task) {
+        return -ENODEV;
+    }
+    return sched_setattr_nocheck(engine_task, &attr);
+}
+
+static ssize_t engine_sched_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "%s %d\n", policy_names[engine_policy], engine_prio);
+}
+
+static ssize_t engine_sched_store(struct device *dev, struct device_attribute *attr,
+                                  const char *buf, size_t count) {
+    char name[8];
+    int policy, prio, ret;
+
+    if (sscanf(buf, "%7s %d", name, &prio) != 2) {
+        return -EINVAL;
+    }
+    for (policy = 0; policy < ARRAY_SIZE(policy_names); policy++) {
+        if (policy_names[policy] && strcmp(name, policy_names[policy]) == 0) {
+            break;
+        }
+    }
+    if (policy == ARRAY_SIZE(policy_names)) {
+        return -EINVAL;
+    }
+
+    mutex_lock(&sched_lock);
+    ret = sched_apply(policy, prio);
+    if (ret == 0) {
+        engine_policy = policy;
+        engine_prio = prio;
+    }
+    mutex_unlock(&sched_lock);
+
+    return ret < 0 ? ret : count;
+}
+static DEVICE_ATTR_RW(engine_sched);
+
+static int parse_cpus(const char *buf, struct cpumask *mask) {
+    int ret = cpulist_parse(buf, mask);
+
+    if (ret < 0) {
+        return ret;
+    }
+    if (cpumask_empty(mask) || !cpumask_subset(mask, cpu_online_mask)) {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static ssize_t engine_cpus_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "%*pbl\n", cpumask_pr_args(&engine_cpus));
+}
+
+static ssize_t engine_cpus_store(struct device *dev, struct device_attribute *attr,
+                                 const char *buf, size_t count) {
+    cpumask_var_t mask;
+    int ret;
+
+    if (!alloc_cpumask_var(&mask, GFP_KERNEL)) {
+        return -ENOMEM;
+    }
+    ret = parse_cpus(buf, mask);
+    if (ret < 0) {
+        goto out;
+    }
+
+    mutex_lock(&sched_lock);
+    ret = engine_task ? set_cpus_allowed_ptr(engine_task, mask) : -ENODEV;
+    if (ret == 0) {
+        cpumask_copy(&engine_cpus, mask);
+    }
+    mutex_unlock(&sched_lock);
+out:
+    free_cpumask_var(mask);
+    return ret < 0 ? ret : count;
+}
+static DEVICE_ATTR_RW(engine_cpus);
+
+static ssize_t irq_cpus_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "%*pbl\n", cpumask_pr_args(&irq_cpus));
+}
+
+static ssize_t irq_cpus_store(struct device *dev, struct device_attribute *attr,
+                              const char *buf, size_t count) {
+    cpumask_var_t mask;
+    int ret;
+
+    if (!alloc_cpumask_var(&mask, GFP_KERNEL)) {
+        return -ENOMEM;
+    }
+    ret = parse_cpus(buf, mask);
+    if (ret < 0) {
+        goto out;
+    }
+
+    mutex_lock(&sched_lock);
+    ret = led_gesture_set_affinity(mask);
+    if (ret == 0) {
+        cpumask_copy(&irq_cpus, mask);
+    }
+    mutex_unlock(&sched_lock);
+out:
+    free_cpumask_var(mask);
+    return ret < 0 ? ret : count;
+}
+static DEVICE_ATTR_RW(irq_cpus);
+
+static struct attribute *led_sched_attrs[] = {
+    &dev_attr_engine_sched.attr,
+    &dev_attr_engine_cpus.attr,
+    &dev_attr_irq_cpus.attr,
+    NULL,
+};
+
+const struct attribute_group led_sched_group = {
+    .attrs = led_sched_attrs,
+};
+
+// 엔진 스레드를 깨우기 전에 호출. 기본값은 SCHED_NORMAL nice 0 (engine_rt_prio 를 주면 SCHED_FIFO), 모든 CPU.
+void led_sched_init(struct task_struct *task) {
+    mutex_lock(&sched_lock);
+    engine_task = task;
+    cpumask_copy(&engine_cpus, cpu_possible_mask);
+    cpumask_copy(&irq_cpus, cpu_possible_mask);
+
+    if (engine_rt_prio) {
+        engine_policy = SCHED_FIFO;
+        engine_prio = engine_rt_prio;
+    }
+    if (sched_apply(engine_policy, engine_prio) < 0) {
+        printk(KERN_WARNING "Failed to set LED engine scheduling, using default\n");
+        engine_policy = SCHED_NORMAL;
+        engine_prio = 0;
+    }
+    mutex_unlock(&sched_lock);
+}
+
+// 엔진 스레드를 멈추기 전에 호출
+void led_sched_exit(void) {
+    mutex_lock(&sched_lock);
+    engine_task = NULL;
+    mutex_unlock(&sched_lock);
+}
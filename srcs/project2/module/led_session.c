@@ -0,0 +1,215 @@
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/list.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/wait.h>
+
+#include "led_control.h"
+
+// open 한 파일마다의 세션과 LED 중재
+// 쓰는 쪽은 요청을 자기 큐에 넣기만 하고, 엔진 스레드가 led_session_drain() 에서
+// 모든 큐를 비운 뒤 LED 마다 주인을 정해 overlay 를 한 번 계산한다.
+// 잠금 순서: led_lock -> session_lock
+
+struct led_session {
+    struct list_head node;   // 연 순서대로 (같은 priority 면 앞이 이김)
+    u16 id;                  // 입력 기록(LED_EV_INPUT_*)에 쓰는 번호
+    struct led_owner own;    // priority 와 잡은 LED, 그 값 (중재 규칙은 led_proto.c)
+    struct led_req queue[LED_REQ_MAX];
+    u32 q_head, q_tail;
+    wait_queue_head_t space_wait;
+    struct fasync_struct *fasync;
+    bool sig_pending;        // SIGIO 를 보냈고 아직 read 하지 않음
+};
+
+static LIST_HEAD(sessions);
+static DEFINE_SPINLOCK(session_lock);
+static bool session_pending;
+static u16 session_next_id;
+// 중재 결과 (drain 에서만 바꾸고, led_lock 잡은 쪽에서만 읽음)
+static u32 overlay_claim;
+static u32 overlay_value;
+
+struct led_session *led_session_open(void) {
+    struct led_session *sess;
+    unsigned long flags;
+
+    sess = kzalloc(sizeof(*sess), GFP_KERNEL);
+    if (!sess) {
+        return NULL;
+    }
+    init_waitqueue_head(&sess->space_wait);
+
+    spin_lock_irqsave(&session_lock, flags);
+    sess->id = session_next_id++;
+    list_add_tail(&sess->node, &sessions);
+    spin_unlock_irqrestore(&session_lock, flags);
+
+    led_trace_input(LED_EV_INPUT_SESSION, sess->id, 1);
+    return sess;
+}
+
+void led_session_close(struct led_session *sess) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&session_lock, flags);
+    list_del(&sess->node);
+    // 잡고 있던 LED 를 다음 drain 에서 돌려준다
+    if (sess->own.claim) {
+        session_pending = true;
+    }
+    spin_unlock_irqrestore(&session_lock, flags);
+
+    if (sess->own.claim) {
+        led_engine_kick();
+    }
+    led_trace_input(LED_EV_INPUT_SESSION, sess->id, 0);
+    kfree(sess);
+}
+
+static u32 session_space(struct led_session *sess) {
+    return LED_REQ_MAX - (READ_ONCE(sess->q_head) - READ_ONCE(sess->q_tail));
+}
+
+// header + 요청 배열 (커널 버퍼). 소비한 길이를 반환.
+// 큐에 자리가 모자라면 기다리거나, nonblock 이면 -EAGAIN
+ssize_t led_session_write(struct led_session *sess, const void *data, size_t avail, bool nonblock) {
+    const struct led_req *reqs = data + sizeof(struct led_req_header);
+    struct led_req_header hdr;
+    struct led_req req;
+    unsigned long flags;
+    ssize_t size;
+    int ret, i;
+
+    size = led_rec_reqs(data, avail, &hdr);
+    if (size < 0) {
+        return size;
+    }
+
+    // 같은 fd 로 여럿이 동시에 쓸 수 있으므로 (스레드, io_uring) 자리는 잠근 채로 다시 보고
+    // 그대로 채운다. 한 레코드의 요청은 큐에 이어서 들어간다
+    for (;;) {
+        spin_lock_irqsave(&session_lock, flags);
+        if (session_space(sess) >= hdr.count) {
+            break;
+        }
+        spin_unlock_irqrestore(&session_lock, flags);
+        if (nonblock) {
+            return -EAGAIN;
+        }
+        ret = wait_event_interruptible(sess->space_wait, session_space(sess) >= hdr.count);
+        if (ret) {
+            return ret;
+        }
+    }
+    for (i = 0; i < hdr.count; i++) {
+        memcpy(&sess->queue[sess->q_head % LED_REQ_MAX], &reqs[i], sizeof(struct led_req));
+        sess->q_head++;
+    }
+    session_pending = true;
+    spin_unlock_irqrestore(&session_lock, flags);
+
+    led_engine_kick();
+    for (i = 0; i < hdr.count; i++) {
+        memcpy(&req, &reqs[i], sizeof(req));
+        led_trace_input(LED_EV_INPUT_REQ, sess->id, (u32)req.op << 16 | req.value);
+    }
+    return size;
+}
+
+int led_session_fasync(int fd, struct file *file, int on) {
+    struct led_session *sess = file->private_data;
+
+    return fasync_helper(fd, file, on, &sess->fasync);
+}
+
+// 스위치/모드 이벤트를 SIGIO 로 알린다. 이미 보낸 신호를 아직 read 로 확인하지 않은
+// 세션에는 다시 보내지 않아, 이벤트가 몰려도 확인할 때까지 신호는 하나뿐이다.
+// 어느 context 에서든 호출 가능
+void led_session_signal(void) {
+    struct led_session *sess;
+    unsigned long flags;
+
+    spin_lock_irqsave(&session_lock, flags);
+    list_for_each_entry(sess, &sessions, node) {
+        if (sess->fasync && !sess->sig_pending) {
+            sess->sig_pending = true;
+            kill_fasync(&sess->fasync, SIGIO, POLL_IN);
+        }
+    }
+    spin_unlock_irqrestore(&session_lock, flags);
+}
+
+// read 로 상태를 확인했으니 다음 이벤트에 다시 신호를 보낸다
+void led_session_consumed(struct led_session *sess) {
+    WRITE_ONCE(sess->sig_pending, false);
+}
+
+bool led_session_pending(void) {
+    return READ_ONCE(session_pending);
+}
+
+// LED 마다 주인을 다시 정한다. overlay 가 바뀌면 true
+// (led_lock, session_lock 잡은 상태에서 호출)
+static bool session_arbitrate(void) {
+    struct led_session *sess;
+    struct led_arb arb;
+    u32 claim, value;
+    bool changed;
+
+    led_arb_init(&arb);
+    list_for_each_entry(sess, &sessions, node) {
+        led_arb_add(&arb, &sess->own);
+    }
+    led_arb_result(&arb, &claim, &value);
+
+    changed = claim != overlay_claim || value != overlay_value;
+    overlay_claim = claim;
+    overlay_value = value;
+    return changed;
+}
+
+// 모든 세션 큐를 비우고 중재를 다시 한다. overlay 가 바뀌면 true
+// (엔진 스레드, led_lock 잡은 상태에서 호출)
+bool led_session_drain(void) {
+    struct led_session *sess;
+    bool changed;
+
+    spin_lock(&session_lock);
+    session_pending = false;
+    list_for_each_entry(sess, &sessions, node) {
+        if (sess->q_tail != sess->q_head) {
+            while (sess->q_tail != sess->q_head) {
+                led_req_apply(&sess->own, &sess->queue[sess->q_tail % LED_REQ_MAX]);
+                sess->q_tail++;
+            }
+            wake_up_interruptible(&sess->space_wait);
+        }
+    }
+    changed = session_arbitrate();
+    spin_unlock(&session_lock);
+
+    return changed;
+}
+
+// mmap 창에서 읽은 값을 세션에 반영. overlay 가 바뀌면 true
+// (엔진 스레드, led_lock 잡은 상태에서 호출)
+bool led_session_update(struct led_session *sess, u32 set, u32 clr, u32 claim) {
+    bool changed;
+
+    spin_lock(&session_lock);
+    sess->own.value = (sess->own.value | set) & ~clr;
+    sess->own.claim = claim;
+    changed = session_arbitrate();
+    spin_unlock(&session_lock);
+
+    return changed;
+}
+
+// 모드 출력 위에 세션 overlay 를 얹는다 (led_lock 잡은 상태에서 호출)
+u32 led_session_compose(u32 base) {
+    return (base & ~overlay_claim) | overlay_value;
+}
@@ -0,0 +1,217 @@
+#include <linux/kernel.h>
+#include <linux/kobject.h>
+#include <linux/math64.h>
+#include <linux/string.h>
+#include <linux/sysfs.h>
+
+#include "led_control.h"
+
+// /sys/kernel/led_control
+//   mode       : 현재 모드, 쓰면 모드 전환 (1-6, dev_write 와 같은 번호)
+//   led_mask   : 켜진 LED 비트마스크, 쓰면 수동 모드로 바꾸고 그대로 켠다
+//   period_ns  : 전체/순차 모드 주기
+//   brightness : 0-100 (%), 100 미만이면 엔진 스레드가 소프트웨어 PWM
+//   stats      : 엔진/위상 고정/처리 시간 통계, LED 별 켜진 시간/전환 횟수/duty ("이름 값" 한 줄씩)
+//                duty_permille 는 지난 usage_window_ms 창, avg_permille 는 올린 뒤 전체
+//   clock_ns   : 엔진 시계 (ns). virtual_clock=1 이면 쓴 시각까지 가상 시계를 돌린다
+//                ("+N" 은 지금부터 N ns 뒤). 그 사이의 tick 을 모두 처리한 뒤에 돌아온다
+// stats 를 뺀 속성은 값이 바뀌면 sysfs_notify 하므로 poll(POLLPRI) 로 기다릴 수 있다.
+
+static struct kobject *led_kobj;
+// 원자 context 에서도 알릴 수 있도록 kernfs node 를 미리 잡아 둔다
+static struct kernfs_node *notify_kn[LED_ATTR_COUNT];
+
+static const char *const notify_names[LED_ATTR_COUNT] = {
+    [LED_ATTR_MODE] = "mode",
+    [LED_ATTR_LED_MASK] = "led_mask",
+    [LED_ATTR_PERIOD] = "period_ns",
+    [LED_ATTR_BRIGHTNESS] = "brightness",
+};
+
+// 어느 context 에서든 호출 가능 (led_lock 잡은 상태 포함)
+void led_sysfs_notify(enum led_sysfs_attr attr) {
+    struct kernfs_node *kn = READ_ONCE(notify_kn[attr]);
+
+    if (kn) {
+        sysfs_notify_dirent(kn);
+    }
+}
+
+static ssize_t mode_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "%d\n", led_mode_get());
+}
+
+static ssize_t mode_store(struct kobject *kobj, struct kobj_attribute *attr, const char *buf, size_t count) {
+    int new_mode, ret;
+
+    ret = kstrtoint(buf, 10, &new_mode);
+    if (ret < 0) {
+        return ret;
+    }
+    if (new_mode < LED_MODE_BLINK || new_mode > LED_MODE_MAX) {
+        return -EINVAL;
+    }
+    ret = led_mode_set(new_mode);
+    return ret < 0 ? ret : count;
+}
+
+static ssize_t led_mask_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "0x%x\n", led_mask_get());
+}
+
+static ssize_t led_mask_store(struct kobject *kobj, struct kobj_attribute *attr, const char *buf, size_t count) {
+    u32 mask;
+    int ret;
+
+    ret = kstrtou32(buf, 0, &mask);
+    if (ret < 0) {
+        return ret;
+    }
+    if (mask & ~LED_MASK_ALL) {
+        return -EINVAL;
+    }
+    led_mask_set(mask);
+    return count;
+}
+
+static ssize_t period_ns_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "%llu\n", led_period_get());
+}
+
+static ssize_t period_ns_store(struct kobject *kobj, struct kobj_attribute *attr, const char *buf, size_t count) {
+    u64 ns;
+    int ret;
+
+    ret = kstrtou64(buf, 10, &ns);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = led_period_set(ns);
+    return ret < 0 ? ret : count;
+}
+
+static ssize_t brightness_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "%u\n", led_brightness_get());
+}
+
+static ssize_t brightness_store(struct kobject *kobj, struct kobj_attribute *attr, const char *buf, size_t count) {
+    unsigned int pct;
+    int ret;
+
+    ret = kstrtouint(buf, 10, &pct);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = led_brightness_set(pct);
+    return ret < 0 ? ret : count;
+}
+
+static ssize_t stats_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf) {
+    struct led_stats st;
+    int len = 0, i;
+
+    led_stats_get(&st);
+    len += sysfs_emit_at(buf, len, "ticks %llu\n", st.ticks);
+    len += sysfs_emit_at(buf, len, "last_late_ns %llu\n", st.last_late_ns);
+    len += sysfs_emit_at(buf, len, "max_late_ns %llu\n", st.max_late_ns);
+    len += sysfs_emit_at(buf, len, "sync %d\n", st.sync_enabled);
+    len += sysfs_emit_at(buf, len, "sync_samples %llu\n", st.sync_samples);
+    len += sysfs_emit_at(buf, len, "sync_last_error_ns %lld\n", st.sync_last_error_ns);
+    len += sysfs_emit_at(buf, len, "sync_max_error_ns %lld\n", st.sync_max_error_ns);
+    len += sysfs_emit_at(buf, len, "sync_avg_error_ns %llu\n",
+                         st.sync_samples ? div64_u64(st.sync_abs_error_sum_ns, st.sync_samples) : 0);
+    len += sysfs_emit_at(buf, len, "tick_last_cost_ns %llu\n", st.tick_last_cost_ns);
+    len += sysfs_emit_at(buf, len, "tick_max_cost_ns %llu\n", st.tick_max_cost_ns);
+    len += sysfs_emit_at(buf, len, "tick_avg_cost_ns %llu\n",
+                         st.ticks ? div64_u64(st.tick_cost_sum_ns, st.ticks) : 0);
+    len += sysfs_emit_at(buf, len, "writes %llu\n", st.writes);
+    len += sysfs_emit_at(buf, len, "write_max_cost_ns %llu\n", st.write_max_cost_ns);
+    len += sysfs_emit_at(buf, len, "write_avg_cost_ns %llu\n",
+                         st.writes ? div64_u64(st.write_cost_sum_ns, st.writes) : 0);
+    len += sysfs_emit_at(buf, len, "usage_ns %llu\n", st.usage_ns);
+    len += sysfs_emit_at(buf, len, "usage_window_ns %llu\n", st.usage_window_ns);
+    for (i = 0; i < LED_NUM; i++) {
+        len += sysfs_emit_at(buf, len, "led%d_on_ns %llu\n", i, st.led_on_ns[i]);
+        len += sysfs_emit_at(buf, len, "led%d_toggles %llu\n", i, st.led_toggles[i]);
+        len += sysfs_emit_at(buf, len, "led%d_duty_permille %u\n", i, st.led_duty[i]);
+        len += sysfs_emit_at(buf, len, "led%d_avg_permille %llu\n", i,
+                             st.usage_ns ? mul_u64_u64_div_u64(st.led_on_ns[i], 1000, st.usage_ns) : 0);
+    }
+    return len;
+}
+
+static ssize_t clock_ns_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "%llu\n", led_clock_ns());
+}
+
+static ssize_t clock_ns_store(struct kobject *kobj, struct kobj_attribute *attr, const char *buf, size_t count) {
+    bool rel = buf[0] == '+';
+    u64 ns;
+    int ret;
+
+    ret = kstrtou64(buf + rel, 10, &ns);
+    if (ret < 0) {
+        return ret;
+    }
+    if (rel) {
+        ns += led_clock_ns();
+    }
+    ret = led_clock_advance(ns);
+    return ret < 0 ? ret : count;
+}
+
+static struct kobj_attribute mode_attr = __ATTR_RW(mode);
+static struct kobj_attribute led_mask_attr = __ATTR_RW(led_mask);
+static struct kobj_attribute period_ns_attr = __ATTR_RW(period_ns);
+static struct kobj_attribute brightness_attr = __ATTR_RW(brightness);
+static struct kobj_attribute stats_attr = __ATTR_RO(stats);
+static struct kobj_attribute clock_ns_attr = __ATTR_RW(clock_ns);
+
+static struct attribute *led_attrs[] = {
+    &mode_attr.attr,
+    &led_mask_attr.attr,
+    &period_ns_attr.attr,
+    &brightness_attr.attr,
+    &stats_attr.attr,
+    &clock_ns_attr.attr,
+    NULL,
+};
+
+static const struct attribute_group led_attr_group = {
+    .attrs = led_attrs,
+};
+
+int led_sysfs_init(void) {
+    int ret, i;
+
+    led_kobj = kobject_create_and_add("led_control", kernel_kobj);
+    if (!led_kobj) {
+        return -ENOMEM;
+    }
+
+    ret = sysfs_create_group(led_kobj, &led_attr_group);
+    if (ret < 0) {
+        printk(KERN_ERR "Failed to create sysfs attributes\n");
+        kobject_put(led_kobj);
+        return ret;
+    }
+
+    for (i = 0; i < LED_ATTR_COUNT; i++) {
+        WRITE_ONCE(notify_kn[i], sysfs_get_dirent(led_kobj->sd, notify_names[i]));
+    }
+    return 0;
+}
+
+void led_sysfs_exit(void) {
+    struct kernfs_node *kn;
+    int i;
+
+    for (i = 0; i < LED_ATTR_COUNT; i++) {
+        kn = xchg(&notify_kn[i], NULL);
+        if (kn) {
+            sysfs_put(kn);
+        }
+    }
+    sysfs_remove_group(led_kobj, &led_attr_group);
+    kobject_put(led_kobj);
+}
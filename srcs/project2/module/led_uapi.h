@@ -0,0 +1,230 @@
+#ifndef LED_UAPI_H
+#define LED_UAPI_H
+
+// 커널 모듈과 native 클라이언트가 같이 쓰는 정의
+
+#include <linux/types.h>
+
+#define LED_DEVICE_PATH "/dev/led_control"
+#define LED_EVENTS_PATH "/dev/led_events"
+
+// /dev/led_control 한 번의 write(writev, io_uring 포함) 로 처리하는 최대 바이트.
+// 그 안에 레코드(모드/텍스트 명령 한 줄, LEVM 프로그램, LEDQ 요청 묶음)를 여러 개 이어 붙일 수 있다.
+// 더 길면 이 안에서 끝나는 레코드까지만 처리하고 짧은 길이를 돌려준다.
+#define LED_WRITE_MAX 16384
+
+#define LED_NUM 4
+#define SW_NUM  4
+#define LED_MASK_ALL ((1u << LED_NUM) - 1)
+#define SW_MASK_ALL  ((1u << SW_NUM) - 1)
+
+// 모드 번호 (dev_write 에 쓰는 값)
+#define LED_MODE_BLINK  1   // 전체 LED 동시 깜박임
+#define LED_MODE_SEQ    2   // 순차 점등
+#define LED_MODE_MANUAL 3   // 수동 토글
+#define LED_MODE_RESET  4   // 전체 OFF
+#define LED_MODE_PROGRAM 5  // 올려 둔 바이트코드 프로그램 실행
+#define LED_MODE_PATTERN 6  // 패턴 라이브러리에서 고른 패턴 재생
+#define LED_MODE_MAX    LED_MODE_PATTERN
+
+// /dev/led_events 에서 읽히는 이벤트 (16 byte 고정 크기)
+struct led_event {
+    __u64 timestamp_ns; // CLOCK_MONOTONIC
+    __u16 type;         // LED_EV_*
+    __u16 code;         // type 별 부가 정보
+    __u32 value;
+};
+
+#define LED_EV_GESTURE 1   // code: LED_GESTURE_*, value: 스위치 비트마스크
+#define LED_EV_MODE    2   // value: 새 모드
+#define LED_EV_OVERRUN 3   // value: 놓친 이벤트 수
+#define LED_EV_PROGRAM 4   // code: LED_PROG_*, value: 멈춘 pc
+#define LED_EV_PATTERN 5   // code: LED_PAT_EV_*
+#define LED_EV_SYNC    6   // value: 주기 경계에서 측정한 위상 오차 (ns, s32)
+#define LED_EV_SWITCH  7   // value: 디바운스 후 눌려 있는 스위치 마스크
+#define LED_EV_LAYER   8   // code: 레이어 번호, value: 1 켜짐 / 0 꺼짐(패턴 끝 포함)
+// 입력 기록 (모듈 인자 trace_inputs=1 일 때만): ledrec 이 스위치 이벤트와 함께 trace 로 남긴다
+#define LED_EV_INPUT_MODE    9   // 명령(dev_write, sysfs, netlink)으로 바꾼 모드. value: 모드
+#define LED_EV_INPUT_SESSION 10  // code: 세션 번호, value: 1 open / 0 close
+#define LED_EV_INPUT_REQ     11  // code: 세션 번호, value: op << 16 | 요청 값
+#define LED_EV_INPUT_MASK    12  // sysfs led_mask 로 직접 지정한 LED. value: 마스크
+
+#define LED_GESTURE_PRESS  1   // 짧게 한 번
+#define LED_GESTURE_LONG   2   // 길게 누름
+#define LED_GESTURE_DOUBLE 3   // 두 번 연속
+#define LED_GESTURE_CHORD  4   // 여러 스위치 동시 (value 에 전체 마스크)
+
+#define LED_PROG_HALTED 0  // END 또는 프로그램 끝에 도달
+#define LED_PROG_FAULT  1  // 실행 예산 초과로 강제 정지
+
+#define LED_PAT_EV_LOADED   0  // value: 패턴 수
+#define LED_PAT_EV_FAILED   1  // value: -errno
+#define LED_PAT_EV_FINISHED 2  // value: 끝난 패턴 번호
+
+// 바이트코드 프로그램
+// dev_write 에 header + 명령어 배열을 그대로 쓰면 검증 후 올라가고,
+// 모드 5 를 쓰면 실행된다. 명령어는 32bit: op(8) | a(8) | imm(16)
+#define LED_VM_MAGIC     0x4d56454cu  // "LEVM" (little endian)
+#define LED_VM_VERSION   1
+#define LED_VM_MAX_INSNS 64
+#define LED_VM_REGS      4
+
+struct led_vm_header {
+    __u32 magic;
+    __u16 version;
+    __u16 count;     // 뒤따르는 명령어 수
+};
+
+#define LED_VM_INSN(op, a, imm) \
+    (((__u32)(op) << 24) | ((__u32)((a) & 0xff) << 16) | ((__u32)(imm) & 0xffff))
+
+enum led_vm_op {
+    LED_OP_END = 0,  // 정지
+    LED_OP_SET,      // mask = imm
+    LED_OP_OR,       // mask |= imm
+    LED_OP_AND,      // mask &= imm
+    LED_OP_XOR,      // mask ^= imm
+    LED_OP_WAIT,     // imm ms 대기 (출력은 대기 시점에 반영)
+    LED_OP_WAITSW,   // 스위치 a(마스크) 중 하나가 눌리거나 imm ms 지날 때까지 대기
+    LED_OP_JMP,      // pc = imm
+    LED_OP_JSW,      // 스위치 a(마스크) 중 하나라도 눌려 있으면 pc = imm
+    LED_OP_JNSW,     // 스위치 a(마스크) 가 모두 떼어져 있으면 pc = imm
+    LED_OP_LOAD,     // reg[a] = imm
+    LED_OP_DJNZ,     // reg[a]--, 0 이 아니면 pc = imm
+    LED_OP_SETR,     // mask = reg[a]
+    LED_OP_ADD,      // reg[a] += imm
+    LED_OP_COUNT,
+};
+
+// 합성 레이어: 모드 출력 위에 번호 순서대로 얹고, 세션 overlay 가 맨 위
+//   layer <n> <or|and|override|priority> <mask> pattern <번호|이름>
+//   layer <n> <or|and|override|priority> <mask> value <bits>
+//   layer <n> off
+// 각 레이어는 mask 안의 LED 에만 영향을 준다.
+#define LED_LAYER_MAX 8
+
+enum led_blend {
+    LED_BLEND_OR,        // 켜진 LED 만 더한다
+    LED_BLEND_AND,       // 꺼진 LED 는 끈다
+    LED_BLEND_OVERRIDE,  // mask 안은 레이어 값으로 덮는다
+    LED_BLEND_PRIORITY,  // 레이어 값이 0 이 아닐 때만 OVERRIDE (알림용)
+    LED_BLEND_COUNT,
+};
+
+// 세션 요청
+// /dev/led_control 을 open 할 때마다 세션이 하나 생기고, header + 요청 배열을 쓰면
+// 그 세션의 큐에 들어간다. 엔진 스레드가 모든 세션의 큐를 한 번에 비우고 출력은 한 번만 바꾼다.
+// 세션이 잡은(CLAIM) LED 는 모드 출력 대신 세션 값이 나가며, 여러 세션이 같은 LED 를 잡으면
+// priority 가 높은 세션이, 같으면 먼저 연 세션이 이긴다. close 하면 잡은 LED 는 풀린다.
+#define LED_REQ_MAGIC   0x5144454cu  // "LEDQ"
+#define LED_REQ_VERSION 1
+#define LED_REQ_MAX     256  // 세션 큐 크기 = 한 번에 쓸 수 있는 요청 수
+
+struct led_req_header {
+    __u32 magic;
+    __u16 version;
+    __u16 count;
+};
+
+struct led_req {
+    __u8  op;        // LED_REQ_*
+    __u8  reserved[3];
+    __u32 value;     // LED 마스크, PRIORITY 는 0-255
+};
+
+enum led_req_op {
+    LED_REQ_CLAIM = 1,  // value 의 LED 를 잡는다
+    LED_REQ_RELEASE,    // 놓는다
+    LED_REQ_SET,        // 세션 값 = value
+    LED_REQ_ON,         // 세션 값 |= value
+    LED_REQ_OFF,        // 세션 값 &= ~value
+    LED_REQ_TOGGLE,     // 세션 값 ^= value
+    LED_REQ_PRIORITY,   // 세션 priority = value
+    LED_REQ_OP_COUNT,
+};
+
+// mmap 창: /dev/led_control 을 한 페이지 mmap 하면 그 세션(한 번에 하나)에게만 주어진다.
+// 엔진 스레드가 mmio_poll_us 마다 창을 읽어 세션 요청처럼 반영하므로 syscall 없이
+// 메모리 쓰기만으로 LED 를 바꿀 수 있다. 한 주기 안에서 set 과 clr 이 모두 오면 clr 이 이긴다.
+struct led_mmio {
+    __u32 set;    // 켤 LED 를 atomic OR, 드라이버가 읽으면서 0 으로
+    __u32 clr;    // 끌 LED 를 atomic OR, 드라이버가 읽으면서 0 으로
+    __u32 claim;  // 잡을 LED (LED_REQ_CLAIM 과 같은 중재를 받는다)
+    __u32 out;    // 드라이버가 마지막으로 내보낸 합성 출력 (읽기 전용)
+    __u32 seq;    // out 을 갱신할 때마다 증가 (읽기 전용)
+    __u32 polls;  // 드라이버가 창을 읽은 횟수 (읽기 전용)
+};
+
+// 패턴 라이브러리 파일 (request_firmware 로 읽음, 모두 little endian)
+//   file header
+//   { pattern header, run[runs] } x count
+//   crc32 (앞부분 전체, zlib 과 같은 crc32)
+// run 은 frame_ms 간격 프레임 count 개 동안 mask 를 유지한다는 뜻
+#define LED_PAT_MAGIC      0x5044454cu  // "LEDP"
+#define LED_PAT_VERSION    1
+#define LED_PAT_NAME_LEN   16
+#define LED_PAT_MAX        16    // 파일 하나에 담을 수 있는 패턴 수
+#define LED_PAT_MAX_FRAMES 1024  // 패턴 하나의 디코딩 후 프레임 수
+
+struct led_pat_file_header {
+    __u32 magic;
+    __u16 version;
+    __u16 count;
+};
+
+struct led_pat_header {
+    char  name[LED_PAT_NAME_LEN];
+    __u16 frame_ms;
+    __u16 runs;
+    __u8  flags;   // LED_PAT_LOOP
+    __u8  reserved[3];
+};
+
+#define LED_PAT_LOOP 0x01
+
+struct led_pat_run {
+    __u8 count;
+    __u8 mask;
+};
+
+// generic netlink: LED_GENL_NAME family, LED_GENL_MCGRP 그룹에 가입하면
+// 이벤트와 통계 변화가 모든 구독자에게 한 번에 방송된다
+#define LED_GENL_NAME    "led_control"
+#define LED_GENL_VERSION 1
+#define LED_GENL_MCGRP   "events"
+
+enum led_genl_cmd {
+    LED_CMD_UNSPEC,
+    LED_CMD_GET,     // 응답: MODE, MASK, PERIOD_NS, BRIGHTNESS
+    LED_CMD_SET,     // 들어 있는 속성만 바꾼다 (sysfs 와 같은 규칙)
+    LED_CMD_EXEC,    // COMMAND 문자열 실행 (dev_write 텍스트 명령과 같은 문법)
+    LED_CMD_EVENTS,  // 방송: EVENT 속성 여러 개
+    LED_CMD_STATS,   // 방송: STATS
+    __LED_CMD_MAX,
+};
+
+enum led_genl_attr {
+    LED_A_UNSPEC,
+    LED_A_MODE,        // u32
+    LED_A_MASK,        // u32
+    LED_A_PERIOD_NS,   // u64
+    LED_A_BRIGHTNESS,  // u32, 0-100
+    LED_A_COMMAND,     // 문자열
+    LED_A_EVENT,       // struct led_event
+    LED_A_STATS,       // struct led_stats_delta
+    LED_A_PAD,
+    __LED_A_MAX,
+};
+#define LED_A_MAX (__LED_A_MAX - 1)
+
+// 직전 방송 이후의 변화량
+struct led_stats_delta {
+    __u64 interval_ns;
+    __u64 ticks;              // 엔진 tick 수
+    __u64 events;             // 이벤트 링에 기록된 수
+    __u64 sync_samples;
+    __u64 max_late_ns;        // 구간 안에서 가장 늦게 깨어난 tick (지금까지의 최댓값)
+    __s64 sync_last_error_ns;
+};
+
+#endif
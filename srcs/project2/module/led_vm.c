@@ -0,0 +1,178 @@
+#include <linux/bits.h>
+#include <linux/errno.h>
+#include <linux/string.h>
+
+#include "led_vm.h"
+
+#define WAIT_MAX_MS  60000
+
+#define INSN_OP(insn)  ((insn) >> 24)
+#define INSN_A(insn)   (((insn) >> 16) & 0xff)
+#define INSN_IMM(insn) ((insn) & 0xffff)
+
+// target..pc 구간에 대기 명령이 있는지
+static bool range_has_wait(const u32 *insns, unsigned int target, unsigned int pc) {
+    unsigned int i;
+
+    for (i = target; i <= pc; i++) {
+        if (INSN_OP(insns[i]) == LED_OP_WAIT || INSN_OP(insns[i]) == LED_OP_WAITSW) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 올리기 전 정적 검증
+//  - 알 수 없는 op, 범위를 벗어난 마스크/레지스터/점프 대상 거부
+//  - DJNZ 가 아닌 뒤로 가는 점프는 루프 안에 대기 명령이 있어야 함
+// 이것만으로 무한 루프를 전부 막을 수는 없으므로 실행 시 명령어 예산을 함께 쓴다.
+int led_vm_verify(const u32 *insns, unsigned int count) {
+    unsigned int pc;
+
+    if (count == 0 || count > LED_VM_MAX_INSNS) {
+        return -E2BIG;
+    }
+
+    for (pc = 0; pc < count; pc++) {
+        u32 op = INSN_OP(insns[pc]);
+        u32 a = INSN_A(insns[pc]);
+        u32 imm = INSN_IMM(insns[pc]);
+
+        switch (op) {
+        case LED_OP_END:
+            break;
+        case LED_OP_SET:
+        case LED_OP_OR:
+        case LED_OP_AND:
+        case LED_OP_XOR:
+            if (imm & ~LED_MASK_ALL) {
+                return -EINVAL;
+            }
+            break;
+        case LED_OP_WAIT:
+            if (imm == 0 || imm > WAIT_MAX_MS) {
+                return -EINVAL;
+            }
+            break;
+        case LED_OP_WAITSW:
+            if (a == 0 || (a & ~SW_MASK_ALL) || imm == 0 || imm > WAIT_MAX_MS) {
+                return -EINVAL;
+            }
+            break;
+        case LED_OP_JMP:
+        case LED_OP_JSW:
+        case LED_OP_JNSW:
+            if (imm >= count) {
+                return -EINVAL;
+            }
+            if (op != LED_OP_JMP && (a == 0 || (a & ~SW_MASK_ALL))) {
+                return -EINVAL;
+            }
+            if (imm <= pc && !range_has_wait(insns, imm, pc)) {
+                return -ELOOP;
+            }
+            break;
+        case LED_OP_DJNZ:
+            if (imm >= count) {
+                return -EINVAL;
+            }
+            fallthrough;
+        case LED_OP_LOAD:
+        case LED_OP_SETR:
+        case LED_OP_ADD:
+            if (a >= LED_VM_REGS) {
+                return -EINVAL;
+            }
+            break;
+        default:
+            return -EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+void led_vm_load(struct led_vm *vm, const u32 *insns, unsigned int count) {
+    memcpy(vm->prog, insns, count * sizeof(u32));
+    vm->len = count;
+    led_vm_reset(vm);
+}
+
+void led_vm_reset(struct led_vm *vm) {
+    vm->pc = 0;
+    vm->wait_sw = 0;
+    vm->mask = 0;
+    memset(vm->reg, 0, sizeof(vm->reg));
+}
+
+// 대기 명령을 만날 때까지 실행
+// 반환값: 다음 실행까지 기다릴 ms, 또는 LED_VM_HALT / LED_VM_FAULT
+int led_vm_run(struct led_vm *vm, u32 switches, unsigned int budget) {
+    vm->wait_sw = 0;
+
+    while (budget--) {
+        u32 insn, a, imm;
+
+        if (vm->pc >= vm->len) {
+            return LED_VM_HALT;
+        }
+        insn = vm->prog[vm->pc++];
+        a = INSN_A(insn);
+        imm = INSN_IMM(insn);
+
+        switch (INSN_OP(insn)) {
+        case LED_OP_END:
+            vm->pc--;
+            return LED_VM_HALT;
+        case LED_OP_SET:
+            vm->mask = imm;
+            break;
+        case LED_OP_OR:
+            vm->mask |= imm;
+            break;
+        case LED_OP_AND:
+            vm->mask &= imm;
+            break;
+        case LED_OP_XOR:
+            vm->mask ^= imm;
+            break;
+        case LED_OP_WAIT:
+            return imm;
+        case LED_OP_WAITSW:
+            if (switches & a) {
+                break;
+            }
+            vm->wait_sw = a;
+            return imm;
+        case LED_OP_JMP:
+            vm->pc = imm;
+            break;
+        case LED_OP_JSW:
+            if (switches & a) {
+                vm->pc = imm;
+            }
+            break;
+        case LED_OP_JNSW:
+            if (!(switches & a)) {
+                vm->pc = imm;
+            }
+            break;
+        case LED_OP_LOAD:
+            vm->reg[a] = imm;
+            break;
+        case LED_OP_DJNZ:
+            if (--vm->reg[a] != 0) {
+                vm->pc = imm;
+            }
+            break;
+        case LED_OP_SETR:
+            vm->mask = vm->reg[a] & LED_MASK_ALL;
+            break;
+        case LED_OP_ADD:
+            vm->reg[a] += imm;
+            break;
+        }
+    }
+
+    return LED_VM_FAULT;
+}
@@ -0,0 +1,27 @@
+#ifndef LED_VM_H
+#define LED_VM_H
+
+// LED 바이트코드 인터프리터 (커널 API 를 쓰지 않는 순수 로직)
+
+#include <linux/types.h>
+
+#include "led_uapi.h"
+
+#define LED_VM_HALT  (-1)  // 프로그램 종료
+#define LED_VM_FAULT (-2)  // 명령어 예산 초과
+
+struct led_vm {
+    u32 prog[LED_VM_MAX_INSNS];
+    u16 len;
+    u16 pc;
+    u16 reg[LED_VM_REGS];
+    u16 wait_sw;  // WAITSW 로 기다리는 스위치 마스크
+    u32 mask;     // 현재 LED 출력
+};
+
+int led_vm_verify(const u32 *insns, unsigned int count);
+void led_vm_load(struct led_vm *vm, const u32 *insns, unsigned int count);
+void led_vm_reset(struct led_vm *vm);
+int led_vm_run(struct led_vm *vm, u32 switches, unsigned int budget);
+
+#endif
@@ -1,21 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#define SYSFS_PATH "/sys/kernel/led_control/mode"
-
-void set_mode(int mode) {
-    FILE *file = fopen(SYSFS_PATH, "w");
-    if (file == NULL) {
-        perror("Failed to open sysfs file");
-        return;
-    }
-    fprintf(file, "%d\n", mode);
-    fclose(file);
-}
+#include "ledctl.h"
 
 int main() {
+    struct ledctl *led;
     int mode;
 
+    led = ledctl_open(NULL, 0);
+    if (led == NULL) {
+        perror("Failed to open the device");
+        return 1;
+    }
+
     printf("Mode 1: All blink\n");
     printf("Mode 2: Sequential blink\n");
     printf("Mode 3: Manual toggle mode\n");
@@ -31,9 +28,11 @@ int main() {
         }
         else if(mode == 5)
         {break;}
-        mode--;
-        set_mode(mode);
+        if (ledctl_set_mode(led, mode) < 0) {
+            perror("Failed to set mode");
+        }
     }
 
+    ledctl_close(led);
     return 0;
 }
@@ -1,10 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <string.h>
 
-#define DEVICE_PATH "/dev/led_control"
+#include "ledctl.h"
 
 void print_menu() {
     printf("\n--- Project 2 device + native ---\n");
@@ -16,12 +13,12 @@ void print_menu() {
 }
 
 int main() {
-    int fd, choice, ret;
-    char buffer[3];
+    struct ledctl *led;
+    int choice;
 
     // /dev/led_control 장치 열기
-    fd = open(DEVICE_PATH, O_RDWR);
-    if (fd < 0) {
+    led = ledctl_open(NULL, 0);
+    if (led == NULL) {
         perror("Failed to open device");
         return -1;
     }
@@ -29,13 +26,12 @@ int main() {
     print_menu();
     while (1) {
         printf("모드를 선택해주세요: ");
-        scanf("%d", &choice);
+        if (scanf("%d", &choice) != 1) {
+            break;
+        }
 
         if (choice == -1) { // 프로그램 종료
-            choice = 4;
-            snprintf(buffer, sizeof(buffer), "%d", choice);
-            ret = write(fd, buffer, strlen(buffer));
-            if (ret < 0) {
+            if (ledctl_set_mode(led, LED_MODE_RESET) < 0) {
                 perror("Failed");
             }
             printf("프로그램을 종료합니다\n");
@@ -44,48 +40,42 @@ int main() {
 
         // 0~4 모드 입력값 처리
         if (choice >= 0 && choice <= 4) {
+            if (ledctl_set_mode(led, choice) < 0) {
+                perror("Failed");
+                continue;
+            }
             if (choice == 3) { // Manual LED control
-                snprintf(buffer, sizeof(buffer), "%d", choice);
-                ret = write(fd, buffer, strlen(buffer));
-                if (ret < 0) {
-                    perror("Failed");
-                }
                 while (1) {
                     printf("개별 LED를 골라주세요 (0-3): ");
-                    scanf("%d", &choice);
+                    if (scanf("%d", &choice) != 1) {
+                        choice = 4;
+                    }
 
                     if (choice == 4){ // Manual mode 종료
-                        snprintf(buffer, sizeof(buffer), "%d", choice);
-                        ret = write(fd, buffer, strlen(buffer));
-                        if (ret < 0) {
+                        ledctl_release(led, LED_MASK_ALL);
+                        if (ledctl_set_mode(led, LED_MODE_RESET) < 0) {
                             perror("Failed");
                         }
                         break;
                     }
                     if (choice >= 0 && choice <= 3) {
-                        snprintf(buffer, sizeof(buffer), "%d", choice);
-                        ret = write(fd, buffer, strlen(buffer));
-                        if (ret < 0) {
+                        // 고른 LED 를 세션이 잡고 토글한다 (예전 드라이버는 LED 번호 쓰기)
+                        if (ledctl_claim(led, 1u << choice) < 0 || ledctl_toggle(led, 1u << choice) < 0 ||
+                            ledctl_flush(led) < 0) {
                             perror("LED 선택 실패");
                         } else {
-                            printf("LED %d 켜졌습니다.\n", choice);
+                            printf("LED %d 토글했습니다.\n", choice);
                         }
                     } else {
                         printf("올바른 번호를 입력해주세요.\n");
                     }
                 }
-            } else { // 다른 모드 선택
-                snprintf(buffer, sizeof(buffer), "%d", choice);
-                ret = write(fd, buffer, strlen(buffer));
-                if (ret < 0) {
-                    perror("Failed");
-                }
             }
         } else {
             printf("올바른 번호를 입력해주세요.\n");
         }
     }
 
-    close(fd); // 장치 닫기
+    ledctl_close(led); // 장치 닫기
     return 0;
 }
@@ -0,0 +1,286 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "led_uapi.h"
+
+// /dev/led_control 로 세션 요청 묶음을 보내는 세 가지 방법의 처리량 비교
+//   write   : 묶음 하나당 write() 한 번
+//   writev  : 묶음 depth 개를 writev() 한 번에
+//   uring   : 묶음 depth 개를 io_uring WRITE 로 올리고 io_uring_enter() 한 번에 제출/완료
+// liburing 없이 raw syscall 로 ring 을 다룬다. -d /dev/null 로 드라이버 없이 돌려 볼 수 있다.
+
+#define MAX_DEPTH 256
+
+struct batch {
+    struct led_req_header hdr;
+    struct led_req reqs[LED_REQ_MAX];
+};
+
+struct uring {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+};
+
+static struct batch batch;
+static size_t batch_len;
+
+static double now_sec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// LED0 을 잡고 reqs 개 요청으로 토글
+static void build_batch(int reqs) {
+    int i;
+
+    batch.hdr.magic = LED_REQ_MAGIC;
+    batch.hdr.version = LED_REQ_VERSION;
+    batch.hdr.count = reqs;
+    batch.reqs[0].op = LED_REQ_CLAIM;
+    batch.reqs[0].value = 1;
+    for (i = 1; i < reqs; i++) {
+        batch.reqs[i].op = LED_REQ_TOGGLE;
+        batch.reqs[i].value = 1;
+    }
+    batch_len = sizeof(batch.hdr) + reqs * sizeof(struct led_req);
+}
+
+// EAGAIN 은 세션 큐가 찬 것이므로 조금 쉬었다가 다시
+static int write_all(int fd, long batches) {
+    ssize_t ret;
+    long i;
+
+    for (i = 0; i < batches; i++) {
+        ret = write(fd, &batch, batch_len);
+        if (ret < 0 && errno == EAGAIN) {
+            i--;
+            continue;
+        }
+        if (ret < 0) {
+            perror("write");
+            return -1;
+        }
+        // 배치 하나가 레코드 하나라서 드라이버는 전부 받거나 실패한다
+        if ((size_t)ret != batch_len) {
+            fprintf(stderr, "write: short count %zd of %zu\n", ret, batch_len);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int writev_all(int fd, long batches, int depth) {
+    struct iovec iov[MAX_DEPTH];
+    ssize_t ret;
+    long i;
+    int n, k;
+
+    for (k = 0; k < depth; k++) {
+        iov[k].iov_base = &batch;
+        iov[k].iov_len = batch_len;
+    }
+    for (i = 0; i < batches; i += n) {
+        n = batches - i < depth ? batches - i : depth;
+        ret = writev(fd, iov, n);
+        if (ret < 0 && errno == EAGAIN) {
+            n = 0;
+            continue;
+        }
+        if (ret < 0) {
+            perror("writev");
+            return -1;
+        }
+        // 드라이버는 처리한 레코드까지만 받아들일 수 있다
+        n = ret / batch_len;
+    }
+    return 0;
+}
+
+static int uring_setup(struct uring *r, unsigned entries) {
+    struct io_uring_params p;
+    size_t sq_size, cq_size;
+    void *sq, *cq;
+
+    memset(&p, 0, sizeof(p));
+    r->fd = syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0) {
+        perror("io_uring_setup");
+        return -1;
+    }
+
+    sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        sq_size = cq_size = sq_size > cq_size ? sq_size : cq_size;
+    }
+    sq = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        perror("mmap sq");
+        return -1;
+    }
+    cq = sq;
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        cq = mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) {
+            perror("mmap cq");
+            return -1;
+        }
+    }
+    r->sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        perror("mmap sqes");
+        return -1;
+    }
+
+    r->sq_head = sq + p.sq_off.head;
+    r->sq_tail = sq + p.sq_off.tail;
+    r->sq_mask = sq + p.sq_off.ring_mask;
+    r->sq_array = sq + p.sq_off.array;
+    r->cq_head = cq + p.cq_off.head;
+    r->cq_tail = cq + p.cq_off.tail;
+    r->cq_mask = cq + p.cq_off.ring_mask;
+    r->cqes = cq + p.cq_off.cqes;
+    return 0;
+}
+
+static void uring_queue_write(struct uring *r, int fd) {
+    unsigned tail = *r->sq_tail, idx = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long)&batch;
+    sqe->len = batch_len;
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// 완료된 것 중 성공한 수. 실패가 있으면 -1
+static int uring_reap(struct uring *r, int *again) {
+    unsigned head = *r->cq_head;
+    int ok = 0;
+
+    while (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+
+        if (cqe->res == -EAGAIN) {
+            (*again)++;
+        } else if (cqe->res < 0) {
+            fprintf(stderr, "io_uring write: %s\n", strerror(-cqe->res));
+            return -1;
+        } else {
+            ok++;
+        }
+        head++;
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    return ok;
+}
+
+static int uring_all(int fd, long batches, int depth) {
+    struct uring r;
+    long done = 0;
+    int n, k, ok, again;
+
+    if (uring_setup(&r, depth) < 0) {
+        return -1;
+    }
+    while (done < batches) {
+        n = batches - done < depth ? batches - done : depth;
+        for (k = 0; k < n; k++) {
+            uring_queue_write(&r, fd);
+        }
+        if (syscall(__NR_io_uring_enter, r.fd, n, n, IORING_ENTER_GETEVENTS, NULL, 0) < 0) {
+            perror("io_uring_enter");
+            return -1;
+        }
+        again = 0;
+        ok = uring_reap(&r, &again);
+        if (ok < 0) {
+            return -1;
+        }
+        done += ok;
+    }
+    close(r.fd);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *dev = LED_DEVICE_PATH;
+    long batches = 100000;
+    int reqs = 16, depth = 32, opt, fd, i;
+    static const char *const names[] = { "write", "writev", "uring" };
+    double t;
+
+    while ((opt = getopt(argc, argv, "d:n:b:q:")) != -1) {
+        switch (opt) {
+        case 'd':
+            dev = optarg;
+            break;
+        case 'n':
+            batches = atol(optarg);
+            break;
+        case 'b':
+            reqs = atoi(optarg);
+            break;
+        case 'q':
+            depth = atoi(optarg);
+            break;
+        default:
+            printf("Usage: %s [-d device] [-n batches] [-b requests per batch] [-q depth]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reqs < 1 || reqs > LED_REQ_MAX || depth < 1 || depth > MAX_DEPTH || batches < 1 ||
+        (size_t)depth * (sizeof(struct led_req_header) + reqs * sizeof(struct led_req)) > LED_WRITE_MAX) {
+        fprintf(stderr, "invalid batch size or depth\n");
+        return 1;
+    }
+    build_batch(reqs);
+
+    fd = open(dev, O_WRONLY);
+    if (fd < 0) {
+        perror("Failed to open the device");
+        return 1;
+    }
+
+    printf("%ld batches x %d requests, depth %d\n", batches, reqs, depth);
+    for (i = 0; i < 3; i++) {
+        int ret;
+
+        t = now_sec();
+        if (i == 0) {
+            ret = write_all(fd, batches);
+        } else if (i == 1) {
+            ret = writev_all(fd, batches, depth);
+        } else {
+            ret = uring_all(fd, batches, depth);
+        }
+        t = now_sec() - t;
+        if (ret < 0) {
+            close(fd);
+            return 1;
+        }
+        printf("%-7s %10.0f batches/s %12.0f requests/s %8.0f ns/batch\n", names[i], batches / t,
+               batches * reqs / t, t * 1e9 / batches);
+    }
+
+    close(fd);
+    return 0;
+}
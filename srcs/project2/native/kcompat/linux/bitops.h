@@ -0,0 +1,6 @@
+#ifndef LED_KCOMPAT_BITOPS_H
+#define LED_KCOMPAT_BITOPS_H
+
+#define __ffs(x) ((unsigned long)__builtin_ctzl(x))
+
+#endif
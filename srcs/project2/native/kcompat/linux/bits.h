@@ -0,0 +1,7 @@
+#ifndef LED_KCOMPAT_BITS_H
+#define LED_KCOMPAT_BITS_H
+
+#define BIT(n) (1UL << (n))
+#define GENMASK(h, l) (((~0UL) >> (8 * sizeof(long) - 1 - (h))) & (~0UL << (l)))
+
+#endif
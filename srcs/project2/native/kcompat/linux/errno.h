@@ -0,0 +1,7 @@
+#ifndef LED_KCOMPAT_ERRNO_H
+#define LED_KCOMPAT_ERRNO_H
+
+// libc 의 <errno.h> 도 이 이름으로 들어오므로 시스템 헤더로 넘긴다
+#include_next <linux/errno.h>
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef LED_KCOMPAT_STRING_H
+#define LED_KCOMPAT_STRING_H
+
+#include <string.h>
+
+#endif
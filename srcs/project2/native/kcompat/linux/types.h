@@ -0,0 +1,23 @@
+#ifndef LED_KCOMPAT_TYPES_H
+#define LED_KCOMPAT_TYPES_H
+
+// 커널 API 를 쓰지 않는 모듈 소스(led_engine.c, led_vm.c)를 userspace 에서 빌드하기 위한 최소 정의
+
+#include_next <linux/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+
+// 커널 빌드는 compiler_attributes.h 가 항상 들어와 있다
+#define fallthrough __attribute__((__fallthrough__))
+
+#endif
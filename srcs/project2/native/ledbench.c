@@ -0,0 +1,358 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ledctl.h"
+
+// /dev/led_control 명령 처리량 / 왕복 지연 측정
+//   ledbench [-t threads] [-n ops/thread] [-m mix] [-r 0|1] [-o text|csv|json] [-d device]
+// 스레드마다 핸들(세션)을 따로 열고 mix 비율대로 명령을 골라 보낸 뒤
+// 상태를 다시 읽는 데까지 걸린 시간을 잰다 (-r 0 이면 read-back 생략).
+//   mix 예: mode=1,toggle=6,set=2,batch=1
+//     mode   : 모드 1/2/3 순환 (텍스트 레코드)
+//     toggle : LED 하나 토글 후 flush
+//     set    : LED 마스크 설정 후 flush
+//     batch  : 토글 16 개를 묶음 하나로
+// 드라이버 없이 돌려 보려면 -d /dev/null -r 0
+
+enum {
+    OP_MODE,
+    OP_TOGGLE,
+    OP_SET,
+    OP_BATCH,
+    OP_COUNT,
+};
+
+static const char *const op_names[OP_COUNT] = { "mode", "toggle", "set", "batch" };
+
+#define BATCH_REQS 16
+
+struct worker {
+    pthread_t thread;
+    int id;
+    int err;
+    long ops;
+    uint64_t start, end;
+    uint64_t *lat[OP_COUNT];  // 명령 종류별 지연 (ns)
+    long count[OP_COUNT];
+};
+
+static const char *device;
+static long ops_per_thread = 10000;
+static int weights[OP_COUNT] = { 1, 6, 2, 1 };
+static int weight_sum;
+static int readback = 1;
+static pthread_barrier_t start_barrier;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int parse_mix(char *arg) {
+    char *item, *eq;
+    int i;
+
+    memset(weights, 0, sizeof(weights));
+    for (item = strtok(arg, ","); item; item = strtok(NULL, ",")) {
+        eq = strchr(item, '=');
+        if (!eq) {
+            return -1;
+        }
+        *eq = '\0';
+        for (i = 0; i < OP_COUNT; i++) {
+            if (strcmp(item, op_names[i]) == 0) {
+                break;
+            }
+        }
+        if (i == OP_COUNT || atoi(eq + 1) < 0) {
+            return -1;
+        }
+        weights[i] = atoi(eq + 1);
+    }
+    return 0;
+}
+
+static int pick_op(unsigned *seed) {
+    int r = rand_r(seed) % weight_sum, i;
+
+    for (i = 0; i < OP_COUNT; i++) {
+        if (r < weights[i]) {
+            return i;
+        }
+        r -= weights[i];
+    }
+    return OP_TOGGLE;
+}
+
+static int run_op(struct ledctl *c, int op, long n, unsigned *seed) {
+    int i;
+
+    switch (op) {
+    case OP_MODE:
+        return ledctl_set_mode(c, LED_MODE_BLINK + n % 3);
+    case OP_TOGGLE:
+        if (ledctl_toggle(c, 1u << (rand_r(seed) % LED_NUM)) < 0) {
+            return -1;
+        }
+        break;
+    case OP_SET:
+        if (ledctl_set(c, rand_r(seed) & LED_MASK_ALL) < 0) {
+            return -1;
+        }
+        break;
+    case OP_BATCH:
+        for (i = 0; i < BATCH_REQS; i++) {
+            if (ledctl_toggle(c, 1u << (i % LED_NUM)) < 0) {
+                return -1;
+            }
+        }
+        break;
+    }
+    return ledctl_flush(c);
+}
+
+static void *worker_fn(void *arg) {
+    struct worker *w = arg;
+    unsigned seed = w->id * 2654435761u + 1;
+    struct ledctl *c;
+    uint64_t t;
+    long i;
+    int op;
+
+    c = ledctl_open(device, 0);
+    pthread_barrier_wait(&start_barrier);
+    if (!c) {
+        w->err = errno;
+        pthread_barrier_wait(&start_barrier);
+        return NULL;
+    }
+    // flush 는 명시적으로만. 묶음 크기 기준은 batch 한 번이 다 들어가게
+    ledctl_set_batch(c, LED_REQ_MAX, 0);
+    if (ledctl_claim(c, LED_MASK_ALL) < 0 || ledctl_flush(c) < 0) {
+        w->err = errno;
+    }
+    pthread_barrier_wait(&start_barrier);
+
+    w->start = now_ns();
+    for (i = 0; i < ops_per_thread && !w->err; i++) {
+        op = pick_op(&seed);
+        t = now_ns();
+        if (run_op(c, op, i, &seed) < 0 || (readback && ledctl_get_mode(c) < 0)) {
+            w->err = errno;
+            break;
+        }
+        w->lat[op][w->count[op]++] = now_ns() - t;
+        w->ops++;
+    }
+    w->end = now_ns();
+
+    ledctl_close(c);
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+struct summary {
+    const char *name;
+    long n;
+    double mean, p50, p99, p999, max;
+};
+
+// 정렬된 배열의 q 분위 (nearest rank)
+static double percentile(const uint64_t *v, long n, double q) {
+    long k = (long)(q * n + 0.5);
+
+    if (k < 1) {
+        k = 1;
+    }
+    return v[(k > n ? n : k) - 1];
+}
+
+static void summarize(struct summary *s, const char *name, uint64_t *v, long n) {
+    double sum = 0;
+    long i;
+
+    memset(s, 0, sizeof(*s));
+    s->name = name;
+    s->n = n;
+    if (n == 0) {
+        return;
+    }
+    qsort(v, n, sizeof(*v), cmp_u64);
+    for (i = 0; i < n; i++) {
+        sum += v[i];
+    }
+    s->mean = sum / n;
+    s->p50 = percentile(v, n, 0.50);
+    s->p99 = percentile(v, n, 0.99);
+    s->p999 = percentile(v, n, 0.999);
+    s->max = v[n - 1];
+}
+
+int main(int argc, char *argv[]) {
+    const char *format = "text";
+    struct summary sum[OP_COUNT + 1];
+    struct worker *workers;
+    uint64_t *all, *per_op;
+    long total = 0, n_all, n_op;
+    double elapsed;
+    int threads = 1, opt, i, k, err = 0;
+    uint64_t start, end;
+
+    while ((opt = getopt(argc, argv, "t:n:m:r:o:d:")) != -1) {
+        switch (opt) {
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'n':
+            ops_per_thread = atol(optarg);
+            break;
+        case 'm':
+            if (parse_mix(optarg) < 0) {
+                fprintf(stderr, "invalid mix: expected name=weight[,...] with names mode, toggle, set, batch\n");
+                return 1;
+            }
+            break;
+        case 'r':
+            readback = atoi(optarg);
+            break;
+        case 'o':
+            format = optarg;
+            break;
+        case 'd':
+            device = optarg;
+            break;
+        default:
+            printf("Usage: %s [-t threads] [-n ops/thread] [-m mix] [-r 0|1] [-o text|csv|json] [-d device]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    for (i = 0; i < OP_COUNT; i++) {
+        weight_sum += weights[i];
+    }
+    if (threads < 1 || ops_per_thread < 1 || weight_sum == 0) {
+        fprintf(stderr, "invalid thread count, op count or mix\n");
+        return 1;
+    }
+    if (strcmp(format, "text") && strcmp(format, "csv") && strcmp(format, "json")) {
+        fprintf(stderr, "unknown output format %s\n", format);
+        return 1;
+    }
+
+    workers = calloc(threads, sizeof(*workers));
+    all = malloc(sizeof(*all) * threads * ops_per_thread);
+    per_op = malloc(sizeof(*per_op) * threads * ops_per_thread);
+    if (!workers || !all || !per_op) {
+        perror("malloc");
+        return 1;
+    }
+    pthread_barrier_init(&start_barrier, NULL, threads + 1);
+    for (i = 0; i < threads; i++) {
+        workers[i].id = i;
+        for (k = 0; k < OP_COUNT; k++) {
+            workers[i].lat[k] = malloc(sizeof(uint64_t) * ops_per_thread);
+            if (!workers[i].lat[k]) {
+                perror("malloc");
+                return 1;
+            }
+        }
+        if (pthread_create(&workers[i].thread, NULL, worker_fn, &workers[i]) != 0) {
+            fprintf(stderr, "failed to start thread %d\n", i);
+            return 1;
+        }
+    }
+
+    // 모두 열고 claim 한 뒤 동시에 시작
+    pthread_barrier_wait(&start_barrier);
+    pthread_barrier_wait(&start_barrier);
+    for (i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    // 가장 먼저 시작한 스레드부터 가장 늦게 끝난 스레드까지
+    start = UINT64_MAX;
+    end = 0;
+    for (i = 0; i < threads; i++) {
+        if (workers[i].end) {
+            start = workers[i].start < start ? workers[i].start : start;
+            end = workers[i].end > end ? workers[i].end : end;
+        }
+    }
+    elapsed = end > start ? (end - start) / 1e9 : 1e-9;
+
+    n_all = 0;
+    for (i = 0; i < threads; i++) {
+        if (workers[i].err && !err) {
+            err = workers[i].err;
+            fprintf(stderr, "thread %d: %s\n", i, strerror(err));
+        }
+        total += workers[i].ops;
+        for (k = 0; k < OP_COUNT; k++) {
+            memcpy(all + n_all, workers[i].lat[k], sizeof(uint64_t) * workers[i].count[k]);
+            n_all += workers[i].count[k];
+        }
+    }
+    for (k = 0; k < OP_COUNT; k++) {
+        n_op = 0;
+        for (i = 0; i < threads; i++) {
+            memcpy(per_op + n_op, workers[i].lat[k], sizeof(uint64_t) * workers[i].count[k]);
+            n_op += workers[i].count[k];
+        }
+        summarize(&sum[k], op_names[k], per_op, n_op);
+    }
+    summarize(&sum[OP_COUNT], "all", all, n_all);
+
+    if (strcmp(format, "csv") == 0) {
+        printf("op,threads,count,ops_per_sec,mean_ns,p50_ns,p99_ns,p999_ns,max_ns\n");
+        for (k = 0; k <= OP_COUNT; k++) {
+            if (sum[k].n) {
+                printf("%s,%d,%ld,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f\n", sum[k].name, threads, sum[k].n,
+                       sum[k].n / elapsed, sum[k].mean, sum[k].p50, sum[k].p99, sum[k].p999, sum[k].max);
+            }
+        }
+    } else if (strcmp(format, "json") == 0) {
+        printf("{\"threads\":%d,\"readback\":%d,\"elapsed_s\":%.6f,\"ops\":%ld,\"ops_per_sec\":%.0f,\"ops_detail\":[",
+               threads, readback, elapsed, total, total / elapsed);
+        for (k = 0, i = 0; k <= OP_COUNT; k++) {
+            if (sum[k].n) {
+                printf("%s{\"op\":\"%s\",\"count\":%ld,\"mean_ns\":%.0f,\"p50_ns\":%.0f,\"p99_ns\":%.0f,"
+                       "\"p999_ns\":%.0f,\"max_ns\":%.0f}",
+                       i++ ? "," : "", sum[k].name, sum[k].n, sum[k].mean, sum[k].p50, sum[k].p99, sum[k].p999,
+                       sum[k].max);
+            }
+        }
+        printf("]}\n");
+    } else {
+        printf("%d threads, %ld ops in %.3f s: %.0f ops/s%s\n", threads, total, elapsed, total / elapsed,
+               readback ? "" : " (no read-back)");
+        printf("%-7s %9s %10s %10s %10s %10s %10s\n", "op", "count", "mean", "p50", "p99", "p99.9", "max");
+        for (k = 0; k <= OP_COUNT; k++) {
+            if (sum[k].n) {
+                printf("%-7s %9ld %8.0fns %8.0fns %8.0fns %8.0fns %8.0fns\n", sum[k].name, sum[k].n, sum[k].mean,
+                       sum[k].p50, sum[k].p99, sum[k].p999, sum[k].max);
+            }
+        }
+    }
+
+    for (i = 0; i < threads; i++) {
+        for (k = 0; k < OP_COUNT; k++) {
+            free(workers[i].lat[k]);
+        }
+    }
+    free(workers);
+    free(all);
+    free(per_op);
+    return err ? 1 : 0;
+}
@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "led_engine.h"
+
+// 모드 엔진 마이크로벤치마크: tick 한 번, 모드 전환 한 번, 프로그램 검증/적재 한 번의 비용 (ns)
+//   ledcost [-n iters] [-r rounds] [-o text|csv|json] [-k]
+// 모듈과 같은 led_engine.c / led_vm.c 를 빌드해 돌리므로 드라이버 없이 잴 수 있다.
+// 라운드마다 iters 번 반복하고, 전체 평균과 가장 빠른 라운드의 평균을 낸다.
+// -k : 드라이버의 /sys/kernel/led_control/stats (tick/dev_write 처리 시간 포함) 도 같이 출력
+// 결과를 쌓아 두고 비교하려면 -o csv 또는 -o json
+
+#define STATS_PATH "/sys/kernel/led_control/stats"
+#define PAT_FRAMES 16
+#define MAX_STATS 32
+
+enum {
+    B_TICK_BLINK,
+    B_TICK_SEQ,
+    B_TICK_PROGRAM,
+    B_TICK_PATTERN,
+    B_MODE_BLINK,
+    B_MODE_PROGRAM,
+    B_MODE_PATTERN,
+    B_VM_VERIFY,
+    B_VM_LOAD,
+    B_COUNT,
+};
+
+static const char *const bench_names[B_COUNT] = {
+    "tick_blink", "tick_seq", "tick_program", "tick_pattern",
+    "mode_blink", "mode_program", "mode_pattern",
+    "vm_verify", "vm_load",
+};
+
+struct result {
+    double mean_ns;
+    double best_ns;
+};
+
+struct kstat {
+    char name[48];
+    long long value;
+};
+
+static struct led_engine eng;
+static u32 prog[LED_VM_MAX_INSNS];
+static volatile u64 sink;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// 가장 긴(64 명령) 프로그램: 레지스터 루프로 LED 를 돌리고 WAIT 로 tick 을 끝낸다
+static void build_program(void) {
+    int i = 0;
+
+    prog[i++] = LED_VM_INSN(LED_OP_LOAD, 0, 4);
+    while (i < LED_VM_MAX_INSNS - 4) {
+        prog[i] = LED_VM_INSN(LED_OP_XOR, 0, 1 << (i % LED_NUM));
+        i++;
+    }
+    prog[i++] = LED_VM_INSN(LED_OP_DJNZ, 0, 1);
+    prog[i++] = LED_VM_INSN(LED_OP_WAIT, 0, 1);
+    prog[i++] = LED_VM_INSN(LED_OP_JMP, 0, 0);
+    prog[i++] = LED_VM_INSN(LED_OP_END, 0, 0);
+}
+
+static struct led_pattern_lib *build_patterns(void) {
+    struct led_pattern_lib *lib;
+    struct led_frame *frames;
+    int i;
+
+    lib = calloc(1, sizeof(*lib) + sizeof(struct led_pattern) + PAT_FRAMES * sizeof(struct led_frame));
+    if (!lib) {
+        return NULL;
+    }
+    frames = (struct led_frame *)((char *)lib + sizeof(*lib) + sizeof(struct led_pattern));
+    for (i = 0; i < PAT_FRAMES; i++) {
+        frames[i].mask = i & LED_MASK_ALL;
+        frames[i].duration_ms = 10;
+    }
+    lib->count = 1;
+    snprintf(lib->patterns[0].name, sizeof(lib->patterns[0].name), "bench");
+    lib->patterns[0].loop = true;
+    lib->patterns[0].nframes = PAT_FRAMES;
+    lib->patterns[0].frames = frames;
+    return lib;
+}
+
+static void run_once(int bench, long iters) {
+    long i;
+
+    switch (bench) {
+    case B_TICK_BLINK:
+    case B_TICK_SEQ:
+    case B_TICK_PROGRAM:
+    case B_TICK_PATTERN:
+        for (i = 0; i < iters; i++) {
+            sink += led_engine_step(&eng);
+        }
+        break;
+    case B_MODE_BLINK:
+        for (i = 0; i < iters; i++) {
+            sink += led_engine_set_mode(&eng, LED_MODE_BLINK);
+        }
+        break;
+    case B_MODE_PROGRAM:
+        for (i = 0; i < iters; i++) {
+            sink += led_engine_set_mode(&eng, LED_MODE_PROGRAM);
+        }
+        break;
+    case B_MODE_PATTERN:
+        for (i = 0; i < iters; i++) {
+            sink += led_engine_set_mode(&eng, LED_MODE_PATTERN);
+        }
+        break;
+    case B_VM_VERIFY:
+        for (i = 0; i < iters; i++) {
+            sink += led_vm_verify(prog, LED_VM_MAX_INSNS);
+        }
+        break;
+    case B_VM_LOAD:
+        for (i = 0; i < iters; i++) {
+            led_vm_load(&eng.vm, prog, LED_VM_MAX_INSNS);
+        }
+        break;
+    }
+}
+
+// tick 벤치마크는 해당 모드로 들어가 둔 상태에서 시작한다
+static void prepare(int bench) {
+    static const int tick_modes[] = { LED_MODE_BLINK, LED_MODE_SEQ, LED_MODE_PROGRAM, LED_MODE_PATTERN };
+
+    led_vm_load(&eng.vm, prog, LED_VM_MAX_INSNS);
+    if (bench <= B_TICK_PATTERN) {
+        led_engine_set_mode(&eng, tick_modes[bench]);
+    }
+}
+
+static void measure(int bench, long iters, int rounds, struct result *res) {
+    uint64_t t, total = 0, best = UINT64_MAX;
+    int r;
+
+    prepare(bench);
+    run_once(bench, iters / 10 + 1);  // 캐시 데우기
+    for (r = 0; r < rounds; r++) {
+        t = now_ns();
+        run_once(bench, iters);
+        t = now_ns() - t;
+        total += t;
+        if (t < best) {
+            best = t;
+        }
+    }
+    res->mean_ns = (double)total / ((double)iters * rounds);
+    res->best_ns = (double)best / iters;
+}
+
+static int read_kstats(struct kstat *ks) {
+    FILE *in = fopen(STATS_PATH, "r");
+    int n = 0;
+
+    if (!in) {
+        return -1;
+    }
+    while (n < MAX_STATS && fscanf(in, "%47s %lld", ks[n].name, &ks[n].value) == 2) {
+        n++;
+    }
+    fclose(in);
+    return n;
+}
+
+int main(int argc, char *argv[]) {
+    struct result res[B_COUNT];
+    struct kstat ks[MAX_STATS];
+    struct led_pattern_lib *lib;
+    const char *format = "text";
+    long iters = 200000;
+    int rounds = 5, kernel = 0, n_ks = 0, opt, i;
+
+    while ((opt = getopt(argc, argv, "n:r:o:k")) != -1) {
+        switch (opt) {
+        case 'n':
+            iters = atol(optarg);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        case 'o':
+            format = optarg;
+            break;
+        case 'k':
+            kernel = 1;
+            break;
+        default:
+            printf("Usage: %s [-n iters] [-r rounds] [-o text|csv|json] [-k]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iters < 1 || rounds < 1 || (strcmp(format, "text") && strcmp(format, "csv") && strcmp(format, "json"))) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+    if (kernel) {
+        n_ks = read_kstats(ks);
+        if (n_ks < 0) {
+            perror(STATS_PATH);
+            return 1;
+        }
+    }
+
+    build_program();
+    if (led_vm_verify(prog, LED_VM_MAX_INSNS) < 0) {
+        fprintf(stderr, "benchmark program rejected by verifier\n");
+        return 1;
+    }
+    lib = build_patterns();
+    if (!lib) {
+        perror("calloc");
+        return 1;
+    }
+    led_engine_init(&eng, 1000000, 256);
+    eng.patterns = lib;
+
+    for (i = 0; i < B_COUNT; i++) {
+        measure(i, iters, rounds, &res[i]);
+    }
+
+    if (strcmp(format, "csv") == 0) {
+        printf("name,iters,rounds,mean_ns,best_ns\n");
+        for (i = 0; i < B_COUNT; i++) {
+            printf("%s,%ld,%d,%.2f,%.2f\n", bench_names[i], iters, rounds, res[i].mean_ns, res[i].best_ns);
+        }
+        for (i = 0; i < n_ks; i++) {
+            printf("kernel_%s,,,%lld,\n", ks[i].name, ks[i].value);
+        }
+    } else if (strcmp(format, "json") == 0) {
+        printf("{\"iters\":%ld,\"rounds\":%d,\"bench\":[", iters, rounds);
+        for (i = 0; i < B_COUNT; i++) {
+            printf("%s{\"name\":\"%s\",\"mean_ns\":%.2f,\"best_ns\":%.2f}", i ? "," : "", bench_names[i],
+                   res[i].mean_ns, res[i].best_ns);
+        }
+        printf("]");
+        if (kernel) {
+            printf(",\"kernel\":{");
+            for (i = 0; i < n_ks; i++) {
+                printf("%s\"%s\":%lld", i ? "," : "", ks[i].name, ks[i].value);
+            }
+            printf("}");
+        }
+        printf("}\n");
+    } else {
+        printf("%-14s %10s %10s\n", "bench", "mean", "best");
+        for (i = 0; i < B_COUNT; i++) {
+            printf("%-14s %8.1fns %8.1fns\n", bench_names[i], res[i].mean_ns, res[i].best_ns);
+        }
+        if (kernel) {
+            printf("\n" STATS_PATH "\n");
+            for (i = 0; i < n_ks; i++) {
+                printf("  %-22s %lld\n", ks[i].name, ks[i].value);
+            }
+        }
+    }
+
+    free(lib);
+    return 0;
+}
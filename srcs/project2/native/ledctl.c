@@ -0,0 +1,485 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+#include "ledctl.h"
+
+// 드라이버는 write 없이 장치 노드의 sysfs 디렉터리(/sys/dev/char/<major>:<minor>)로 가린다.
+// 예전 dev_write 는 입력 버퍼가 3 byte 라 길이 검사 없이 복사하므로 LEDQ 로 떠 보면 안 된다.
+//   engine_sched 속성이 있음 : LEDQ 를 받는 led_control
+//   subsystem 이 cuse        : ledcuse 대역 (LEDQ 를 받는다)
+//   그 밖의 문자 장치         : 예전 드라이버
+#define LEDCTL_SYSFS_CHAR "/sys/dev/char"
+#define NO_BATCH ((size_t)-1)
+#define EVENT_BATCH 64
+
+struct ledctl {
+    int fd;
+    int ev_fd;
+    int epfd;
+    int flags;
+    int legacy;
+    unsigned max_reqs;
+    unsigned max_delay_us;
+    size_t len;          // buf 에 쌓인 바이트
+    size_t batch;        // 열려 있는 LEDQ 묶음의 header 위치
+    unsigned batch_reqs; // 열려 있는 묶음의 요청 수
+    unsigned pending;    // buf 전체의 요청 수
+    uint64_t deadline;   // 시간 기준 flush 시각 (ns), 0 이면 없음
+    ledctl_event_cb cb;
+    void *cb_arg;
+    char buf[LED_WRITE_MAX];
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// 드라이버가 소비한 만큼 앞에서 빼 가며 보낸다.
+// EAGAIN 이면 남은 것을 그대로 두고, 다른 오류면 남은 것을 버린다.
+static int write_buf(struct ledctl *c) {
+    size_t done = 0;
+    ssize_t ret;
+    int err = 0;
+
+    while (done < c->len) {
+        ret = write(c->fd, c->buf + done, c->len - done);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            err = ret < 0 ? errno : EIO;
+            break;
+        }
+        done += ret;
+    }
+
+    if (err == EAGAIN && done < c->len) {
+        // 남은 앞부분이 열린 묶음이면 header 위치도 같이 당긴다
+        memmove(c->buf, c->buf + done, c->len - done);
+        c->len -= done;
+        if (c->batch != NO_BATCH) {
+            c->batch = c->batch >= done ? c->batch - done : NO_BATCH;
+        }
+        errno = EAGAIN;
+        return -1;
+    }
+
+    c->len = 0;
+    c->batch = NO_BATCH;
+    c->batch_reqs = 0;
+    c->pending = 0;
+    c->deadline = 0;
+    if (err) {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+int ledctl_flush(struct ledctl *c) {
+    if (c->legacy || c->len == 0) {
+        return 0;
+    }
+    return write_buf(c);
+}
+
+// 예전 드라이버: write 한 번에 값 하나, 줄바꿈 없이 최대 2 글자
+static int legacy_write(struct ledctl *c, int value) {
+    char text[4];
+    int len = snprintf(text, sizeof(text), "%d", value);
+
+    if (len > 2) {
+        errno = EINVAL;
+        return -1;
+    }
+    return write(c->fd, text, len) == len ? 0 : -1;
+}
+
+enum {
+    DRIVER_LEGACY,
+    DRIVER_LEDQ,
+    DRIVER_UNKNOWN,  // 문자 장치가 아님
+};
+
+static int detect(int fd) {
+    char dir[64], path[PATH_MAX], link[PATH_MAX];
+    struct stat st;
+    const char *name;
+    ssize_t len;
+
+    if (fstat(fd, &st) < 0 || !S_ISCHR(st.st_mode)) {
+        return DRIVER_UNKNOWN;
+    }
+    snprintf(dir, sizeof(dir), LEDCTL_SYSFS_CHAR "/%u:%u", major(st.st_rdev), minor(st.st_rdev));
+    snprintf(path, sizeof(path), "%s/engine_sched", dir);
+    if (access(path, F_OK) == 0) {
+        return DRIVER_LEDQ;
+    }
+    snprintf(path, sizeof(path), "%s/subsystem", dir);
+    len = readlink(path, link, sizeof(link) - 1);
+    if (len > 0) {
+        link[len] = '\0';
+        name = strrchr(link, '/');
+        if (strcmp(name ? name + 1 : link, "cuse") == 0) {
+            return DRIVER_LEDQ;
+        }
+    }
+    return DRIVER_LEGACY;
+}
+
+// 문자 장치가 아닌 노드(파이프, 소켓 등)만 빈 우선순위 요청으로 떠 본다.
+// EAGAIN 은 세션 큐가 찬 것이므로 LEDQ 를 받는 쪽이다
+static int probe(struct ledctl *c) {
+    struct {
+        struct led_req_header hdr;
+        struct led_req req;
+    } q = {
+        .hdr = { LED_REQ_MAGIC, LED_REQ_VERSION, 1 },
+        .req = { .op = LED_REQ_PRIORITY, .value = 0 },
+    };
+
+    if (write(c->fd, &q, sizeof(q)) == sizeof(q) || errno == EAGAIN) {
+        return 0;
+    }
+    if (errno == EINVAL) {
+        c->legacy = 1;
+        return 0;
+    }
+    return -1;
+}
+
+struct ledctl *ledctl_open(const char *path, int flags) {
+    struct ledctl *c;
+
+    c = calloc(1, sizeof(*c));
+    if (!c) {
+        return NULL;
+    }
+    c->ev_fd = -1;
+    c->epfd = -1;
+    c->flags = flags;
+    c->max_reqs = LEDCTL_DEFAULT_MAX_REQS;
+    c->max_delay_us = LEDCTL_DEFAULT_DELAY_US;
+    c->batch = NO_BATCH;
+
+    if (!path) {
+        path = LED_DEVICE_PATH;
+    }
+    c->fd = open(path, O_RDWR | O_CLOEXEC | ((flags & LEDCTL_NONBLOCK) ? O_NONBLOCK : 0));
+    if (c->fd < 0) {
+        goto fail;
+    }
+    c->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (c->epfd < 0) {
+        goto fail;
+    }
+
+    if (flags & LEDCTL_LEGACY) {
+        c->legacy = 1;
+    } else if (!(flags & LEDCTL_LEDQ)) {
+        switch (detect(c->fd)) {
+        case DRIVER_LEGACY:
+            c->legacy = 1;
+            break;
+        case DRIVER_UNKNOWN:
+            if (probe(c) < 0) {
+                goto fail;
+            }
+            break;
+        }
+    }
+    return c;
+
+fail:
+    ledctl_close(c);
+    return NULL;
+}
+
+int ledctl_close(struct ledctl *c) {
+    int ret = 0;
+
+    if (!c) {
+        return 0;
+    }
+    if (c->fd >= 0) {
+        ret = ledctl_flush(c);
+        close(c->fd);
+    }
+    if (c->ev_fd >= 0) {
+        close(c->ev_fd);
+    }
+    if (c->epfd >= 0) {
+        close(c->epfd);
+    }
+    free(c);
+    return ret;
+}
+
+int ledctl_set_batch(struct ledctl *c, unsigned max_reqs, unsigned max_delay_us) {
+    if (max_reqs < 1 || max_reqs > LED_REQ_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    c->max_reqs = max_reqs;
+    c->max_delay_us = max_delay_us;
+    if (c->pending >= max_reqs) {
+        return ledctl_flush(c);
+    }
+    return 0;
+}
+
+int ledctl_is_legacy(const struct ledctl *c) {
+    return c->legacy;
+}
+
+unsigned ledctl_pending(const struct ledctl *c) {
+    return c->pending;
+}
+
+// 텍스트 레코드를 쌓인 요청 뒤에 붙여 바로 보낸다
+static int send_text(struct ledctl *c, const char *text) {
+    size_t len = strlen(text);
+
+    if (len + 1 >= 64 || memchr(text, '\n', len)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (c->len + len + 1 > sizeof(c->buf) && ledctl_flush(c) < 0) {
+        return -1;
+    }
+    memcpy(c->buf + c->len, text, len);
+    c->buf[c->len + len] = '\n';
+    c->len += len + 1;
+    // 텍스트 뒤에 오는 요청은 새 묶음으로
+    c->batch = NO_BATCH;
+    return write_buf(c);
+}
+
+int ledctl_set_mode(struct ledctl *c, int mode) {
+    char text[16];
+
+    if (c->legacy) {
+        return legacy_write(c, mode);
+    }
+    snprintf(text, sizeof(text), "%d", mode);
+    return send_text(c, text);
+}
+
+int ledctl_get_mode(struct ledctl *c) {
+    char text[16];
+    ssize_t len;
+
+    if (ledctl_flush(c) < 0) {
+        return -1;
+    }
+    len = read(c->fd, text, sizeof(text) - 1);
+    if (len <= 0) {
+        if (len == 0) {
+            errno = EIO;
+        }
+        return -1;
+    }
+    text[len] = '\0';
+    return atoi(text);
+}
+
+int ledctl_command(struct ledctl *c, const char *cmd) {
+    if (c->legacy) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+    return send_text(c, cmd);
+}
+
+// 예전 드라이버는 수동 모드에서 LED 번호를 쓰면 그 LED 를 토글한다.
+// 소유권과 우선순위 개념이 없으므로 claim/release/priority 는 아무것도 하지 않는다.
+static int legacy_req(struct ledctl *c, int op, uint32_t value) {
+    int i;
+
+    switch (op) {
+    case LED_REQ_CLAIM:
+    case LED_REQ_RELEASE:
+    case LED_REQ_PRIORITY:
+        return 0;
+    case LED_REQ_TOGGLE:
+        for (i = 0; i < LED_NUM; i++) {
+            if ((value & (1u << i)) && legacy_write(c, i) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    errno = EOPNOTSUPP;
+    return -1;
+}
+
+static int queue_req(struct ledctl *c, int op, uint32_t value) {
+    struct led_req_header hdr = { LED_REQ_MAGIC, LED_REQ_VERSION, 0 };
+    struct led_req req = { .op = op, .value = value };
+    uint64_t now;
+
+    if (c->legacy) {
+        return legacy_req(c, op, value);
+    }
+
+    // 묶음 하나는 LED_REQ_MAX 까지. 버퍼가 모자라면 먼저 보낸다
+    if (c->batch == NO_BATCH || c->batch_reqs == LED_REQ_MAX) {
+        if (c->len + sizeof(hdr) + sizeof(req) > sizeof(c->buf) && ledctl_flush(c) < 0) {
+            return -1;
+        }
+        c->batch = c->len;
+        c->batch_reqs = 0;
+        memcpy(c->buf + c->len, &hdr, sizeof(hdr));
+        c->len += sizeof(hdr);
+    } else if (c->len + sizeof(req) > sizeof(c->buf)) {
+        if (ledctl_flush(c) < 0) {
+            return -1;
+        }
+        return queue_req(c, op, value);
+    }
+
+    memcpy(c->buf + c->len, &req, sizeof(req));
+    c->len += sizeof(req);
+    c->batch_reqs++;
+    hdr.count = c->batch_reqs;
+    memcpy(c->buf + c->batch, &hdr, sizeof(hdr));
+
+    now = now_ns();
+    if (c->pending++ == 0 && c->max_delay_us) {
+        c->deadline = now + (uint64_t)c->max_delay_us * 1000;
+    }
+    if (c->pending >= c->max_reqs || (c->deadline && now >= c->deadline)) {
+        return ledctl_flush(c);
+    }
+    return 0;
+}
+
+int ledctl_claim(struct ledctl *c, uint32_t mask) {
+    return queue_req(c, LED_REQ_CLAIM, mask);
+}
+
+int ledctl_release(struct ledctl *c, uint32_t mask) {
+    return queue_req(c, LED_REQ_RELEASE, mask);
+}
+
+int ledctl_set(struct ledctl *c, uint32_t mask) {
+    return queue_req(c, LED_REQ_SET, mask);
+}
+
+int ledctl_on(struct ledctl *c, uint32_t mask) {
+    return queue_req(c, LED_REQ_ON, mask);
+}
+
+int ledctl_off(struct ledctl *c, uint32_t mask) {
+    return queue_req(c, LED_REQ_OFF, mask);
+}
+
+int ledctl_toggle(struct ledctl *c, uint32_t mask) {
+    return queue_req(c, LED_REQ_TOGGLE, mask);
+}
+
+int ledctl_priority(struct ledctl *c, int prio) {
+    if (prio < 0 || prio > 255) {
+        errno = EINVAL;
+        return -1;
+    }
+    return queue_req(c, LED_REQ_PRIORITY, prio);
+}
+
+int ledctl_on_event(struct ledctl *c, ledctl_event_cb cb, void *arg) {
+    struct epoll_event ev = { .events = EPOLLIN };
+
+    if (!cb) {
+        if (c->ev_fd >= 0) {
+            epoll_ctl(c->epfd, EPOLL_CTL_DEL, c->ev_fd, NULL);
+            close(c->ev_fd);
+            c->ev_fd = -1;
+        }
+        c->cb = NULL;
+        return 0;
+    }
+    if (c->ev_fd < 0) {
+        c->ev_fd = open(LED_EVENTS_PATH, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (c->ev_fd < 0) {
+            return -1;
+        }
+        ev.data.fd = c->ev_fd;
+        if (epoll_ctl(c->epfd, EPOLL_CTL_ADD, c->ev_fd, &ev) < 0) {
+            close(c->ev_fd);
+            c->ev_fd = -1;
+            return -1;
+        }
+    }
+    c->cb = cb;
+    c->cb_arg = arg;
+    return 0;
+}
+
+int ledctl_fd(const struct ledctl *c) {
+    return c->epfd;
+}
+
+static int dispatch_events(struct ledctl *c) {
+    struct led_event ev[EVENT_BATCH];
+    ssize_t len;
+    int n = 0, i;
+
+    for (;;) {
+        len = read(c->ev_fd, ev, sizeof(ev));
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN ? n : -1;
+        }
+        if (len == 0) {
+            return n;
+        }
+        for (i = 0; i < len / (ssize_t)sizeof(ev[0]); i++, n++) {
+            c->cb(&ev[i], c->cb_arg);
+        }
+    }
+}
+
+int ledctl_run(struct ledctl *c, int timeout_ms) {
+    struct epoll_event ev;
+    uint64_t now;
+    int wait_ms = timeout_ms, ret, n = 0;
+
+    // 묶음 마감이 먼저 오면 그때까지만 기다린다
+    if (c->deadline) {
+        now = now_ns();
+        ret = c->deadline > now ? (int)((c->deadline - now + 999999) / 1000000) : 0;
+        if (wait_ms < 0 || ret < wait_ms) {
+            wait_ms = ret;
+        }
+    }
+
+    ret = epoll_wait(c->epfd, &ev, 1, wait_ms);
+    if (ret < 0 && errno != EINTR) {
+        return -1;
+    }
+    if (ret > 0 && c->cb) {
+        n = dispatch_events(c);
+        if (n < 0) {
+            return -1;
+        }
+    }
+
+    if (c->deadline && now_ns() >= c->deadline && ledctl_flush(c) < 0 && errno != EAGAIN) {
+        return -1;
+    }
+    return n;
+}
@@ -0,0 +1,64 @@
+#ifndef LEDCTL_H
+#define LEDCTL_H
+
+// libledctl: /dev/led_control 클라이언트 라이브러리
+//
+// LED 요청(claim/set/on/off/toggle/priority)은 바로 보내지 않고 LEDQ 묶음으로 모았다가
+// 요청 수(max_reqs) 나 첫 요청 후 지난 시간(max_delay_us) 이 넘으면 write() 한 번으로 보낸다.
+// 모드/텍스트 명령은 쌓인 요청 뒤에 붙여 즉시 보낸다 (순서 유지, 오류는 그 호출이 받는다).
+// LEDQ 를 모르는 예전 드라이버면 텍스트 프로토콜(한 write 에 값 하나)로 내려간다.
+// 어느 쪽인지는 장치 노드의 sysfs 로 가리며, 드라이버에 시험 write 를 보내지 않는다.
+//
+// 핸들 하나는 드라이버 세션 하나이고 스레드 안전하지 않다. 스레드마다 따로 연다.
+// 실패하면 -1 을 돌려주고 errno 를 설정한다.
+
+#include <stdint.h>
+
+#include "led_uapi.h"
+
+struct ledctl;
+
+typedef void (*ledctl_event_cb)(const struct led_event *ev, void *arg);
+
+#define LEDCTL_NONBLOCK 0x1  // 세션 큐가 차면 기다리지 않고 EAGAIN (쌓인 요청은 유지)
+#define LEDCTL_LEGACY   0x2  // 확인 없이 텍스트 프로토콜만 사용
+#define LEDCTL_LEDQ     0x4  // 확인 없이 LEDQ 를 받는 드라이버로 본다
+
+#define LEDCTL_DEFAULT_MAX_REQS  64
+#define LEDCTL_DEFAULT_DELAY_US  1000
+
+// path 가 NULL 이면 LED_DEVICE_PATH
+struct ledctl *ledctl_open(const char *path, int flags);
+// 쌓인 요청을 보내고 닫는다
+int ledctl_close(struct ledctl *c);
+
+// max_reqs: 1 ~ LED_REQ_MAX, max_delay_us: 0 이면 시간 기준 flush 없음
+int ledctl_set_batch(struct ledctl *c, unsigned max_reqs, unsigned max_delay_us);
+int ledctl_is_legacy(const struct ledctl *c);
+
+int ledctl_set_mode(struct ledctl *c, int mode);
+int ledctl_get_mode(struct ledctl *c);
+// "pattern 2", "sync 0" 같은 텍스트 명령 한 줄 (줄바꿈 없이)
+int ledctl_command(struct ledctl *c, const char *cmd);
+
+// 세션 요청. mask 는 LED 비트마스크
+int ledctl_claim(struct ledctl *c, uint32_t mask);
+int ledctl_release(struct ledctl *c, uint32_t mask);
+int ledctl_set(struct ledctl *c, uint32_t mask);
+int ledctl_on(struct ledctl *c, uint32_t mask);
+int ledctl_off(struct ledctl *c, uint32_t mask);
+int ledctl_toggle(struct ledctl *c, uint32_t mask);
+int ledctl_priority(struct ledctl *c, int prio);
+// 쌓인 요청 수
+unsigned ledctl_pending(const struct ledctl *c);
+int ledctl_flush(struct ledctl *c);
+
+// /dev/led_events 를 열어 이벤트마다 cb 호출. cb 가 NULL 이면 해제
+int ledctl_on_event(struct ledctl *c, ledctl_event_cb cb, void *arg);
+// 자체 이벤트 루프에 넣을 epoll fd (읽을 수 있게 되면 ledctl_run(c, 0) 호출)
+int ledctl_fd(const struct ledctl *c);
+// 이벤트를 기다려 콜백을 부르고 시간이 된 묶음을 보낸다.
+// timeout_ms < 0 이면 무한 대기. 처리한 이벤트 수를 돌려준다.
+int ledctl_run(struct ledctl *c, int timeout_ms);
+
+#endif
@@ -0,0 +1,588 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <linux/fuse.h>
+
+#include "led_engine.h"
+#include "led_proto.h"
+
+// CUSE 로 만드는 /dev/led_control 대역 (드라이버, GPIO, 보드 없이)
+//   ledcuse [-n devname] [-t threads] [-p period_ms] [-l timeline] [-v]
+//   -n : 만들 장치 이름 (기본 led_control -> /dev/led_control)
+//   -t : /dev/cuse 요청을 처리할 스레드 수 (기본 4)
+//   -l : 출력이 바뀔 때마다 "시각(ns) 마스크" 한 줄을 기록할 파일
+//   -v : 출력 변화를 화면에도 찍는다
+// led_module.c 의 dev_write/dev_read 와 같은 프로토콜(모드 번호, LEVM, LEDQ)을 같은 모드 엔진
+// (led_engine.c, led_vm.c)과 가짜 LED 뱅크로 처리한다. libfuse 없이 /dev/cuse 를 직접 읽는다.
+// 레코드 구분, 텍스트 해석, 요청 검사, 세션 중재는 모듈과 같은 led_proto.c 를 쓴다.
+// 드라이버와 다른 점
+//   - LEDQ 요청은 엔진 스레드의 큐를 거치지 않고 write 안에서 바로 중재까지 끝낸다
+//   - pattern/sync/layer/load 명령, /dev/led_events, mmap, SIGIO 는 없다 (-EOPNOTSUPP)
+//   - inject 는 항상 받지만 스위치 레벨만 바꾸고 제스처는 만들지 않는다
+// SIGINT/SIGTERM 이면 통계를 찍고 끝난다 (장치도 같이 사라진다).
+
+#define CUSE_DEV "/dev/cuse"
+#define REQ_BUF_SIZE (LED_WRITE_MAX + 4096)  // header + fuse_write_in + 최대 write
+#define MAX_THREADS 64
+
+struct session {
+    struct session *prev, *next;  // 연 순서대로 (같은 priority 면 앞이 이김)
+    struct led_owner own;
+};
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t kick;         // 모드가 바뀌면 엔진 스레드를 깨운다
+    struct led_engine eng;
+    uint64_t next_tick;          // CLOCK_MONOTONIC ns, LED_ENGINE_STOP 이면 없음
+    struct session *head, *tail;
+    uint32_t claim, value;       // 세션 중재 결과
+    uint32_t out;                // 가짜 LED 뱅크
+    uint64_t t0;
+    FILE *timeline;
+    int verbose;
+    uint64_t opens, reads, writes, errors, ticks, changes;
+} st = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .next_tick = LED_ENGINE_STOP,
+};
+
+static int cuse_fd = -1;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// 모드 출력 위에 세션 overlay 를 얹어 LED 뱅크에 반영 (st.lock 잡은 상태)
+static void output_commit(void) {
+    uint32_t out = (st.eng.mask & ~st.claim) | st.value;
+    uint64_t t;
+
+    if (out == st.out) {
+        return;
+    }
+    t = now_ns() - st.t0;
+    if (st.timeline) {
+        fprintf(st.timeline, "%llu %x\n", (unsigned long long)t, out);
+    }
+    if (st.verbose) {
+        printf("%12.3f ms  0x%x -> 0x%x\n", t / 1e6, st.out, out);
+    }
+    st.out = out;
+    st.changes++;
+}
+
+// LED 마다 주인을 다시 정한다 (드라이버와 같이 연 순서대로 led_arb 에 넣는다)
+static void arbitrate(void) {
+    struct session *sess;
+    struct led_arb arb;
+
+    led_arb_init(&arb);
+    for (sess = st.head; sess; sess = sess->next) {
+        led_arb_add(&arb, &sess->own);
+    }
+    led_arb_result(&arb, &st.claim, &st.value);
+}
+
+static void set_mode(int mode) {
+    uint64_t delay = led_engine_set_mode(&st.eng, mode);
+
+    st.next_tick = delay == LED_ENGINE_STOP ? LED_ENGINE_STOP : now_ns() + delay;
+    if (st.eng.changed) {
+        output_commit();
+    }
+    pthread_cond_signal(&st.kick);
+}
+
+static void *engine_thread(void *arg) {
+    struct timespec ts;
+    uint64_t now, delay;
+
+    pthread_mutex_lock(&st.lock);
+    for (;;) {
+        if (st.next_tick == LED_ENGINE_STOP) {
+            pthread_cond_wait(&st.kick, &st.lock);
+            continue;
+        }
+        now = now_ns();
+        if (now < st.next_tick) {
+            ts.tv_sec = st.next_tick / 1000000000;
+            ts.tv_nsec = st.next_tick % 1000000000;
+            pthread_cond_timedwait(&st.kick, &st.lock, &ts);
+            continue;
+        }
+
+        delay = led_engine_step(&st.eng);
+        st.ticks++;
+        if (st.eng.changed) {
+            output_commit();
+        }
+        if (delay == LED_ENGINE_STOP) {
+            st.next_tick = LED_ENGINE_STOP;
+        } else {
+            // 드라이버처럼 위상을 유지하고, 많이 밀렸으면 지금부터 다시 센다
+            st.next_tick += delay;
+            if (st.next_tick < now) {
+                st.next_tick = now + delay;
+            }
+        }
+    }
+    return NULL;
+}
+
+// 바이트코드 프로그램: header + 명령어 배열. 소비한 길이 또는 -errno
+static ssize_t program_write(const char *data, size_t avail) {
+    struct led_vm_header hdr;
+    u32 insns[LED_VM_MAX_INSNS];
+    ssize_t size;
+    int ret;
+
+    if (!led_mode_desc(LED_MODE_PROGRAM)) {
+        return -EOPNOTSUPP;
+    }
+    size = led_rec_program(data, avail, &hdr);
+    if (size < 0) {
+        return size;
+    }
+    memcpy(insns, data + sizeof(hdr), hdr.count * sizeof(u32));
+    ret = led_vm_verify(insns, hdr.count);
+    if (ret < 0) {
+        return ret;
+    }
+
+    pthread_mutex_lock(&st.lock);
+    led_vm_load(&st.eng.vm, insns, hdr.count);
+    if (st.eng.mode == LED_MODE_PROGRAM) {
+        set_mode(LED_MODE_PROGRAM);
+    }
+    pthread_mutex_unlock(&st.lock);
+    return size;
+}
+
+// LEDQ 요청 묶음: 검사한 뒤 한꺼번에 반영하고 출력은 한 번만 바꾼다
+static ssize_t session_write(struct session *sess, const char *data, size_t avail) {
+    struct led_req_header hdr;
+    struct led_req req;
+    ssize_t size;
+    int i;
+
+    size = led_rec_reqs(data, avail, &hdr);
+    if (size < 0) {
+        return size;
+    }
+
+    pthread_mutex_lock(&st.lock);
+    for (i = 0; i < hdr.count; i++) {
+        memcpy(&req, data + sizeof(hdr) + i * sizeof(req), sizeof(req));
+        led_req_apply(&sess->own, &req);
+    }
+    arbitrate();
+    output_commit();
+    pthread_mutex_unlock(&st.lock);
+    return size;
+}
+
+// inject <mask>: 스위치 레벨만 바꾼다 (제스처 인식은 없고, WAITSW 로 기다리는 프로그램은 깨운다)
+static int inject(const char *arg) {
+    u32 held;
+
+    if (led_text_u32(arg, &held) < 0 || held > SW_MASK_ALL) {
+        return -EINVAL;
+    }
+    pthread_mutex_lock(&st.lock);
+    st.eng.switches = held;
+    if (st.eng.mode == LED_MODE_PROGRAM && (st.eng.vm.wait_sw & held)) {
+        st.eng.vm.wait_sw = 0;
+        st.next_tick = now_ns();
+        pthread_cond_signal(&st.kick);
+    }
+    pthread_mutex_unlock(&st.lock);
+    return 0;
+}
+
+static int mode_write(int mode) {
+    const struct led_mode_desc *desc = led_mode_desc(mode);
+
+    if (!desc) {
+        return -EOPNOTSUPP;
+    }
+    pthread_mutex_lock(&st.lock);
+    // 패턴 라이브러리는 올릴 수 없으므로 패턴 모드는 드라이버에 파일이 없을 때와 같다
+    if (desc->ready && !desc->ready(&st.eng)) {
+        pthread_mutex_unlock(&st.lock);
+        return -ENOENT;
+    }
+    set_mode(mode);
+    pthread_mutex_unlock(&st.lock);
+    return 0;
+}
+
+// 텍스트 한 줄: 모드 번호 (LED_MODE_BLINK ~ LED_MODE_MAX) 또는 inject 명령
+static ssize_t text_write(const char *data, size_t avail) {
+    char input[LED_TEXT_MAX];
+    struct led_text t;
+    ssize_t len;
+    int ret;
+
+    len = led_text_line(data, avail, input, sizeof(input));
+    if (len < 0) {
+        return len;
+    }
+    ret = led_text_parse(input, &t);
+    if (ret < 0) {
+        return ret;
+    }
+    switch (t.kind) {
+    case LED_TEXT_CMD:
+        ret = strcmp(t.cmd, "inject") == 0 ? inject(t.arg) : -EOPNOTSUPP;
+        break;
+    case LED_TEXT_MODE:
+        ret = mode_write(t.mode);
+        break;
+    default:
+        ret = 0;
+        break;
+    }
+    return ret < 0 ? ret : len;
+}
+
+static ssize_t record_write(struct session *sess, const char *data, size_t avail) {
+    switch (led_rec_type(data, avail)) {
+    case LED_REC_PROGRAM:
+        return program_write(data, avail);
+    case LED_REC_REQ:
+        return session_write(sess, data, avail);
+    default:
+        return text_write(data, avail);
+    }
+}
+
+// 앞쪽 레코드가 처리된 뒤 실패하면 처리한 길이만 돌려준다. LED_WRITE_MAX 를 넘으면
+// 그 안에서 끝나는 레코드까지만 처리한다 (dev_write_iter 와 같음)
+static ssize_t dev_write(struct session *sess, const char *data, size_t len) {
+    bool cut = len > LED_WRITE_MAX;
+    size_t done = 0;
+    ssize_t ret = 0;
+
+    if (cut) {
+        len = LED_WRITE_MAX;
+    }
+    while (done < len) {
+        if (cut && done > 0 && !led_rec_complete(data + done, len - done)) {
+            break;
+        }
+        ret = record_write(sess, data + done, len - done);
+        if (ret <= 0) {
+            break;
+        }
+        done += ret;
+    }
+    return done ? (ssize_t)done : ret;
+}
+
+static struct session *session_open(void) {
+    struct session *sess = calloc(1, sizeof(*sess));
+
+    if (!sess) {
+        return NULL;
+    }
+    pthread_mutex_lock(&st.lock);
+    sess->prev = st.tail;
+    if (st.tail) {
+        st.tail->next = sess;
+    } else {
+        st.head = sess;
+    }
+    st.tail = sess;
+    st.opens++;
+    pthread_mutex_unlock(&st.lock);
+    return sess;
+}
+
+// 닫으면 잡고 있던 LED 를 돌려준다
+static void session_close(struct session *sess) {
+    pthread_mutex_lock(&st.lock);
+    if (sess->prev) {
+        sess->prev->next = sess->next;
+    } else {
+        st.head = sess->next;
+    }
+    if (sess->next) {
+        sess->next->prev = sess->prev;
+    } else {
+        st.tail = sess->prev;
+    }
+    if (sess->own.claim) {
+        arbitrate();
+        output_commit();
+    }
+    pthread_mutex_unlock(&st.lock);
+    free(sess);
+}
+
+static void reply(int fd, uint64_t unique, int error, const void *data, size_t len) {
+    struct fuse_out_header out = {
+        .len = sizeof(out) + (error ? 0 : len),
+        .error = error,
+        .unique = unique,
+    };
+    struct iovec iov[2] = {
+        { &out, sizeof(out) },
+        { (void *)data, len },
+    };
+
+    if (error) {
+        __atomic_fetch_add(&st.errors, 1, __ATOMIC_RELAXED);
+    }
+    // 요청이 그사이 중단됐으면 ENOENT, 무시한다
+    if (writev(fd, iov, error || !len ? 1 : 2) < 0 && errno != ENOENT) {
+        perror("cuse reply");
+    }
+}
+
+// 요청 하나 처리
+static void handle(int fd, const char *buf, size_t len) {
+    const struct fuse_in_header *in = (const void *)buf;
+    const char *arg = buf + sizeof(*in);
+    ssize_t ret;
+
+    if (len < sizeof(*in)) {
+        return;
+    }
+
+    switch (in->opcode) {
+    case FUSE_OPEN: {
+        struct fuse_open_out out = { .open_flags = FOPEN_DIRECT_IO | FOPEN_NONSEEKABLE };
+        struct session *sess = session_open();
+
+        if (!sess) {
+            reply(fd, in->unique, -ENOMEM, NULL, 0);
+            break;
+        }
+        out.fh = (uintptr_t)sess;
+        reply(fd, in->unique, 0, &out, sizeof(out));
+        break;
+    }
+    case FUSE_RELEASE: {
+        const struct fuse_release_in *rel = (const void *)arg;
+
+        session_close((struct session *)(uintptr_t)rel->fh);
+        reply(fd, in->unique, 0, NULL, 0);
+        break;
+    }
+    // 읽을 때마다 현재 모드 한 줄
+    case FUSE_READ: {
+        const struct fuse_read_in *rd = (const void *)arg;
+        char text[16];
+        int n;
+
+        n = snprintf(text, sizeof(text), "%d\n", __atomic_load_n(&st.eng.mode, __ATOMIC_RELAXED));
+        if ((uint32_t)n > rd->size) {
+            n = rd->size;
+        }
+        __atomic_fetch_add(&st.reads, 1, __ATOMIC_RELAXED);
+        reply(fd, in->unique, 0, text, n);
+        break;
+    }
+    case FUSE_WRITE: {
+        const struct fuse_write_in *wr = (const void *)arg;
+        struct fuse_write_out out = { 0 };
+
+        if (len < sizeof(*in) + sizeof(*wr) + wr->size) {
+            reply(fd, in->unique, -EINVAL, NULL, 0);
+            break;
+        }
+        __atomic_fetch_add(&st.writes, 1, __ATOMIC_RELAXED);
+        ret = dev_write((struct session *)(uintptr_t)wr->fh, arg + sizeof(*wr), wr->size);
+        if (ret < 0) {
+            reply(fd, in->unique, ret, NULL, 0);
+            break;
+        }
+        out.size = ret;
+        reply(fd, in->unique, 0, &out, sizeof(out));
+        break;
+    }
+    // 드라이버처럼 항상 읽고 쓸 수 있다
+    case FUSE_POLL: {
+        const struct fuse_poll_in *pin = (const void *)arg;
+        struct fuse_poll_out out = {
+            .revents = pin->events & (POLLIN | POLLRDNORM | POLLOUT | POLLWRNORM),
+        };
+
+        reply(fd, in->unique, 0, &out, sizeof(out));
+        break;
+    }
+    case FUSE_FLUSH:
+    case FUSE_FSYNC:
+        reply(fd, in->unique, 0, NULL, 0);
+        break;
+    // 요청은 모두 바로 끝나므로 중단할 것이 없다 (응답도 하지 않는다)
+    case FUSE_INTERRUPT:
+        break;
+    case FUSE_IOCTL:
+        reply(fd, in->unique, -ENOTTY, NULL, 0);
+        break;
+    default:
+        reply(fd, in->unique, -ENOSYS, NULL, 0);
+        break;
+    }
+}
+
+static void *request_thread(void *arg) {
+    char *buf = malloc(REQ_BUF_SIZE);
+    ssize_t len;
+
+    if (!buf) {
+        perror("malloc");
+        exit(1);
+    }
+    for (;;) {
+        len = read(cuse_fd, buf, REQ_BUF_SIZE);
+        if (len < 0) {
+            // ENOENT: 읽기 전에 중단된 요청
+            if (errno == EINTR || errno == ENOENT || errno == EAGAIN) {
+                continue;
+            }
+            if (errno != ENODEV) {
+                perror("read " CUSE_DEV);
+            }
+            exit(1);
+        }
+        handle(cuse_fd, buf, len);
+    }
+    return NULL;
+}
+
+// CUSE_INIT 에 장치 이름과 최대 write 크기로 답한다
+static int cuse_init(int fd, const char *devname) {
+    char buf[REQ_BUF_SIZE], info[128];
+    const struct fuse_in_header *in = (const void *)buf;
+    const struct cuse_init_in *init = (const void *)(buf + sizeof(*in));
+    struct cuse_init_out out = {
+        .major = FUSE_KERNEL_VERSION,
+        .minor = FUSE_KERNEL_MINOR_VERSION,
+        .max_read = 4096,
+        .max_write = LED_WRITE_MAX,
+    };
+    struct fuse_out_header hdr;
+    struct iovec iov[3];
+    ssize_t len;
+    int n;
+
+    len = read(fd, buf, sizeof(buf));
+    if (len < (ssize_t)(sizeof(*in) + sizeof(*init)) || in->opcode != CUSE_INIT) {
+        fprintf(stderr, "unexpected first request from " CUSE_DEV "\n");
+        return -1;
+    }
+    if (init->major != FUSE_KERNEL_VERSION) {
+        fprintf(stderr, "unsupported fuse protocol %u.%u\n", init->major, init->minor);
+        return -1;
+    }
+
+    n = snprintf(info, sizeof(info), "DEVNAME=%s", devname) + 1;
+    hdr.len = sizeof(hdr) + sizeof(out) + n;
+    hdr.error = 0;
+    hdr.unique = in->unique;
+    iov[0] = (struct iovec){ &hdr, sizeof(hdr) };
+    iov[1] = (struct iovec){ &out, sizeof(out) };
+    iov[2] = (struct iovec){ info, n };
+    if (writev(fd, iov, 3) != (ssize_t)hdr.len) {
+        perror("cuse init");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *devname = "led_control", *timeline = NULL;
+    pthread_t threads[MAX_THREADS], engine;
+    pthread_condattr_t cattr;
+    double period_ms = 2000;
+    int nthreads = 4, opt, sig, i;
+    sigset_t sigs;
+
+    while ((opt = getopt(argc, argv, "n:t:p:l:v")) != -1) {
+        switch (opt) {
+        case 'n':
+            devname = optarg;
+            break;
+        case 't':
+            nthreads = atoi(optarg);
+            break;
+        case 'p':
+            period_ms = atof(optarg);
+            break;
+        case 'l':
+            timeline = optarg;
+            break;
+        case 'v':
+            st.verbose = 1;
+            break;
+        default:
+            printf("Usage: %s [-n devname] [-t threads] [-p period_ms] [-l timeline] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (nthreads < 1 || nthreads > MAX_THREADS || period_ms < 1 || strlen(devname) > 64) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    if (timeline) {
+        st.timeline = fopen(timeline, "w");
+        if (!st.timeline) {
+            perror(timeline);
+            return 1;
+        }
+    }
+    led_engine_init(&st.eng, (uint64_t)(period_ms * 1e6), 256);
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&st.kick, &cattr);
+
+    cuse_fd = open(CUSE_DEV, O_RDWR | O_CLOEXEC);
+    if (cuse_fd < 0) {
+        perror(CUSE_DEV);
+        return 1;
+    }
+    if (cuse_init(cuse_fd, devname) < 0) {
+        return 1;
+    }
+    st.t0 = now_ns();
+
+    // 신호는 main 에서만 sigwait 로 받는다
+    sigemptyset(&sigs);
+    sigaddset(&sigs, SIGINT);
+    sigaddset(&sigs, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+
+    pthread_create(&engine, NULL, engine_thread, NULL);
+    for (i = 0; i < nthreads; i++) {
+        pthread_create(&threads[i], NULL, request_thread, NULL);
+    }
+    printf("/dev/%s ready (%d threads)\n", devname, nthreads);
+    fflush(stdout);
+
+    sigwait(&sigs, &sig);
+
+    pthread_mutex_lock(&st.lock);
+    printf("opens %llu, reads %llu, writes %llu, errors %llu, ticks %llu, output changes %llu\n",
+           (unsigned long long)st.opens, (unsigned long long)st.reads, (unsigned long long)st.writes,
+           (unsigned long long)st.errors, (unsigned long long)st.ticks, (unsigned long long)st.changes);
+    if (st.timeline) {
+        fclose(st.timeline);
+    }
+    // 요청 스레드는 /dev/cuse read 에 묶여 있으므로 join 하지 않고 끝낸다
+    return 0;
+}
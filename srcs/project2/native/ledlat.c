@@ -0,0 +1,334 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ledctl.h"
+
+// 스위치 -> LED 종단 지연 측정 (gpio-sim 루프백, root)
+//   ledlat -c <gpio-sim chip 디렉터리> [-s sw 첫 offset] [-l led 첫 offset] [-n 샘플] [-m modes]
+//          [-o text|csv] [-t timeout_ms] [-g p99 한계 us]
+// 시간 초과가 있거나 -g 로 준 p99 한계를 넘는 모드가 있으면 1 로 끝난다 (회귀 검사용).
+// ledlat.sh 가 gpio-sim 칩을 만들고 그 위에 드라이버를 올린 뒤 이 프로그램을 부른다.
+//
+// sw[] 줄은 sim_gpioN/pull 로 엣지를 넣고, led[] 줄은 sim_gpioN/value 를 바쁜 대기로 읽는다.
+// (led[] 는 드라이버가 잡고 있어 GPIO chardev 로는 요청할 수 없다)
+// 시간은 제스처가 완성되는 엣지(떼기) 직전부터 LED 값이 바뀐 것을 본 때까지.
+//   manual : 수동 모드에서 SW[i] 누름 -> LED[i] 토글
+//   blink  : 리셋 상태에서 SW0 누름 -> 전체 모드 첫 tick (엔진 주기 1ms 포함)
+//   seq    : 리셋 상태에서 SW1 누름 -> 순차 모드 첫 tick (엔진 주기 1ms 포함)
+
+#define PARAM_DIR "/sys/module/led_control/parameters/"
+#define PERIOD_PATH "/sys/kernel/led_control/period_ns"
+#define MODE_COUNT 3
+
+static const char *const mode_names[MODE_COUNT] = { "manual", "blink", "seq" };
+
+static int pull_fd[SW_NUM];
+static int value_fd[LED_NUM];
+static long timeout_ns = 200000000;
+static unsigned gap_ms;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void sleep_ms(unsigned ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+
+    nanosleep(&ts, NULL);
+}
+
+static int open_line(const char *chip, int offset, const char *attr, int flags) {
+    char path[256];
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/sim_gpio%d/%s", chip, offset, attr);
+    fd = open(path, flags);
+    if (fd < 0) {
+        perror(path);
+    }
+    return fd;
+}
+
+// 읽은 값을 돌려준다. 실패하면 NULL
+static char *read_file(const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY);
+    ssize_t len;
+
+    if (fd < 0) {
+        return NULL;
+    }
+    len = read(fd, buf, size - 1);
+    close(fd);
+    if (len < 0) {
+        return NULL;
+    }
+    buf[len] = '\0';
+    return buf;
+}
+
+static int write_file(const char *path, const char *value) {
+    int fd = open(path, O_WRONLY);
+    int ret;
+
+    if (fd < 0) {
+        return -1;
+    }
+    ret = write(fd, value, strlen(value)) < 0 ? -1 : 0;
+    close(fd);
+    return ret;
+}
+
+static int set_switch(int i, int pressed) {
+    const char *v = pressed ? "pull-up" : "pull-down";
+
+    return pwrite(pull_fd[i], v, strlen(v), 0) < 0 ? -1 : 0;
+}
+
+static int read_leds(void) {
+    char v[4];
+    int mask = 0, i;
+
+    for (i = 0; i < LED_NUM; i++) {
+        if (pread(value_fd[i], v, sizeof(v), 0) <= 0) {
+            return -1;
+        }
+        if (v[0] == '1') {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+// 누르고 디바운스 뒤에 떼면서 시각을 찍고, want 비트가 base 와 달라질 때까지 기다린다.
+// 지연(ns)을 돌려주고, 시간 초과면 -1
+static long long measure(int sw, int base, int want) {
+    uint64_t t0, t;
+    int mask;
+
+    if (set_switch(sw, 1) < 0) {
+        return -1;
+    }
+    sleep_ms(gap_ms);
+    t0 = now_ns();
+    if (set_switch(sw, 0) < 0) {
+        return -1;
+    }
+    do {
+        mask = read_leds();
+        t = now_ns();
+        if (mask >= 0 && ((mask ^ base) & want)) {
+            sleep_ms(gap_ms);
+            return t - t0;
+        }
+    } while (t - t0 < (uint64_t)timeout_ns);
+    sleep_ms(gap_ms);
+    return -1;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(const long long *v, int n, double q) {
+    int k = (int)(q * n + 0.5);
+
+    if (k < 1) {
+        k = 1;
+    }
+    return v[(k > n ? n : k) - 1];
+}
+
+// 출력하고 p99 를 돌려준다
+static double report(const char *format, const char *name, long long *v, int n, int timeouts) {
+    double sum = 0;
+    int i;
+
+    if (n == 0) {
+        if (strcmp(format, "csv") == 0) {
+            printf("%s,0,%d,,,,,\n", name, timeouts);
+        } else {
+            printf("%-7s no samples (%d timeouts)\n", name, timeouts);
+        }
+        return 0;
+    }
+    qsort(v, n, sizeof(*v), cmp_ll);
+    for (i = 0; i < n; i++) {
+        sum += v[i];
+    }
+    if (strcmp(format, "csv") == 0) {
+        printf("%s,%d,%d,%lld,%.0f,%.0f,%.0f,%lld\n", name, n, timeouts, v[0], percentile(v, n, 0.5),
+               percentile(v, n, 0.99), sum / n, v[n - 1]);
+    } else {
+        printf("%-7s %6d %8d %9.1fus %9.1fus %9.1fus %9.1fus %9.1fus\n", name, n, timeouts, v[0] / 1e3,
+               percentile(v, n, 0.5) / 1e3, percentile(v, n, 0.99) / 1e3, sum / n / 1e3, v[n - 1] / 1e3);
+    }
+    return percentile(v, n, 0.99);
+}
+
+static int run_mode(struct ledctl *c, int m, int samples, long long *v, int *timeouts) {
+    long long lat;
+    int n = 0, i, k, base;
+
+    *timeouts = 0;
+    for (i = 0; i < samples; i++) {
+        if (m == 0) {
+            if (i == 0 && ledctl_set_mode(c, LED_MODE_MANUAL) < 0) {
+                return -1;
+            }
+            k = i % LED_NUM;
+            base = read_leds();
+            lat = measure(k, base, 1 << k);
+        } else {
+            // 매번 리셋에서 출발해 첫 tick 이 LED 를 바꾸는 것을 본다
+            if (ledctl_set_mode(c, LED_MODE_RESET) < 0) {
+                return -1;
+            }
+            sleep_ms(gap_ms);
+            lat = measure(m == 1 ? 0 : 1, 0, LED_MASK_ALL);
+        }
+        if (lat < 0) {
+            (*timeouts)++;
+        } else {
+            v[n++] = lat;
+        }
+    }
+    return n;
+}
+
+int main(int argc, char *argv[]) {
+    const char *chip = NULL, *format = "text";
+    char modes[64] = "manual,blink,seq", *name;
+    char saved_debounce[32], saved_double[32], saved_period[32];
+    int sw_off = 0, led_off = LED_NUM, samples = 200, opt, i, n, m, timeouts, ret = 0;
+    unsigned debounce;
+    double limit_us = 0;
+    struct ledctl *c;
+    long long *v;
+
+    while ((opt = getopt(argc, argv, "c:s:l:n:m:o:t:g:")) != -1) {
+        switch (opt) {
+        case 'c':
+            chip = optarg;
+            break;
+        case 's':
+            sw_off = atoi(optarg);
+            break;
+        case 'l':
+            led_off = atoi(optarg);
+            break;
+        case 'n':
+            samples = atoi(optarg);
+            break;
+        case 'm':
+            snprintf(modes, sizeof(modes), "%s", optarg);
+            break;
+        case 'o':
+            format = optarg;
+            break;
+        case 't':
+            timeout_ns = atol(optarg) * 1000000L;
+            break;
+        case 'g':
+            limit_us = atof(optarg);
+            break;
+        default:
+            chip = NULL;
+            samples = 0;
+            break;
+        }
+    }
+    if (!chip || samples < 1) {
+        printf("Usage: %s -c <gpio-sim chip dir> [-s sw offset] [-l led offset] [-n samples] "
+               "[-m manual,blink,seq] [-o text|csv] [-t timeout_ms] [-g p99_limit_us]\n", argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < SW_NUM; i++) {
+        pull_fd[i] = open_line(chip, sw_off + i, "pull", O_WRONLY);
+        if (pull_fd[i] < 0) {
+            return 1;
+        }
+    }
+    for (i = 0; i < LED_NUM; i++) {
+        value_fd[i] = open_line(chip, led_off + i, "value", O_RDONLY);
+        if (value_fd[i] < 0) {
+            return 1;
+        }
+    }
+    c = ledctl_open(NULL, 0);
+    if (!c) {
+        perror("Failed to open the device");
+        return 1;
+    }
+
+    // 떼는 즉시 PRESS 로 인식하도록 double press 를 끄고, 엔진 주기는 최소로.
+    // 디바운스는 그대로 두고 엣지 간격을 그보다 길게 잡는다.
+    if (!read_file(PARAM_DIR "debounce_ms", saved_debounce, sizeof(saved_debounce)) ||
+        !read_file(PARAM_DIR "double_press_ms", saved_double, sizeof(saved_double)) ||
+        !read_file(PERIOD_PATH, saved_period, sizeof(saved_period))) {
+        fprintf(stderr, "led_control parameters not found (module loaded?)\n");
+        return 1;
+    }
+    debounce = atoi(saved_debounce);
+    gap_ms = debounce + 5;
+    if (write_file(PARAM_DIR "double_press_ms", "0") < 0 || write_file(PERIOD_PATH, "1000000") < 0) {
+        perror("set driver parameters");
+        return 1;
+    }
+
+    v = malloc(sizeof(*v) * samples);
+    if (!v) {
+        perror("malloc");
+        return 1;
+    }
+    if (strcmp(format, "csv") == 0) {
+        printf("mode,samples,timeouts,min_ns,p50_ns,p99_ns,mean_ns,max_ns\n");
+    } else {
+        printf("switch -> LED latency, %d samples per mode, debounce %ums\n", samples, debounce);
+        printf("%-7s %6s %8s %11s %11s %11s %11s %11s\n", "mode", "n", "timeouts", "min", "p50", "p99", "mean",
+               "max");
+    }
+    for (name = strtok(modes, ","); name; name = strtok(NULL, ",")) {
+        for (m = 0; m < MODE_COUNT; m++) {
+            if (strcmp(name, mode_names[m]) == 0) {
+                break;
+            }
+        }
+        if (m == MODE_COUNT) {
+            fprintf(stderr, "unknown mode %s\n", name);
+            ret = 1;
+            continue;
+        }
+        n = run_mode(c, m, samples, v, &timeouts);
+        if (n < 0) {
+            perror(name);
+            ret = 1;
+            continue;
+        }
+        if (report(format, name, v, n, timeouts) > limit_us * 1e3 && limit_us > 0) {
+            fprintf(stderr, "%s: p99 over %.1fus\n", name, limit_us);
+            ret = 1;
+        }
+        if (timeouts) {
+            ret = 1;
+        }
+    }
+
+    // 원래 값으로 되돌린다
+    ledctl_set_mode(c, LED_MODE_RESET);
+    write_file(PARAM_DIR "double_press_ms", saved_double);
+    write_file(PERIOD_PATH, saved_period);
+    ledctl_close(c);
+    free(v);
+    return ret;
+}
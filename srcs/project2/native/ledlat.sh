@@ -0,0 +1,58 @@
+#!/bin/sh
+# gpio-sim 칩(8 줄: 0-3 스위치, 4-7 LED)을 만들고 그 위에 led_control 을 올려
+# ledlat 로 스위치 -> LED 지연을 잰다. 라즈베리파이 없이 돌아간다. (root, CONFIG_GPIO_SIM)
+#   ./ledlat.sh [ledlat 옵션...]      예: ./ledlat.sh -n 500 -g 2000
+set -e
+
+CFS=/sys/kernel/config/gpio-sim
+SIM=$CFS/led_control_lat
+MODULE=${MODULE:-../module/led_control.ko}
+
+cleanup() {
+    rmmod led_control 2>/dev/null || true
+    if [ -d "$SIM" ]; then
+        echo 0 > "$SIM/live" || true
+        rmdir "$SIM/bank0" "$SIM" || true
+    fi
+}
+trap cleanup EXIT
+
+modprobe gpio-sim
+mountpoint -q /sys/kernel/config || mount -t configfs none /sys/kernel/config
+
+mkdir "$SIM" "$SIM/bank0"
+echo 8 > "$SIM/bank0/num_lines"
+echo 1 > "$SIM/live"
+dev=$(cat "$SIM/dev_name")
+chip=$(cat "$SIM/bank0/chip_name")
+
+# 드라이버는 전역 GPIO 번호를 쓰므로 칩의 base 를 찾는다
+base=
+for d in /sys/class/gpio/gpiochip*; do
+    if [ "$(basename "$(readlink -f "$d/device")")" = "$chip" ]; then
+        base=$(cat "$d/base")
+    fi
+done
+if [ -z "$base" ] && [ -r /sys/kernel/debug/gpio ]; then
+    base=$(sed -n "s/^$chip: GPIOs \([0-9]*\)-.*/\1/p" /sys/kernel/debug/gpio)
+fi
+if [ -z "$base" ]; then
+    echo "cannot find the GPIO base of $chip (needs CONFIG_GPIO_SYSFS or debugfs)" >&2
+    exit 1
+fi
+
+insmod "$MODULE" \
+    sw=$base,$((base + 1)),$((base + 2)),$((base + 3)) \
+    led=$((base + 4)),$((base + 5)),$((base + 6)),$((base + 7))
+
+# gpio-sim 은 읽고 쓸 때 잠들 수 있는 칩이다. 원자 context 에서 건드리면 경고가 찍히고
+# 그때 잰 지연은 믿을 수 없으므로 측정 중 커널 로그에 그런 경고가 있으면 실패로 본다
+klog_start=$(dmesg | wc -l)
+status=0
+./ledlat -c "/sys/devices/platform/$dev/$chip" -s 0 -l 4 "$@" || status=$?
+if dmesg | tail -n +$((klog_start + 1)) |
+        grep -E "sleeping function called from invalid context|WARNING: .*gpiolib"; then
+    echo "kernel warned about GPIO access from atomic context during the run" >&2
+    status=1
+fi
+exit $status
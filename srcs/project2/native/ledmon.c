@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/genetlink.h>
+#include <linux/netlink.h>
+
+#include "led_uapi.h"
+
+// led_control generic netlink 채널 클라이언트 (libnl 없이 raw netlink)
+//   ledmon              : events 그룹에 가입해 이벤트/통계 방송 출력
+//   ledmon get          : 현재 상태
+//   ledmon exec <명령>  : dev_write 텍스트 명령과 같은 문법 (root)
+
+#define BUF_SIZE 8192
+
+struct nl_req {
+    struct nlmsghdr nlh;
+    struct genlmsghdr genl;
+    char attrs[256];
+};
+
+static int family_id;
+static int mcgrp_id = -1;
+static unsigned int seq;
+
+static struct nlattr *next_attr(struct nlattr *na) {
+    return (struct nlattr *)((char *)na + NLA_ALIGN(na->nla_len));
+}
+
+#define for_each_attr(na, start, len) \
+    for (na = (struct nlattr *)(start); \
+         (char *)na + NLA_HDRLEN <= (char *)(start) + (len) && na->nla_len >= NLA_HDRLEN; \
+         na = next_attr(na))
+
+#define attr_data(na) ((void *)((char *)(na) + NLA_HDRLEN))
+#define attr_len(na)  ((int)(na)->nla_len - NLA_HDRLEN)
+
+static void put_attr(struct nl_req *req, int type, const void *data, int len) {
+    struct nlattr *na = (struct nlattr *)((char *)req + NLMSG_ALIGN(req->nlh.nlmsg_len));
+
+    na->nla_type = type;
+    na->nla_len = NLA_HDRLEN + len;
+    memcpy(attr_data(na), data, len);
+    req->nlh.nlmsg_len = NLMSG_ALIGN(req->nlh.nlmsg_len) + NLA_ALIGN(na->nla_len);
+}
+
+static void init_req(struct nl_req *req, int type, int cmd, int version) {
+    memset(req, 0, sizeof(*req));
+    req->nlh.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+    req->nlh.nlmsg_type = type;
+    req->nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    req->nlh.nlmsg_seq = ++seq;
+    req->genl.cmd = cmd;
+    req->genl.version = version;
+}
+
+static int send_req(int fd, struct nl_req *req) {
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+
+    return sendto(fd, req, req->nlh.nlmsg_len, 0, (struct sockaddr *)&addr, sizeof(addr)) < 0 ? -1 : 0;
+}
+
+// 응답 하나를 받아 genl payload 를 넘긴다. ACK(오류 0) 이면 0, 오류면 -1
+static int recv_reply(int fd, char *buf, struct nlmsghdr **out) {
+    struct nlmsghdr *nlh;
+    int len;
+
+    len = recv(fd, buf, BUF_SIZE, 0);
+    if (len < 0) {
+        perror("recv");
+        return -1;
+    }
+    nlh = (struct nlmsghdr *)buf;
+    if (!NLMSG_OK(nlh, len)) {
+        return -1;
+    }
+    if (nlh->nlmsg_type == NLMSG_ERROR) {
+        struct nlmsgerr *err = NLMSG_DATA(nlh);
+
+        if (err->error) {
+            fprintf(stderr, "netlink error: %s\n", strerror(-err->error));
+            return -1;
+        }
+        *out = NULL;
+        return 0;
+    }
+    *out = nlh;
+    return 1;
+}
+
+// family id 와 events 그룹 id 조회
+static int resolve_family(int fd) {
+    char buf[BUF_SIZE];
+    struct nl_req req;
+    struct nlmsghdr *nlh;
+    struct nlattr *na, *grp, *ga;
+
+    init_req(&req, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 1);
+    put_attr(&req, CTRL_ATTR_FAMILY_NAME, LED_GENL_NAME, strlen(LED_GENL_NAME) + 1);
+    if (send_req(fd, &req) < 0 || recv_reply(fd, buf, &nlh) <= 0) {
+        fprintf(stderr, "generic netlink family %s not found (module loaded?)\n", LED_GENL_NAME);
+        return -1;
+    }
+
+    for_each_attr(na, (char *)NLMSG_DATA(nlh) + GENL_HDRLEN, nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN)) {
+        if (na->nla_type == CTRL_ATTR_FAMILY_ID) {
+            family_id = *(__u16 *)attr_data(na);
+        } else if (na->nla_type == CTRL_ATTR_MCAST_GROUPS) {
+            for_each_attr(grp, attr_data(na), attr_len(na)) {
+                const char *name = NULL;
+                int id = -1;
+
+                for_each_attr(ga, attr_data(grp), attr_len(grp)) {
+                    if (ga->nla_type == CTRL_ATTR_MCAST_GRP_NAME) {
+                        name = attr_data(ga);
+                    } else if (ga->nla_type == CTRL_ATTR_MCAST_GRP_ID) {
+                        id = *(__u32 *)attr_data(ga);
+                    }
+                }
+                if (name && strcmp(name, LED_GENL_MCGRP) == 0) {
+                    mcgrp_id = id;
+                }
+            }
+        }
+    }
+    // ACK 정리
+    recv_reply(fd, buf, &nlh);
+    return family_id ? 0 : -1;
+}
+
+static void print_event(const struct led_event *ev) {
+    static const char *const names[] = {
+        [LED_EV_GESTURE] = "gesture", [LED_EV_MODE] = "mode", [LED_EV_OVERRUN] = "overrun",
+        [LED_EV_PROGRAM] = "program", [LED_EV_PATTERN] = "pattern", [LED_EV_SYNC] = "sync",
+        [LED_EV_SWITCH] = "switch", [LED_EV_LAYER] = "layer", [LED_EV_INPUT_MODE] = "in_mode",
+        [LED_EV_INPUT_SESSION] = "in_sess", [LED_EV_INPUT_REQ] = "in_req", [LED_EV_INPUT_MASK] = "in_mask",
+    };
+    const char *name = ev->type < sizeof(names) / sizeof(names[0]) && names[ev->type] ? names[ev->type] : "?";
+
+    printf("%llu.%09llu %-8s code=%u value=%d\n", (unsigned long long)ev->timestamp_ns / 1000000000,
+           (unsigned long long)ev->timestamp_ns % 1000000000, name, ev->code, (int)ev->value);
+}
+
+static int do_listen(int fd) {
+    char buf[BUF_SIZE];
+    struct nlmsghdr *nlh;
+    struct genlmsghdr *genl;
+    struct nlattr *na;
+    int len;
+
+    if (mcgrp_id < 0 || setsockopt(fd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP, &mcgrp_id, sizeof(mcgrp_id)) < 0) {
+        perror("join multicast group");
+        return 1;
+    }
+
+    while ((len = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        for (nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+            genl = NLMSG_DATA(nlh);
+            for_each_attr(na, (char *)genl + GENL_HDRLEN, nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN)) {
+                if (na->nla_type == LED_A_EVENT && attr_len(na) >= (int)sizeof(struct led_event)) {
+                    print_event(attr_data(na));
+                } else if (na->nla_type == LED_A_STATS && attr_len(na) >= (int)sizeof(struct led_stats_delta)) {
+                    struct led_stats_delta *d = attr_data(na);
+
+                    printf("stats    interval=%lluns ticks=+%llu events=+%llu sync=+%llu max_late=%lluns sync_err=%lldns\n",
+                           (unsigned long long)d->interval_ns, (unsigned long long)d->ticks,
+                           (unsigned long long)d->events, (unsigned long long)d->sync_samples,
+                           (unsigned long long)d->max_late_ns, (long long)d->sync_last_error_ns);
+                }
+            }
+        }
+        fflush(stdout);
+    }
+    perror("recv");
+    return 1;
+}
+
+static int do_get(int fd) {
+    char buf[BUF_SIZE];
+    struct nl_req req;
+    struct nlmsghdr *nlh;
+    struct nlattr *na;
+
+    init_req(&req, family_id, LED_CMD_GET, LED_GENL_VERSION);
+    if (send_req(fd, &req) < 0 || recv_reply(fd, buf, &nlh) <= 0) {
+        return 1;
+    }
+    for_each_attr(na, (char *)NLMSG_DATA(nlh) + GENL_HDRLEN, nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN)) {
+        switch (na->nla_type) {
+        case LED_A_MODE:
+            printf("mode %u\n", *(__u32 *)attr_data(na));
+            break;
+        case LED_A_MASK:
+            printf("led_mask 0x%x\n", *(__u32 *)attr_data(na));
+            break;
+        case LED_A_PERIOD_NS:
+            printf("period_ns %llu\n", (unsigned long long)*(__u64 *)attr_data(na));
+            break;
+        case LED_A_BRIGHTNESS:
+            printf("brightness %u\n", *(__u32 *)attr_data(na));
+            break;
+        }
+    }
+    return 0;
+}
+
+static int do_exec(int fd, int argc, char *argv[]) {
+    char buf[BUF_SIZE], cmd[64] = "";
+    struct nl_req req;
+    struct nlmsghdr *nlh;
+    int i;
+
+    for (i = 0; i < argc; i++) {
+        if (strlen(cmd) + strlen(argv[i]) + 2 > sizeof(cmd)) {
+            fprintf(stderr, "command too long\n");
+            return 1;
+        }
+        if (i) {
+            strcat(cmd, " ");
+        }
+        strcat(cmd, argv[i]);
+    }
+
+    init_req(&req, family_id, LED_CMD_EXEC, LED_GENL_VERSION);
+    put_attr(&req, LED_A_COMMAND, cmd, strlen(cmd) + 1);
+    if (send_req(fd, &req) < 0 || recv_reply(fd, buf, &nlh) < 0) {
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+    int fd, ret;
+
+    fd = socket(AF_NETLINK, SOCK_RAW, NETLINK_GENERIC);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("netlink socket");
+        return 1;
+    }
+    if (resolve_family(fd) < 0) {
+        close(fd);
+        return 1;
+    }
+
+    if (argc < 2) {
+        ret = do_listen(fd);
+    } else if (strcmp(argv[1], "get") == 0) {
+        ret = do_get(fd);
+    } else if (strcmp(argv[1], "exec") == 0 && argc > 2) {
+        ret = do_exec(fd, argc - 2, argv + 2);
+    } else {
+        printf("Usage: %s [get | exec <command>]\n", argv[0]);
+        ret = 1;
+    }
+
+    close(fd);
+    return ret;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "led_uapi.h"
+
+// 텍스트 패턴 정의를 패턴 라이브러리 파일 형식으로 변환한다
+//   pattern <이름> <frame_ms> [loop]
+//   run <mask> <프레임 수>
+// 만든 파일은 /lib/firmware/led-patterns/<이름>.bin 에 둔다. default.bin 은 모듈 로드 때 읽히고,
+// 다른 이름은 "load <이름>" 으로 읽는다 (이름은 [A-Za-z0-9_-]).
+
+#define MAX_RUNS 4096
+
+struct pattern {
+    struct led_pat_header hdr;
+    struct led_pat_run runs[MAX_RUNS];
+};
+
+static struct pattern patterns[LED_PAT_MAX];
+
+static __u32 crc32(const unsigned char *buf, size_t len) {
+    __u32 crc = ~0u;
+    size_t i;
+    int k;
+
+    for (i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xedb88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static int add_run(struct pattern *pat, long mask, long count) {
+    while (count > 0) {
+        long n = count > 255 ? 255 : count;
+
+        if (pat->hdr.runs == MAX_RUNS) {
+            return -1;
+        }
+        pat->runs[pat->hdr.runs].count = n;
+        pat->runs[pat->hdr.runs].mask = mask;
+        pat->hdr.runs++;
+        count -= n;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    struct led_pat_file_header fh = { LED_PAT_MAGIC, LED_PAT_VERSION, 0 };
+    struct pattern *pat = NULL;
+    char line[128], name[LED_PAT_NAME_LEN + 1], opt[16];
+    unsigned char *buf;
+    size_t len = 0;
+    long a, b;
+    int lineno = 0, i;
+    FILE *in, *out;
+    __u32 crc;
+
+    if (argc != 3) {
+        printf("Usage: %s <patterns.txt> <default.bin>\n", argv[0]);
+        return 1;
+    }
+
+    in = fopen(argv[1], "r");
+    if (in == NULL) {
+        perror("Failed to open input");
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), in)) {
+        lineno++;
+        if (line[0] == '#' || strspn(line, " \t\r\n") == strlen(line)) {
+            continue;
+        }
+
+        opt[0] = '\0';
+        if (sscanf(line, "pattern %16s %ld %15s", name, &a, opt) >= 2) {
+            if (fh.count == LED_PAT_MAX || a <= 0 || a > 0xffff) {
+                printf("%s:%d: too many patterns or bad frame_ms\n", argv[1], lineno);
+                return 1;
+            }
+            pat = &patterns[fh.count++];
+            strncpy(pat->hdr.name, name, LED_PAT_NAME_LEN - 1);
+            pat->hdr.frame_ms = a;
+            pat->hdr.flags = strcmp(opt, "loop") == 0 ? LED_PAT_LOOP : 0;
+        } else if (sscanf(line, "run %li %ld", &a, &b) == 2) {
+            if (pat == NULL || a < 0 || a >= (1 << LED_NUM) || b <= 0 || add_run(pat, a, b) < 0) {
+                printf("%s:%d: bad run\n", argv[1], lineno);
+                return 1;
+            }
+        } else {
+            printf("%s:%d: syntax error\n", argv[1], lineno);
+            return 1;
+        }
+    }
+    fclose(in);
+
+    if (fh.count == 0) {
+        printf("No patterns defined\n");
+        return 1;
+    }
+
+    buf = malloc(sizeof(fh) + fh.count * sizeof(struct pattern) + sizeof(crc));
+    if (buf == NULL) {
+        return 1;
+    }
+    memcpy(buf, &fh, sizeof(fh));
+    len = sizeof(fh);
+    for (i = 0; i < fh.count; i++) {
+        if (patterns[i].hdr.runs == 0) {
+            printf("Pattern %s has no frames\n", patterns[i].hdr.name);
+            return 1;
+        }
+        memcpy(buf + len, &patterns[i].hdr, sizeof(patterns[i].hdr));
+        len += sizeof(patterns[i].hdr);
+        memcpy(buf + len, patterns[i].runs, patterns[i].hdr.runs * sizeof(struct led_pat_run));
+        len += patterns[i].hdr.runs * sizeof(struct led_pat_run);
+    }
+    crc = crc32(buf, len);
+    memcpy(buf + len, &crc, sizeof(crc));
+    len += sizeof(crc);
+
+    out = fopen(argv[2], "wb");
+    if (out == NULL || fwrite(buf, 1, len, out) != len) {
+        perror("Failed to write output");
+        return 1;
+    }
+    fclose(out);
+    free(buf);
+
+    printf("%d patterns, %zu bytes\n", fh.count, len);
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "led_uapi.h"
+
+// 텍스트 어셈블리를 바이트코드로 바꿔 /dev/led_control 에 올린다
+// 한 줄에 명령 하나: <op> [a] [imm], '#' 뒤는 주석
+//   예) set 0x5 / wait 500 / jsw 0x1 4 / load 0 10 / djnz 0 2 / end
+
+struct op_desc {
+    const char *name;
+    int op;
+    int has_a;
+    int has_imm;
+};
+
+static const struct op_desc ops[] = {
+    {"end",    LED_OP_END,    0, 0},
+    {"set",    LED_OP_SET,    0, 1},
+    {"or",     LED_OP_OR,     0, 1},
+    {"and",    LED_OP_AND,    0, 1},
+    {"xor",    LED_OP_XOR,    0, 1},
+    {"wait",   LED_OP_WAIT,   0, 1},
+    {"waitsw", LED_OP_WAITSW, 1, 1},
+    {"jmp",    LED_OP_JMP,    0, 1},
+    {"jsw",    LED_OP_JSW,    1, 1},
+    {"jnsw",   LED_OP_JNSW,   1, 1},
+    {"load",   LED_OP_LOAD,   1, 1},
+    {"djnz",   LED_OP_DJNZ,   1, 1},
+    {"setr",   LED_OP_SETR,   1, 0},
+    {"add",    LED_OP_ADD,    1, 1},
+};
+
+static int assemble_line(char *line, __u32 *insn) {
+    char *tok, *end;
+    long a = 0, imm = 0;
+    size_t i;
+
+    end = strchr(line, '#');
+    if (end) {
+        *end = '\0';
+    }
+    tok = strtok(line, " \t\r\n");
+    if (!tok) {
+        return 0;
+    }
+
+    for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        if (strcasecmp(tok, ops[i].name) == 0) {
+            break;
+        }
+    }
+    if (i == sizeof(ops) / sizeof(ops[0])) {
+        return -1;
+    }
+
+    if (ops[i].has_a) {
+        tok = strtok(NULL, " \t\r\n");
+        if (!tok) {
+            return -1;
+        }
+        a = strtol(tok, NULL, 0);
+    }
+    if (ops[i].has_imm) {
+        tok = strtok(NULL, " \t\r\n");
+        if (!tok) {
+            return -1;
+        }
+        imm = strtol(tok, NULL, 0);
+    }
+
+    *insn = LED_VM_INSN(ops[i].op, a, imm);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    struct {
+        struct led_vm_header hdr;
+        __u32 insns[LED_VM_MAX_INSNS];
+    } prog;
+    char line[128];
+    int fd, lineno = 0, ret;
+    size_t len;
+    FILE *in;
+
+    if (argc < 2) {
+        printf("Usage: %s <program.s> [--run | -o <prog.bin>]\n", argv[0]);
+        return 1;
+    }
+
+    in = fopen(argv[1], "r");
+    if (in == NULL) {
+        perror("Failed to open program");
+        return 1;
+    }
+
+    memset(&prog, 0, sizeof(prog));
+    prog.hdr.magic = LED_VM_MAGIC;
+    prog.hdr.version = LED_VM_VERSION;
+    while (fgets(line, sizeof(line), in)) {
+        lineno++;
+        if (prog.hdr.count == LED_VM_MAX_INSNS) {
+            printf("%s:%d: program too long (max %d)\n", argv[1], lineno, LED_VM_MAX_INSNS);
+            fclose(in);
+            return 1;
+        }
+        ret = assemble_line(line, &prog.insns[prog.hdr.count]);
+        if (ret < 0) {
+            printf("%s:%d: syntax error\n", argv[1], lineno);
+            fclose(in);
+            return 1;
+        }
+        prog.hdr.count += ret;
+    }
+    fclose(in);
+    len = sizeof(prog.hdr) + prog.hdr.count * sizeof(__u32);
+
+    // -o: 장치 대신 파일로 (ledsim -b 로 시뮬레이션)
+    if (argc > 3 && strcmp(argv[2], "-o") == 0) {
+        FILE *out = fopen(argv[3], "wb");
+
+        if (out == NULL || fwrite(&prog, 1, len, out) != len || fclose(out) != 0) {
+            perror("Failed to write program");
+            return 1;
+        }
+        printf("Wrote %d instructions to %s\n", prog.hdr.count, argv[3]);
+        return 0;
+    }
+
+    fd = open(LED_DEVICE_PATH, O_WRONLY);
+    if (fd < 0) {
+        perror("Failed to open device");
+        return 1;
+    }
+
+    if (write(fd, &prog, len) < 0) {
+        perror("Program rejected");
+        close(fd);
+        return 1;
+    }
+    printf("Loaded %d instructions\n", prog.hdr.count);
+
+    if (argc > 2 && strcmp(argv[2], "--run") == 0) {
+        snprintf(line, sizeof(line), "%d", LED_MODE_PROGRAM);
+        if (write(fd, line, strlen(line)) < 0) {
+            perror("Failed");
+        }
+    }
+
+    close(fd);
+    return 0;
+}
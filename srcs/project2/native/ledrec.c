@@ -0,0 +1,229 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "led_uapi.h"
+#include "ledtrace.h"
+
+// /dev/led_events 를 받아 입력 trace 로 저장 (ledreplay 로 다시 돌린다)
+//   ledrec [-T sec] [-o trace.bin]
+// 스위치 엣지는 항상 기록된다. 명령 모드, led_mask, 세션 요청까지 남기려면 드라이버에
+//   echo 1 > /sys/module/led_control/parameters/trace_inputs
+// 이벤트 링(256 개)이 넘치면 빠진 입력이 있다는 경고를 낸다. Ctrl-C 로 끝낸다.
+
+#define TRACE_INPUTS_PARAM "/sys/module/led_control/parameters/trace_inputs"
+#define NO_SESS 0xffff
+
+static volatile int stop;
+static FILE *out;
+static uint64_t last_ns;
+static uint16_t sess_map[65536];     // 드라이버 세션 번호 -> trace 번호
+static uint8_t sess_used[LEDTRACE_SESSIONS_MAX];
+static long records, dropped, lost;
+
+static void on_signal(int sig) {
+    stop = 1;
+}
+
+static int trace_inputs_enabled(void) {
+    char c = 'N';
+    int fd = open(TRACE_INPUTS_PARAM, O_RDONLY);
+
+    if (fd < 0) {
+        return 0;
+    }
+    if (read(fd, &c, 1) != 1) {
+        c = 'N';
+    }
+    close(fd);
+    return c == 'Y' || c == '1';
+}
+
+static void put(uint64_t ts, int type, int sess, int op, int value) {
+    struct ledtrace_rec rec;
+    uint64_t dt_us;
+
+    dt_us = ts > last_ns ? (ts - last_ns) / 1000 : 0;
+    // 몫만 넘기고 나머지는 다음 record 에 넘긴다 (누적 오차 없음)
+    last_ns += dt_us * 1000;
+    while (dt_us > UINT32_MAX) {
+        memset(&rec, 0, sizeof(rec));
+        rec.dt_us = UINT32_MAX;
+        rec.type = LT_GAP;
+        fwrite(&rec, sizeof(rec), 1, out);
+        dt_us -= UINT32_MAX;
+    }
+    rec.dt_us = dt_us;
+    rec.type = type;
+    rec.sess = sess;
+    rec.op = op;
+    rec.value = value;
+    fwrite(&rec, sizeof(rec), 1, out);
+    records++;
+}
+
+// 녹화 전부터 열려 있던 세션은 처음 보는 순간 연 것으로 친다
+static int sess_lookup(uint64_t ts, uint16_t id, int open) {
+    int k;
+
+    if (sess_map[id] != NO_SESS) {
+        return sess_map[id];
+    }
+    for (k = 0; k < LEDTRACE_SESSIONS_MAX && sess_used[k]; k++) {
+    }
+    if (k == LEDTRACE_SESSIONS_MAX) {
+        return -1;
+    }
+    sess_used[k] = 1;
+    sess_map[id] = k;
+    if (!open) {
+        put(ts, LT_OPEN, k, 0, 0);
+    }
+    return k;
+}
+
+static void record_event(const struct led_event *ev) {
+    static int skip_mode = -2;  // 방금 기록한 명령이 낳은 모드 이벤트 (중복이라 건너뜀)
+    int k, expect = skip_mode;
+
+    skip_mode = -2;
+    switch (ev->type) {
+    case LED_EV_SWITCH:
+        put(ev->timestamp_ns, LT_SWITCH, 0, 0, ev->value);
+        break;
+    case LED_EV_INPUT_MODE:
+        put(ev->timestamp_ns, LT_MODE, 0, 0, (uint8_t)(int8_t)ev->value);
+        skip_mode = (int)ev->value;
+        break;
+    case LED_EV_INPUT_MASK:
+        put(ev->timestamp_ns, LT_MASK, 0, 0, ev->value);
+        skip_mode = LED_MODE_MANUAL;
+        break;
+    case LED_EV_MODE:
+        if ((int)ev->value != expect) {
+            put(ev->timestamp_ns, LT_OBS_MODE, 0, 0, (uint8_t)(int8_t)ev->value);
+        }
+        break;
+    case LED_EV_INPUT_SESSION:
+        k = sess_lookup(ev->timestamp_ns, ev->code, ev->value);
+        if (k < 0) {
+            dropped++;
+            break;
+        }
+        put(ev->timestamp_ns, ev->value ? LT_OPEN : LT_CLOSE, k, 0, 0);
+        if (!ev->value) {
+            sess_used[k] = 0;
+            sess_map[ev->code] = NO_SESS;
+        }
+        break;
+    case LED_EV_INPUT_REQ:
+        k = sess_lookup(ev->timestamp_ns, ev->code, 0);
+        if (k < 0) {
+            dropped++;
+            break;
+        }
+        put(ev->timestamp_ns, LT_REQ, k, ev->value >> 16, ev->value & 0xff);
+        break;
+    case LED_EV_OVERRUN:
+        lost += ev->value;
+        break;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    struct ledtrace_header hdr = { .magic = LEDTRACE_MAGIC, .version = LEDTRACE_VERSION };
+    struct led_event evs[64];
+    const char *path = NULL;
+    struct pollfd pfd;
+    struct timespec ts;
+    double duration = 0;
+    uint64_t end = 0;
+    ssize_t len;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "T:o:")) != -1) {
+        switch (opt) {
+        case 'T':
+            duration = atof(optarg);
+            break;
+        case 'o':
+            path = optarg;
+            break;
+        default:
+            printf("Usage: %s [-T sec] [-o trace.bin]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        path = "led_trace.bin";
+    }
+
+    pfd.fd = open(LED_EVENTS_PATH, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    pfd.events = POLLIN;
+    if (pfd.fd < 0) {
+        perror(LED_EVENTS_PATH);
+        return 1;
+    }
+    out = fopen(path, "wb");
+    if (!out) {
+        perror(path);
+        return 1;
+    }
+    if (trace_inputs_enabled()) {
+        hdr.flags |= LEDTRACE_F_INPUTS;
+    } else {
+        fprintf(stderr, "trace_inputs is off: only switch edges and mode changes are recorded\n");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    hdr.start_ns = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    if (duration > 0) {
+        end = hdr.start_ns + (uint64_t)(duration * 1e9);
+    }
+    // 첫 record 는 녹화 시작 시각 기준
+    last_ns = hdr.start_ns;
+    fwrite(&hdr, sizeof(hdr), 1, out);
+    memset(sess_map, 0xff, sizeof(sess_map));
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    while (!stop) {
+        if (end) {
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            if ((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec >= end) {
+                break;
+            }
+        }
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        len = read(pfd.fd, evs, sizeof(evs));
+        if (len < 0) {
+            if (errno == EAGAIN || errno == EINTR) {
+                continue;
+            }
+            perror("read " LED_EVENTS_PATH);
+            break;
+        }
+        for (i = 0; i < len / (ssize_t)sizeof(struct led_event); i++) {
+            record_event(&evs[i]);
+        }
+    }
+
+    fclose(out);
+    close(pfd.fd);
+    fprintf(stderr, "%ld records written to %s\n", records, path);
+    if (lost) {
+        fprintf(stderr, "warning: %ld events lost to ring overrun, the trace is incomplete\n", lost);
+    }
+    if (dropped) {
+        fprintf(stderr, "warning: %ld inputs dropped (more than %d sessions open)\n", dropped,
+                LEDTRACE_SESSIONS_MAX);
+    }
+    return lost || dropped ? 2 : 0;
+}
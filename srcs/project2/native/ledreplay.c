@@ -0,0 +1,409 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ledsim.h"
+#include "ledtrace.h"
+
+// ledrec 으로 녹화한 입력 trace 를 다시 넣고 LED 타임라인을 기록한다
+//   ledreplay [-x speed] [-d device | -s] [-l timeline] [-p period_ms] [-b prog.bin] [-v] trace.bin
+//   -x : 재생 속도 배율 (기본 1, 0 이면 기다리지 않고 바로바로)
+//   -d : 드라이버(또는 ledcuse 대역)에 넣는다 (기본 /dev/led_control)
+//        스위치는 "inject" 명령으로 넣으므로 allow_inject=1 이어야 한다
+//        타임라인은 sysfs led_mask 를 poll 해서 얻는다 (ledcuse 면 ledcuse -l 사용)
+//   -s : 드라이버 대신 시뮬레이터(libledsim)에서 가상 시간으로 돌린다. -x 는 무시
+//        제스처 인식은 없으므로 녹화된 모드 변화(LT_OBS_MODE)를 그대로 따라간다
+//   -l : "시각(ns) 마스크" 타임라인 파일 (기본 stdout)
+// 같은 trace 를 여러 번 돌려 타임라인을 비교하면 결정적인 부하 시험이 된다.
+
+#define LED_MASK_PATH "/sys/kernel/led_control/led_mask"
+
+struct trace {
+    struct ledtrace_header hdr;
+    struct ledtrace_rec *recs;
+    size_t n;
+};
+
+static FILE *timeline;
+static int verbose;
+static uint64_t replay_start;
+static volatile int replay_done;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int load_trace(const char *path, struct trace *t) {
+    size_t cap = 4096;
+    FILE *in;
+
+    in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+    if (fread(&t->hdr, sizeof(t->hdr), 1, in) != 1 || t->hdr.magic != LEDTRACE_MAGIC ||
+        t->hdr.version != LEDTRACE_VERSION) {
+        fprintf(stderr, "%s: not a version %d LED trace\n", path, LEDTRACE_VERSION);
+        fclose(in);
+        return -1;
+    }
+    t->n = 0;
+    t->recs = malloc(cap * sizeof(*t->recs));
+    while (t->recs) {
+        if (t->n == cap) {
+            cap *= 2;
+            t->recs = realloc(t->recs, cap * sizeof(*t->recs));
+            if (!t->recs) {
+                break;
+            }
+        }
+        if (fread(&t->recs[t->n], sizeof(*t->recs), 1, in) != 1) {
+            break;
+        }
+        t->n++;
+    }
+    fclose(in);
+    if (!t->recs) {
+        perror("malloc");
+        return -1;
+    }
+    return 0;
+}
+
+static void log_change(uint64_t t, uint32_t old, uint32_t mask) {
+    fprintf(timeline, "%llu %x\n", (unsigned long long)t, mask);
+    if (verbose) {
+        fprintf(stderr, "%12.3f ms  0x%x -> 0x%x\n", t / 1e6, old, mask);
+    }
+}
+
+// ---- 시뮬레이터 ----
+
+static void sim_trace(const struct ledsim *sim, uint32_t old, void *arg) {
+    log_change(sim->now, old, sim->gpio);
+}
+
+static int replay_sim(const struct trace *t, double period_ms, const char *prog) {
+    static struct ledsim sim;
+    char buf[sizeof(struct led_vm_header) + LED_VM_MAX_INSNS * sizeof(__u32)];
+    long skipped = 0, rejected = 0;
+    uint64_t at = 0;
+    size_t i, len;
+    FILE *in;
+    int mode, k;
+
+    ledsim_init(&sim, (uint64_t)(period_ms * 1e6), 256);
+    sim.trace = sim_trace;
+    if (prog) {
+        in = fopen(prog, "rb");
+        if (!in) {
+            perror(prog);
+            return 1;
+        }
+        len = fread(buf, 1, sizeof(buf), in);
+        fclose(in);
+        if (ledsim_load_program(&sim, buf, len) < 0) {
+            fprintf(stderr, "%s: program rejected\n", prog);
+            return 1;
+        }
+    }
+
+    for (i = 0; i < t->n; i++) {
+        const struct ledtrace_rec *r = &t->recs[i];
+
+        at += (uint64_t)r->dt_us * 1000;
+        ledsim_advance(&sim, at);
+        switch (r->type) {
+        case LT_SWITCH:
+            ledsim_set_switches(&sim, r->value);
+            break;
+        case LT_MODE:
+        case LT_OBS_MODE:
+            mode = (int8_t)r->value;
+            // 패턴 라이브러리는 trace 에 없고, 프로그램은 -b 로 준 것만 있다
+            if (mode == LED_MODE_PATTERN || (mode == LED_MODE_PROGRAM && !prog)) {
+                skipped++;
+                break;
+            }
+            ledsim_set_mode(&sim, mode);
+            break;
+        case LT_MASK:
+            ledsim_set_mask(&sim, r->value);
+            break;
+        case LT_OPEN:
+            ledsim_session_open(&sim, r->sess);
+            break;
+        case LT_CLOSE:
+            ledsim_session_close(&sim, r->sess);
+            break;
+        case LT_REQ:
+            if (ledsim_session_req(&sim, r->sess, r->op, r->value) < 0) {
+                rejected++;
+            }
+            break;
+        }
+    }
+
+    fprintf(stderr, "%zu records, %.3f s of trace simulated\n", t->n, at / 1e9);
+    for (k = 0; k < LED_NUM && at; k++) {
+        fprintf(stderr, "LED%d toggles %10llu  on %6.2f%%\n", k, (unsigned long long)sim.line[k].toggles,
+                100.0 * sim.line[k].on_ns / at);
+    }
+    if (skipped) {
+        fprintf(stderr, "%ld mode changes skipped (pattern, or program without -b)\n", skipped);
+    }
+    if (rejected) {
+        fprintf(stderr, "%ld requests rejected\n", rejected);
+    }
+    return 0;
+}
+
+// ---- 드라이버 ----
+
+static int read_mask(int fd, uint32_t *mask) {
+    char buf[32];
+    ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+
+    if (len <= 0) {
+        return -1;
+    }
+    buf[len] = '\0';
+    *mask = strtoul(buf, NULL, 0);
+    return 0;
+}
+
+// sysfs led_mask 는 값이 바뀌면 sysfs_notify 하므로 POLLPRI 로 기다린다
+static void *timeline_thread(void *arg) {
+    struct pollfd pfd = { .fd = *(int *)arg, .events = POLLPRI | POLLERR };
+    uint32_t mask, last;
+
+    if (read_mask(pfd.fd, &last) < 0) {
+        return NULL;
+    }
+    log_change(0, last, last);
+    while (!replay_done) {
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        if (read_mask(pfd.fd, &mask) == 0 && mask != last) {
+            log_change(now_ns() - replay_start, last, mask);
+            last = mask;
+        }
+    }
+    return NULL;
+}
+
+static int write_all(int fd, const void *buf, size_t len, const char *what) {
+    if (write(fd, buf, len) == (ssize_t)len) {
+        return 0;
+    }
+    fprintf(stderr, "%s: %s\n", what, strerror(errno));
+    return -1;
+}
+
+static int replay_device(const struct trace *t, const char *device, double speed) {
+    struct {
+        struct led_req_header hdr;
+        struct led_req reqs[LED_REQ_MAX];
+    } q;
+    int sess_fd[LEDTRACE_SESSIONS_MAX], ctl, mask_fd, ret = 0, len;
+    uint64_t at = 0, due, now, max_late = 0;
+    struct timespec ts;
+    pthread_t tl;
+    char line[32];
+    size_t i;
+
+    ctl = open(device, O_WRONLY | O_CLOEXEC);
+    if (ctl < 0) {
+        perror(device);
+        return 1;
+    }
+    for (i = 0; i < LEDTRACE_SESSIONS_MAX; i++) {
+        sess_fd[i] = -1;
+    }
+    mask_fd = open(LED_MASK_PATH, O_RDWR | O_CLOEXEC);
+    if (mask_fd < 0) {
+        mask_fd = open(LED_MASK_PATH, O_RDONLY | O_CLOEXEC);
+    }
+    if (mask_fd < 0) {
+        fprintf(stderr, "no " LED_MASK_PATH ": LED timeline is not recorded\n");
+    }
+
+    replay_start = now_ns();
+    if (mask_fd >= 0) {
+        pthread_create(&tl, NULL, timeline_thread, &mask_fd);
+    }
+
+    for (i = 0; i < t->n && ret == 0; i++) {
+        const struct ledtrace_rec *r = &t->recs[i];
+
+        at += (uint64_t)r->dt_us * 1000;
+        if (speed > 0) {
+            due = replay_start + (uint64_t)(at / speed);
+            ts.tv_sec = due / 1000000000;
+            ts.tv_nsec = due % 1000000000;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            now = now_ns();
+            if (now - due > max_late) {
+                max_late = now - due;
+            }
+        }
+
+        switch (r->type) {
+        case LT_SWITCH:
+            len = snprintf(line, sizeof(line), "inject %u\n", r->value);
+            if (write(ctl, line, len) != len) {
+                fprintf(stderr, "switch injection: %s%s\n", strerror(errno),
+                        errno == EPERM ? " (load the driver with allow_inject=1)" : "");
+                ret = 1;
+            }
+            break;
+        case LT_MODE:
+            len = snprintf(line, sizeof(line), "%d\n", (int8_t)r->value);
+            // 프로그램/패턴이 올라가 있지 않은 장치면 ENOENT, 녹화 당시와 다르다는 뜻이라 알리고 계속
+            if (write(ctl, line, len) != len) {
+                fprintf(stderr, "record %zu: mode %d: %s\n", i, (int8_t)r->value, strerror(errno));
+            }
+            break;
+        case LT_MASK:
+            len = snprintf(line, sizeof(line), "%u\n", r->value);
+            if (mask_fd < 0 || pwrite(mask_fd, line, len, 0) != len) {
+                fprintf(stderr, "record %zu: led_mask: %s\n", i, strerror(errno));
+            }
+            break;
+        case LT_OPEN:
+            if (sess_fd[r->sess] >= 0) {
+                close(sess_fd[r->sess]);
+            }
+            sess_fd[r->sess] = open(device, O_WRONLY | O_CLOEXEC);
+            if (sess_fd[r->sess] < 0) {
+                perror(device);
+                ret = 1;
+            }
+            break;
+        case LT_CLOSE:
+            if (sess_fd[r->sess] >= 0) {
+                close(sess_fd[r->sess]);
+                sess_fd[r->sess] = -1;
+            }
+            break;
+        case LT_REQ:
+            // 같은 시각에 같은 세션으로 이어지는 요청은 한 묶음으로 보낸다
+            q.hdr.magic = LED_REQ_MAGIC;
+            q.hdr.version = LED_REQ_VERSION;
+            q.hdr.count = 0;
+            for (;;) {
+                memset(&q.reqs[q.hdr.count], 0, sizeof(q.reqs[0]));
+                q.reqs[q.hdr.count].op = r->op;
+                q.reqs[q.hdr.count].value = r->value;
+                q.hdr.count++;
+                if (i + 1 == t->n || q.hdr.count == LED_REQ_MAX || t->recs[i + 1].type != LT_REQ ||
+                    t->recs[i + 1].dt_us != 0 || t->recs[i + 1].sess != r->sess) {
+                    break;
+                }
+                r = &t->recs[++i];
+            }
+            if (sess_fd[r->sess] < 0) {
+                fprintf(stderr, "record %zu: request on a closed session\n", i);
+                break;
+            }
+            if (write_all(sess_fd[r->sess], &q, sizeof(q.hdr) + q.hdr.count * sizeof(q.reqs[0]), "request") < 0) {
+                ret = 1;
+            }
+            break;
+        }
+    }
+
+    // 마지막 변화가 타임라인에 잡히도록 잠깐 기다린다
+    usleep(200000);
+    replay_done = 1;
+    if (mask_fd >= 0) {
+        pthread_join(tl, NULL);
+        close(mask_fd);
+    }
+    for (i = 0; i < LEDTRACE_SESSIONS_MAX; i++) {
+        if (sess_fd[i] >= 0) {
+            close(sess_fd[i]);
+        }
+    }
+    close(ctl);
+
+    fprintf(stderr, "%zu records, %.3f s of trace replayed in %.3f s", t->n, at / 1e9,
+            (now_ns() - replay_start) / 1e9 - 0.2);
+    if (speed > 0) {
+        fprintf(stderr, ", at most %.3f ms behind schedule", max_late / 1e6);
+    }
+    fprintf(stderr, "\n");
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    const char *device = LED_DEVICE_PATH, *log_path = NULL, *prog = NULL;
+    double speed = 1, period_ms = 2000;
+    int sim = 0, opt, ret;
+    struct trace t;
+
+    while ((opt = getopt(argc, argv, "x:d:sl:p:b:v")) != -1) {
+        switch (opt) {
+        case 'x':
+            speed = atof(optarg);
+            break;
+        case 'd':
+            device = optarg;
+            break;
+        case 's':
+            sim = 1;
+            break;
+        case 'l':
+            log_path = optarg;
+            break;
+        case 'p':
+            period_ms = atof(optarg);
+            break;
+        case 'b':
+            prog = optarg;
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            goto usage;
+        }
+    }
+    if (optind != argc - 1 || speed < 0 || period_ms < 1) {
+        goto usage;
+    }
+    if (load_trace(argv[optind], &t) < 0) {
+        return 1;
+    }
+    if (!(t.hdr.flags & LEDTRACE_F_INPUTS)) {
+        fprintf(stderr, "trace was recorded without trace_inputs: commands and sessions are missing\n");
+    }
+
+    timeline = log_path ? fopen(log_path, "w") : stdout;
+    if (!timeline) {
+        perror(log_path);
+        return 1;
+    }
+    ret = sim ? replay_sim(&t, period_ms, prog) : replay_device(&t, device, speed);
+    if (timeline != stdout) {
+        fclose(timeline);
+    }
+    free(t.recs);
+    return ret;
+
+usage:
+    printf("Usage: %s [-x speed] [-d device | -s] [-l timeline] [-p period_ms] [-b prog.bin] [-v] trace.bin\n",
+           argv[0]);
+    return 1;
+}
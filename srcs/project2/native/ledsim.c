@@ -0,0 +1,186 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ledsim.h"
+
+static uint64_t real_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// 지금까지 켜져 있던 시간을 줄마다 더한다
+static void account(struct ledsim *sim) {
+    uint64_t dt = sim->now - sim->last_change;
+    int i;
+
+    for (i = 0; i < LED_NUM; i++) {
+        if (sim->gpio & (1u << i)) {
+            sim->line[i].on_ns += dt;
+        }
+    }
+    sim->last_change = sim->now;
+}
+
+// 가짜 GPIO 백엔드: 모듈의 led_output_commit 자리
+static void gpio_commit(struct ledsim *sim, uint32_t mask) {
+    uint32_t old = sim->gpio, diff = old ^ mask;
+    int i;
+
+    if (!diff) {
+        return;
+    }
+    account(sim);
+    for (i = 0; i < LED_NUM; i++) {
+        if (diff & (1u << i)) {
+            sim->line[i].toggles++;
+        }
+    }
+    sim->gpio = mask;
+    if (sim->trace) {
+        sim->trace(sim, old, sim->trace_arg);
+    }
+}
+
+// 모드 출력 위에 세션 overlay 를 얹는다
+static void output_commit(struct ledsim *sim) {
+    gpio_commit(sim, (sim->eng.mask & ~sim->claim) | sim->value);
+}
+
+static void schedule(struct ledsim *sim, uint64_t delay) {
+    sim->next_tick = delay == LED_ENGINE_STOP ? LED_ENGINE_STOP : sim->now + delay;
+}
+
+void ledsim_init(struct ledsim *sim, uint64_t period_ns, unsigned int insn_budget) {
+    memset(sim, 0, sizeof(*sim));
+    led_engine_init(&sim->eng, period_ns, insn_budget);
+    sim->next_tick = LED_ENGINE_STOP;
+}
+
+int ledsim_load_program(struct ledsim *sim, const void *rec, size_t len) {
+    struct led_vm_header hdr;
+    u32 insns[LED_VM_MAX_INSNS];
+    int ret;
+
+    if (led_rec_program(rec, len, &hdr) < 0) {
+        return -EINVAL;
+    }
+    memcpy(insns, (const char *)rec + sizeof(hdr), hdr.count * sizeof(u32));
+    ret = led_vm_verify(insns, hdr.count);
+    if (ret < 0) {
+        return ret;
+    }
+    led_vm_load(&sim->eng.vm, insns, hdr.count);
+    return 0;
+}
+
+void ledsim_set_patterns(struct ledsim *sim, const struct led_pattern_lib *lib, int sel) {
+    sim->eng.patterns = lib;
+    sim->eng.pattern_sel = sel;
+}
+
+void ledsim_set_mode(struct ledsim *sim, int mode) {
+    uint64_t delay = led_engine_set_mode(&sim->eng, mode);
+
+    if (sim->eng.changed) {
+        output_commit(sim);
+    }
+    schedule(sim, delay);
+}
+
+void ledsim_set_switches(struct ledsim *sim, uint32_t held) {
+    sim->eng.switches = held;
+    if (sim->eng.mode == LED_MODE_PROGRAM && (sim->eng.vm.wait_sw & held)) {
+        sim->eng.vm.wait_sw = 0;
+        sim->next_tick = sim->now;
+    }
+}
+
+void ledsim_advance(struct ledsim *sim, uint64_t until) {
+    uint64_t delay, t;
+
+    while (sim->next_tick != LED_ENGINE_STOP && sim->next_tick <= until) {
+        sim->now = sim->next_tick;
+        t = real_ns();
+        delay = led_engine_step(&sim->eng);
+        sim->step_ns += real_ns() - t;
+        sim->ticks++;
+
+        if (sim->eng.changed) {
+            output_commit(sim);
+        }
+        if (sim->eng.status != LED_ENGINE_OK) {
+            sim->last_status = sim->eng.status;
+        }
+        schedule(sim, delay);
+    }
+    sim->now = until;
+    account(sim);
+}
+
+static int session_order(const void *a, const void *b) {
+    const struct ledsim_session *x = *(const struct ledsim_session *const *)a;
+    const struct ledsim_session *y = *(const struct ledsim_session *const *)b;
+
+    return x->order < y->order ? -1 : x->order > y->order;
+}
+
+// 드라이버처럼 연 순서대로 중재에 넣는다 (같은 priority 면 먼저 연 쪽이 이김)
+static void arbitrate(struct ledsim *sim) {
+    struct ledsim_session *open[LEDSIM_SESSIONS];
+    struct led_arb arb;
+    int k, n = 0;
+
+    for (k = 0; k < LEDSIM_SESSIONS; k++) {
+        if (sim->sess[k].open) {
+            open[n++] = &sim->sess[k];
+        }
+    }
+    qsort(open, n, sizeof(open[0]), session_order);
+    led_arb_init(&arb);
+    for (k = 0; k < n; k++) {
+        led_arb_add(&arb, &open[k]->own);
+    }
+    led_arb_result(&arb, &sim->claim, &sim->value);
+    output_commit(sim);
+}
+
+void ledsim_session_open(struct ledsim *sim, int id) {
+    struct ledsim_session *s = &sim->sess[id % LEDSIM_SESSIONS];
+
+    memset(s, 0, sizeof(*s));
+    s->open = true;
+    s->order = sim->sess_seq++;
+}
+
+void ledsim_session_close(struct ledsim *sim, int id) {
+    struct ledsim_session *s = &sim->sess[id % LEDSIM_SESSIONS];
+
+    s->open = false;
+    if (s->own.claim) {
+        arbitrate(sim);
+    }
+}
+
+int ledsim_session_req(struct ledsim *sim, int id, int op, uint32_t value) {
+    struct ledsim_session *s = &sim->sess[id % LEDSIM_SESSIONS];
+    struct led_req req = { .op = op, .value = value };
+
+    if (!s->open || op <= 0 || op >= LED_REQ_OP_COUNT || led_req_check(&req) < 0) {
+        return -EINVAL;
+    }
+    led_req_apply(&s->own, &req);
+    arbitrate(sim);
+    return 0;
+}
+
+void ledsim_set_mask(struct ledsim *sim, uint32_t mask) {
+    if (sim->eng.mode != LED_MODE_MANUAL) {
+        ledsim_set_mode(sim, LED_MODE_MANUAL);
+    }
+    sim->eng.mask = mask & LED_MASK_ALL;
+    output_commit(sim);
+}
@@ -0,0 +1,61 @@
+#ifndef LEDSIM_H
+#define LEDSIM_H
+
+// libledsim: 모듈의 모드 엔진(led_engine.c, led_vm.c)을 가짜 GPIO 와 가상 시계 위에서 돌린다.
+// 시간은 다음 tick 으로 바로 건너뛰므로 몇 시간짜리 패턴도 밀리초 안에 끝난다.
+// 출력 변화는 LED 줄마다 토글 수와 켜진 시간으로 모으고, 원하면 trace 콜백으로 받는다.
+
+#include "led_engine.h"
+#include "led_proto.h"
+
+struct ledsim_line {
+    uint64_t toggles;
+    uint64_t on_ns;
+};
+
+// 드라이버 세션(open 한 파일) 흉내. 번호는 호출하는 쪽이 정한다
+#define LEDSIM_SESSIONS 256
+
+struct ledsim_session {
+    bool open;
+    uint64_t order;     // 연 순서 (같은 priority 면 먼저 연 쪽이 이김)
+    struct led_owner own;
+};
+
+struct ledsim;
+typedef void (*ledsim_trace_cb)(const struct ledsim *sim, uint32_t old_mask, void *arg);
+
+struct ledsim {
+    struct led_engine eng;
+    uint64_t now;          // 가상 시각 (ns)
+    uint64_t next_tick;    // 다음 tick 의 가상 시각, LED_ENGINE_STOP 이면 없음
+    uint32_t gpio;         // 가짜 GPIO 출력
+    uint64_t last_change;  // 켜진 시간 계산을 어디까지 했는지
+    struct ledsim_line line[LED_NUM];
+    uint64_t ticks;
+    uint64_t step_ns;      // led_engine_step 에 쓴 실제 시간 합
+    int last_status;       // 마지막으로 엔진을 멈춘 이유 (LED_ENGINE_*)
+    ledsim_trace_cb trace;
+    void *trace_arg;
+    struct ledsim_session sess[LEDSIM_SESSIONS];
+    uint64_t sess_seq;
+    uint32_t claim, value;  // 세션 중재 결과 (모드 출력 위에 얹는다)
+};
+
+void ledsim_init(struct ledsim *sim, uint64_t period_ns, unsigned int insn_budget);
+// LEVM 레코드(header + 명령어)를 검증해 올린다. 0 또는 -errno
+int ledsim_load_program(struct ledsim *sim, const void *rec, size_t len);
+void ledsim_set_patterns(struct ledsim *sim, const struct led_pattern_lib *lib, int sel);
+void ledsim_set_mode(struct ledsim *sim, int mode);
+// 스위치 레벨 변화. WAITSW 로 기다리는 프로그램은 바로 깨운다
+void ledsim_set_switches(struct ledsim *sim, uint32_t held);
+// until 까지 tick 을 돌리고 시각을 until 로 옮긴다
+void ledsim_advance(struct ledsim *sim, uint64_t until);
+// 세션 요청 (모듈과 같은 led_proto.c 의 검사와 중재). 0 또는 -errno
+void ledsim_session_open(struct ledsim *sim, int id);
+void ledsim_session_close(struct ledsim *sim, int id);
+int ledsim_session_req(struct ledsim *sim, int id, int op, uint32_t value);
+// LED 를 직접 지정 (sysfs led_mask 처럼 수동 모드로 바뀐다)
+void ledsim_set_mask(struct ledsim *sim, uint32_t mask);
+
+#endif
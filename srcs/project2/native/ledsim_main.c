@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ledsim.h"
+
+// 하드웨어 없이 모드 엔진을 가상 시간으로 돌린다
+//   ledsim [-m mode] [-T sim_sec] [-p period_ms] [-f frames] [-1] [-b prog.bin] [-s switches] [-v]
+//   -f "mask:ms,mask:ms,..." : 패턴 모드 프레임 (기본은 반복, -1 이면 한 번만)
+//   -b prog.bin              : ledprog -o 로 만든 바이트코드 (프로그램 모드)
+//   -s "ms:mask,ms:mask,..." : 가상 시각 ms 에 눌려 있는 스위치를 mask 로 바꾼다
+//   -v                       : 출력이 바뀔 때마다 출력
+// 예) ledsim -m 2 -T 36000 -p 500 : 순차 모드 10 시간
+
+#define MAX_FRAMES 256
+#define MAX_SWITCH_EVENTS 64
+
+struct sw_event {
+    uint64_t at_ns;
+    uint32_t mask;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void print_change(const struct ledsim *sim, uint32_t old, void *arg) {
+    printf("%12.3f ms  0x%x -> 0x%x\n", sim->now / 1e6, old, sim->gpio);
+}
+
+static struct led_pattern_lib *parse_frames(char *arg, int loop) {
+    struct led_pattern_lib *lib;
+    struct led_frame *frames;
+    char *item;
+    int n = 0;
+
+    lib = calloc(1, sizeof(*lib) + sizeof(struct led_pattern) + MAX_FRAMES * sizeof(struct led_frame));
+    if (!lib) {
+        return NULL;
+    }
+    frames = (struct led_frame *)((char *)lib + sizeof(*lib) + sizeof(struct led_pattern));
+    for (item = strtok(arg, ","); item; item = strtok(NULL, ",")) {
+        unsigned mask, ms;
+
+        // 0ms 프레임만으로 반복하면 시간이 흐르지 않는다
+        if (n == MAX_FRAMES || sscanf(item, "%i:%u", &mask, &ms) != 2 || ms == 0) {
+            free(lib);
+            return NULL;
+        }
+        frames[n].mask = mask & LED_MASK_ALL;
+        frames[n].duration_ms = ms;
+        n++;
+    }
+    lib->count = 1;
+    snprintf(lib->patterns[0].name, sizeof(lib->patterns[0].name), "cli");
+    lib->patterns[0].loop = loop;
+    lib->patterns[0].nframes = n;
+    lib->patterns[0].frames = frames;
+    return n ? lib : (free(lib), NULL);
+}
+
+static int parse_switches(char *arg, struct sw_event *ev) {
+    char *item;
+    int n = 0;
+
+    for (item = strtok(arg, ","); item; item = strtok(NULL, ",")) {
+        unsigned long long ms;
+        unsigned mask;
+
+        if (n == MAX_SWITCH_EVENTS || sscanf(item, "%llu:%i", &ms, &mask) != 2) {
+            return -1;
+        }
+        ev[n].at_ns = ms * 1000000ULL;
+        ev[n].mask = mask;
+        if (n && ev[n].at_ns < ev[n - 1].at_ns) {
+            return -1;
+        }
+        n++;
+    }
+    return n;
+}
+
+static int load_program(struct ledsim *sim, const char *path) {
+    char buf[sizeof(struct led_vm_header) + LED_VM_MAX_INSNS * sizeof(__u32)];
+    size_t len;
+    FILE *in;
+    int ret;
+
+    in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+    len = fread(buf, 1, sizeof(buf), in);
+    fclose(in);
+    ret = ledsim_load_program(sim, buf, len);
+    if (ret < 0) {
+        fprintf(stderr, "%s: program rejected (%s)\n", path, strerror(-ret));
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    static const char *const status_names[] = { "idle", "program halted", "program fault", "pattern finished" };
+    struct sw_event sw[MAX_SWITCH_EVENTS];
+    struct led_pattern_lib *lib = NULL;
+    const char *prog = NULL;
+    char *frames = NULL;
+    double sim_sec = 3600, period_ms = 2000, wall;
+    int mode = LED_MODE_SEQ, loop = 1, verbose = 0, n_sw = 0, opt, i, k;
+    struct ledsim sim;
+    uint64_t end;
+
+    while ((opt = getopt(argc, argv, "m:T:p:f:1b:s:v")) != -1) {
+        switch (opt) {
+        case 'm':
+            mode = atoi(optarg);
+            break;
+        case 'T':
+            sim_sec = atof(optarg);
+            break;
+        case 'p':
+            period_ms = atof(optarg);
+            break;
+        case 'f':
+            frames = optarg;
+            break;
+        case '1':
+            loop = 0;
+            break;
+        case 'b':
+            prog = optarg;
+            break;
+        case 's':
+            n_sw = parse_switches(optarg, sw);
+            if (n_sw < 0) {
+                fprintf(stderr, "invalid switch schedule: expected ms:mask,... in time order\n");
+                return 1;
+            }
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            printf("Usage: %s [-m mode] [-T sim_sec] [-p period_ms] [-f mask:ms,...] [-1] [-b prog.bin] "
+                   "[-s ms:mask,...] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (sim_sec <= 0 || period_ms < 1) {
+        fprintf(stderr, "invalid duration or period\n");
+        return 1;
+    }
+
+    ledsim_init(&sim, (uint64_t)(period_ms * 1e6), 256);
+    if (verbose) {
+        sim.trace = print_change;
+    }
+    if (frames) {
+        lib = parse_frames(frames, loop);
+        if (!lib) {
+            fprintf(stderr, "invalid frames: expected mask:ms,... with ms > 0\n");
+            return 1;
+        }
+        ledsim_set_patterns(&sim, lib, 0);
+    }
+    if (prog && load_program(&sim, prog) < 0) {
+        return 1;
+    }
+    if (!led_mode_desc(mode)) {
+        fprintf(stderr, "mode %d is unknown or not built in (CONFIG_LED_MODE_*)\n", mode);
+        return 1;
+    }
+    if ((mode == LED_MODE_PATTERN && !lib) || (mode == LED_MODE_PROGRAM && !prog)) {
+        fprintf(stderr, "mode %d needs %s\n", mode, mode == LED_MODE_PATTERN ? "-f" : "-b");
+        return 1;
+    }
+
+    end = (uint64_t)(sim_sec * 1e9);
+    wall = now_sec();
+    ledsim_set_mode(&sim, mode);
+    for (i = 0; i < n_sw && sw[i].at_ns < end; i++) {
+        ledsim_advance(&sim, sw[i].at_ns);
+        ledsim_set_switches(&sim, sw[i].mask);
+    }
+    ledsim_advance(&sim, end);
+    wall = now_sec() - wall;
+
+    printf("mode %d, %.3f s simulated in %.3f ms (x%.0f)\n", mode, sim_sec, wall * 1e3, sim_sec / wall);
+    printf("ticks %llu, %.1f ns/tick in the engine, state %s\n", (unsigned long long)sim.ticks,
+           sim.ticks ? (double)sim.step_ns / sim.ticks : 0.0,
+           sim.next_tick != LED_ENGINE_STOP ? "running" : status_names[sim.last_status]);
+    for (k = 0; k < LED_NUM; k++) {
+        printf("LED%d toggles %10llu  on %6.2f%%\n", k, (unsigned long long)sim.line[k].toggles,
+               100.0 * sim.line[k].on_ns / end);
+    }
+
+    free(lib);
+    return 0;
+}
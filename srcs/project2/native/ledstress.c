@@ -0,0 +1,543 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ledctl.h"
+
+// /dev/led_control (또는 ledcuse 대역) 동시 접근 스트레스 + 불변식 검사
+//   ledstress [-d device] [-c clients] [-T sec] [-r readers] [-p pollers] [-i inject_hz] [-o text|csv|json]
+//   -c 1,2,4,8 : 단계마다 writer 수. 단계마다 -T 초씩 돌리고 writer 당 처리량이 얼마나 떨어지는지 본다
+//   -r / -p    : 모드를 계속 읽는 reader, /dev/led_events 를 poll 하는 poller 수 (단계마다 같음)
+//   -i         : 초당 스위치 주입 횟수 ("inject" 명령, 드라이버는 allow_inject=1 이어야 함)
+// writer 는 섞어서 보낸다: 자기 LED 요청 묶음, 모드 전환, 모드 읽기, 일부러 틀린 레코드.
+// 검사하는 불변식
+//   - 올바른 레코드는 성공하고, 틀린 레코드는 EINVAL 로 거절된다 (다른 errno 는 위반)
+//   - 읽은 모드는 "-1\n" ~ "6\n" 형식
+//   - LED k 를 가장 높은 priority 로 잡은 writer k 의 값이 led_mask(sysfs) 에 반영된다
+//   - 이벤트는 16 byte 단위이고, 시각이 거꾸로 가지 않고, 종류와 값이 범위 안에 있다
+// 데이터 경쟁/잠금 순서 검사는 커널 쪽에서: CONFIG_KCSAN, CONFIG_PROVE_LOCKING 커널에서 돌리고 dmesg 확인.
+// 위반이 하나라도 있으면 종료 코드 1.
+
+#define MAX_STEPS 16
+#define MAX_WRITERS 256
+#define OWNER_PRIO 200
+#define CHECK_EVERY 64          // owner 는 이만큼 요청마다 출력 반영을 확인
+#define CONVERGE_TIMEOUT_NS 200000000ULL
+#define LED_MASK_PATH "/sys/kernel/led_control/led_mask"
+
+enum {
+    W_BATCH,
+    W_MODE,
+    W_READ,
+    W_BAD,
+    W_COUNT,
+};
+
+struct worker {
+    pthread_t thread;
+    int id;
+    long ops;
+};
+
+struct step_result {
+    int writers;
+    double writer_ops, reader_ops, events;
+    double elapsed;
+};
+
+static const char *device = LED_DEVICE_PATH;
+static double step_sec = 2;
+static int n_readers = 1, n_pollers = 1;
+static double inject_hz;
+static volatile int stop;
+static long violations;
+static int inject_disabled;
+static int have_led_mask;
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// 위반은 처음 몇 개만 자세히 찍는다
+static void violation(const char *fmt, ...) {
+    va_list ap;
+
+    pthread_mutex_lock(&report_lock);
+    if (violations++ < 20) {
+        fprintf(stderr, "violation: ");
+        va_start(ap, fmt);
+        vfprintf(stderr, fmt, ap);
+        va_end(ap);
+        fputc('\n', stderr);
+    }
+    pthread_mutex_unlock(&report_lock);
+}
+
+static int mode_valid(const char *buf, ssize_t len) {
+    char *end;
+    long mode;
+
+    if (len < 2 || buf[len - 1] != '\n') {
+        return 0;
+    }
+    mode = strtol(buf, &end, 10);
+    return end == buf + len - 1 && mode >= -1 && mode <= LED_MODE_PATTERN;
+}
+
+static int read_led_mask(uint32_t *mask) {
+    char buf[32];
+    ssize_t len;
+    int fd;
+
+    fd = open(LED_MASK_PATH, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) {
+        return -1;
+    }
+    buf[len] = '\0';
+    *mask = strtoul(buf, NULL, 0);
+    return 0;
+}
+
+// writer k (< LED_NUM) 가 낸 값이 엔진 스레드를 거쳐 출력에 나올 때까지 기다린다
+static void check_owner(int k, uint32_t value) {
+    uint64_t deadline = now_ns() + CONVERGE_TIMEOUT_NS;
+    uint32_t mask = 0;
+
+    do {
+        if (read_led_mask(&mask) < 0) {
+            violation("writer %d: cannot read " LED_MASK_PATH, k);
+            return;
+        }
+        if (((mask >> k) & 1) == value) {
+            return;
+        }
+        usleep(100);
+    } while (now_ns() < deadline);
+    violation("writer %d: LED%d is %u, expected %u after 200 ms", k, k, (mask >> k) & 1, value);
+}
+
+// 일부러 틀린 레코드: 모두 EINVAL 이어야 한다
+static void bad_write(int fd, unsigned r) {
+    struct {
+        struct led_req_header hdr;
+        struct led_req req;
+    } q = {
+        .hdr = { LED_REQ_MAGIC, LED_REQ_VERSION, 1 },
+        .req = { .op = 0, .value = 1 },
+    };
+    char line[100];
+    const void *buf;
+    size_t len;
+
+    switch (r % 3) {
+    case 0:
+        buf = &q;
+        len = sizeof(q);
+        break;
+    case 1:
+        buf = "9\n";
+        len = 2;
+        break;
+    default:
+        memset(line, '1', sizeof(line) - 1);
+        line[sizeof(line) - 1] = '\n';
+        buf = line;
+        len = sizeof(line);
+        break;
+    }
+    if (write(fd, buf, len) >= 0) {
+        violation("invalid record %u accepted", r % 3);
+    } else if (errno != EINVAL) {
+        violation("invalid record %u: %s instead of EINVAL", r % 3, strerror(errno));
+    }
+}
+
+static void *writer_fn(void *arg) {
+    struct worker *w = arg;
+    unsigned seed = w->id * 7919 + 1, r;
+    int owner = w->id < LED_NUM, mode, fd;
+    uint32_t own = owner ? 1u << w->id : 0, value = 0;
+    struct ledctl *c;
+
+    c = ledctl_open(device, 0);
+    fd = open(device, O_WRONLY | O_CLOEXEC);
+    if (!c || fd < 0) {
+        violation("writer %d: open %s: %s", w->id, device, strerror(errno));
+        ledctl_close(c);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+    if (ledctl_is_legacy(c)) {
+        violation("writer %d: device does not accept LEDQ requests", w->id);
+        ledctl_close(c);
+        close(fd);
+        return NULL;
+    }
+    // owner 는 자기 LED 를 높은 priority 로, 나머지는 아무 LED 나 낮은 priority 로 다툰다
+    if (owner) {
+        ledctl_priority(c, OWNER_PRIO);
+        ledctl_claim(c, own);
+    } else {
+        ledctl_priority(c, rand_r(&seed) % 100);
+    }
+    if (ledctl_flush(c) < 0) {
+        violation("writer %d: claim: %s", w->id, strerror(errno));
+    }
+
+    while (!stop) {
+        r = rand_r(&seed);
+        switch (r % 10 < 5 ? W_BATCH : r % 10 < 7 ? W_MODE : r % 10 < 9 ? W_READ : W_BAD) {
+        case W_BATCH:
+            if (owner) {
+                value ^= 1;
+                ledctl_toggle(c, own);
+            } else {
+                ledctl_claim(c, 1u << ((r >> 8) % LED_NUM));
+                ledctl_set(c, (r >> 12) & LED_MASK_ALL);
+                ledctl_release(c, 1u << ((r >> 16) % LED_NUM));
+            }
+            if (ledctl_flush(c) < 0) {
+                violation("writer %d: request batch: %s", w->id, strerror(errno));
+            }
+            if (owner && have_led_mask && w->ops % CHECK_EVERY == 0) {
+                check_owner(w->id, value);
+            }
+            break;
+        case W_MODE:
+            // 전체/순차/수동/리셋만 (프로그램/패턴은 올려 둔 것이 없으면 ENOENT)
+            if (ledctl_set_mode(c, LED_MODE_BLINK + (r >> 8) % 4) < 0) {
+                violation("writer %d: set mode: %s", w->id, strerror(errno));
+            }
+            break;
+        case W_READ:
+            mode = ledctl_get_mode(c);
+            if (mode < -1 || mode > LED_MODE_PATTERN) {
+                violation("writer %d: get mode returned %d (%s)", w->id, mode, strerror(errno));
+            }
+            break;
+        default:
+            bad_write(fd, r >> 8);
+            break;
+        }
+        w->ops++;
+    }
+
+    if (ledctl_close(c) < 0) {
+        violation("writer %d: close: %s", w->id, strerror(errno));
+    }
+    close(fd);
+    return NULL;
+}
+
+static void *reader_fn(void *arg) {
+    struct worker *w = arg;
+    char buf[16];
+    ssize_t len;
+    int fd;
+
+    fd = open(device, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        violation("reader %d: open %s: %s", w->id, device, strerror(errno));
+        return NULL;
+    }
+    while (!stop) {
+        len = read(fd, buf, sizeof(buf));
+        if (len < 0) {
+            violation("reader %d: read: %s", w->id, strerror(errno));
+            break;
+        }
+        if (!mode_valid(buf, len)) {
+            violation("reader %d: bad mode line \"%.*s\"", w->id, (int)len, buf);
+        }
+        w->ops++;
+    }
+    close(fd);
+    return NULL;
+}
+
+static void check_event(int id, const struct led_event *ev, uint64_t *last_ts) {
+    if (ev->timestamp_ns < *last_ts) {
+        violation("poller %d: event time went back %llu -> %llu", id, (unsigned long long)*last_ts,
+                  (unsigned long long)ev->timestamp_ns);
+    }
+    *last_ts = ev->timestamp_ns;
+    if (ev->type < LED_EV_GESTURE || ev->type > LED_EV_INPUT_MASK) {
+        violation("poller %d: unknown event type %u", id, ev->type);
+    } else if (ev->type == LED_EV_MODE && ((int)ev->value < -1 || (int)ev->value > LED_MODE_PATTERN)) {
+        violation("poller %d: mode event with mode %d", id, (int)ev->value);
+    } else if (ev->type == LED_EV_SWITCH && (ev->value & ~SW_MASK_ALL)) {
+        violation("poller %d: switch event with mask 0x%x", id, ev->value);
+    }
+}
+
+// /dev/led_events 가 없으면 (CUSE 대역) 장치 자체를 poll 한다
+static void *poller_fn(void *arg) {
+    struct worker *w = arg;
+    struct led_event evs[64];
+    struct pollfd pfd;
+    uint64_t last_ts = 0;
+    ssize_t len;
+    int i;
+
+    pfd.fd = open(LED_EVENTS_PATH, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    pfd.events = POLLIN;
+    if (pfd.fd < 0) {
+        pfd.fd = open(device, O_RDWR | O_CLOEXEC);
+        pfd.events = POLLIN | POLLOUT;
+        if (pfd.fd < 0) {
+            violation("poller %d: open %s: %s", w->id, device, strerror(errno));
+            return NULL;
+        }
+        while (!stop) {
+            if (poll(&pfd, 1, 100) != 1 || !(pfd.revents & POLLOUT)) {
+                violation("poller %d: device not writable", w->id);
+                break;
+            }
+            w->ops++;
+        }
+        close(pfd.fd);
+        return NULL;
+    }
+
+    while (!stop) {
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        len = read(pfd.fd, evs, sizeof(evs));
+        if (len < 0) {
+            if (errno != EAGAIN) {
+                violation("poller %d: read events: %s", w->id, strerror(errno));
+                break;
+            }
+            continue;
+        }
+        if (len % sizeof(struct led_event)) {
+            violation("poller %d: short event read (%zd bytes)", w->id, len);
+        }
+        for (i = 0; i < len / (ssize_t)sizeof(struct led_event); i++) {
+            check_event(w->id, &evs[i], &last_ts);
+        }
+        w->ops += len / sizeof(struct led_event);
+    }
+    close(pfd.fd);
+    return NULL;
+}
+
+// 스위치 하나를 눌렀다 떼기를 반복한다
+static void *inject_fn(void *arg) {
+    struct worker *w = arg;
+    unsigned seed = 12345;
+    char cmd[32];
+    int fd, len, press = 1, sw = 0;
+
+    fd = open(device, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        violation("injector: open %s: %s", device, strerror(errno));
+        return NULL;
+    }
+    while (!stop && !inject_disabled) {
+        if (press) {
+            sw = rand_r(&seed) % SW_NUM;
+        }
+        len = snprintf(cmd, sizeof(cmd), "inject %u\n", press ? 1u << sw : 0);
+        if (write(fd, cmd, len) != len) {
+            if (errno == EPERM || errno == EOPNOTSUPP) {
+                inject_disabled = 1;
+                break;
+            }
+            violation("injector: %s", strerror(errno));
+        }
+        press = !press;
+        w->ops++;
+        usleep(1000000 / inject_hz);
+    }
+    close(fd);
+    return NULL;
+}
+
+static int run_step(int writers, struct step_result *res) {
+    struct worker *ws, *rs, *ps, inj = { 0 };
+    int injecting = inject_hz > 0 && !inject_disabled;
+    uint64_t start;
+    int i;
+
+    ws = calloc(writers, sizeof(*ws));
+    rs = calloc(n_readers, sizeof(*rs));
+    ps = calloc(n_pollers, sizeof(*ps));
+    if (!ws || !rs || !ps) {
+        perror("calloc");
+        return -1;
+    }
+
+    stop = 0;
+    start = now_ns();
+    for (i = 0; i < writers; i++) {
+        ws[i].id = i;
+        pthread_create(&ws[i].thread, NULL, writer_fn, &ws[i]);
+    }
+    for (i = 0; i < n_readers; i++) {
+        rs[i].id = i;
+        pthread_create(&rs[i].thread, NULL, reader_fn, &rs[i]);
+    }
+    for (i = 0; i < n_pollers; i++) {
+        ps[i].id = i;
+        pthread_create(&ps[i].thread, NULL, poller_fn, &ps[i]);
+    }
+    if (injecting) {
+        pthread_create(&inj.thread, NULL, inject_fn, &inj);
+    }
+
+    usleep(step_sec * 1e6);
+    stop = 1;
+
+    memset(res, 0, sizeof(*res));
+    res->writers = writers;
+    for (i = 0; i < writers; i++) {
+        pthread_join(ws[i].thread, NULL);
+        res->writer_ops += ws[i].ops;
+    }
+    for (i = 0; i < n_readers; i++) {
+        pthread_join(rs[i].thread, NULL);
+        res->reader_ops += rs[i].ops;
+    }
+    for (i = 0; i < n_pollers; i++) {
+        pthread_join(ps[i].thread, NULL);
+        res->events += ps[i].ops;
+    }
+    if (injecting) {
+        pthread_join(inj.thread, NULL);
+    }
+    res->elapsed = (now_ns() - start) / 1e9;
+
+    free(ws);
+    free(rs);
+    free(ps);
+    return 0;
+}
+
+static int parse_clients(char *arg, int *steps) {
+    char *item;
+    int n = 0;
+
+    for (item = strtok(arg, ","); item; item = strtok(NULL, ",")) {
+        if (n == MAX_STEPS) {
+            return -1;
+        }
+        steps[n] = atoi(item);
+        if (steps[n] < 1 || steps[n] > MAX_WRITERS) {
+            return -1;
+        }
+        n++;
+    }
+    return n;
+}
+
+int main(int argc, char *argv[]) {
+    int steps[MAX_STEPS] = { 1, 2, 4, 8 }, n_steps = 4, opt, i;
+    struct step_result res[MAX_STEPS];
+    const char *format = "text";
+    double base, per;
+    uint32_t mask;
+
+    while ((opt = getopt(argc, argv, "d:c:T:r:p:i:o:")) != -1) {
+        switch (opt) {
+        case 'd':
+            device = optarg;
+            break;
+        case 'c':
+            n_steps = parse_clients(optarg, steps);
+            if (n_steps <= 0) {
+                fprintf(stderr, "invalid client list: expected n,n,... (1-%d)\n", MAX_WRITERS);
+                return 1;
+            }
+            break;
+        case 'T':
+            step_sec = atof(optarg);
+            break;
+        case 'r':
+            n_readers = atoi(optarg);
+            break;
+        case 'p':
+            n_pollers = atoi(optarg);
+            break;
+        case 'i':
+            inject_hz = atof(optarg);
+            break;
+        case 'o':
+            format = optarg;
+            break;
+        default:
+            printf("Usage: %s [-d device] [-c n,n,...] [-T sec] [-r readers] [-p pollers] [-i inject_hz] "
+                   "[-o text|csv|json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (step_sec <= 0 || n_readers < 0 || n_pollers < 0 || inject_hz < 0 || inject_hz > 1000 ||
+        (strcmp(format, "text") && strcmp(format, "csv") && strcmp(format, "json"))) {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+    have_led_mask = read_led_mask(&mask) == 0;
+
+    for (i = 0; i < n_steps; i++) {
+        if (run_step(steps[i], &res[i]) < 0) {
+            return 1;
+        }
+    }
+    if (inject_hz > 0 && inject_disabled) {
+        fprintf(stderr, "switch injection refused (load the driver with allow_inject=1)\n");
+    }
+
+    base = res[0].writer_ops / res[0].elapsed / res[0].writers;
+    if (strcmp(format, "csv") == 0) {
+        printf("writers,readers,pollers,writer_ops_per_sec,per_writer_ops_per_sec,relative,reads_per_sec,"
+               "events_per_sec\n");
+        for (i = 0; i < n_steps; i++) {
+            per = res[i].writer_ops / res[i].elapsed / res[i].writers;
+            printf("%d,%d,%d,%.0f,%.0f,%.3f,%.0f,%.0f\n", res[i].writers, n_readers, n_pollers,
+                   res[i].writer_ops / res[i].elapsed, per, per / base, res[i].reader_ops / res[i].elapsed,
+                   res[i].events / res[i].elapsed);
+        }
+    } else if (strcmp(format, "json") == 0) {
+        printf("{\"readers\":%d,\"pollers\":%d,\"inject_hz\":%.0f,\"violations\":%ld,\"steps\":[", n_readers,
+               n_pollers, inject_disabled ? 0 : inject_hz, violations);
+        for (i = 0; i < n_steps; i++) {
+            per = res[i].writer_ops / res[i].elapsed / res[i].writers;
+            printf("%s{\"writers\":%d,\"writer_ops_per_sec\":%.0f,\"per_writer_ops_per_sec\":%.0f,"
+                   "\"relative\":%.3f,\"reads_per_sec\":%.0f,\"events_per_sec\":%.0f}",
+                   i ? "," : "", res[i].writers, res[i].writer_ops / res[i].elapsed, per, per / base,
+                   res[i].reader_ops / res[i].elapsed, res[i].events / res[i].elapsed);
+        }
+        printf("]}\n");
+    } else {
+        printf("%d readers, %d pollers, %.1f s per step%s\n", n_readers, n_pollers, step_sec,
+               have_led_mask ? "" : " (no " LED_MASK_PATH ", output check skipped)");
+        printf("%8s %12s %12s %9s %12s %12s\n", "writers", "ops/s", "per writer", "relative", "reads/s",
+               "events/s");
+        for (i = 0; i < n_steps; i++) {
+            per = res[i].writer_ops / res[i].elapsed / res[i].writers;
+            printf("%8d %12.0f %12.0f %8.1f%% %12.0f %12.0f\n", res[i].writers, res[i].writer_ops / res[i].elapsed,
+                   per, 100 * per / base, res[i].reader_ops / res[i].elapsed, res[i].events / res[i].elapsed);
+        }
+        printf("violations: %ld\n", violations);
+    }
+    return violations ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "led_uapi.h"
+
+// mmap 창으로 syscall 없이 LED 를 깜박인다
+//   ledstrobe [-m mask] [-n toggles] [-p period_us] [-e]
+// -e 는 드라이버 없이 익명 메모리와 폴링 스레드로 창을 흉내 낸다 (하드웨어 없이 시험용).
+
+static volatile int stop;
+
+static double now_sec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 드라이버의 led_mmio_poll 과 같은 순서로 창을 읽는다
+static void *emulate_poll(void *arg) {
+    struct led_mmio *win = arg;
+    struct timespec ts = { 0, 100000 };
+    __u32 value = 0, last = 0, out;
+
+    while (!stop) {
+        value |= __atomic_exchange_n(&win->set, 0, __ATOMIC_ACQ_REL);
+        value &= ~__atomic_exchange_n(&win->clr, 0, __ATOMIC_ACQ_REL);
+        out = value & win->claim & LED_MASK_ALL;
+        win->polls++;
+        if (out != last) {
+            last = out;
+            __atomic_store_n(&win->out, out, __ATOMIC_RELEASE);
+            __atomic_fetch_add(&win->seq, 1, __ATOMIC_RELEASE);
+        }
+        nanosleep(&ts, NULL);
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned mask = 1, period_us = 0;
+    long toggles = 1000000, i;
+    int emulate = 0, fd = -1, opt;
+    struct led_mmio *win;
+    pthread_t poller;
+    struct timespec ts;
+    double t;
+
+    while ((opt = getopt(argc, argv, "m:n:p:e")) != -1) {
+        switch (opt) {
+        case 'm':
+            mask = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            toggles = atol(optarg);
+            break;
+        case 'p':
+            period_us = atoi(optarg);
+            break;
+        case 'e':
+            emulate = 1;
+            break;
+        default:
+            printf("Usage: %s [-m mask] [-n toggles] [-p period_us] [-e]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (emulate) {
+        win = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    } else {
+        fd = open(LED_DEVICE_PATH, O_RDWR);
+        if (fd < 0) {
+            perror("Failed to open the device");
+            return 1;
+        }
+        win = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (win == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    if (emulate && pthread_create(&poller, NULL, emulate_poll, win) != 0) {
+        fprintf(stderr, "failed to start the emulated poller\n");
+        return 1;
+    }
+
+    __atomic_store_n(&win->claim, mask, __ATOMIC_RELEASE);
+    ts.tv_sec = 0;
+    ts.tv_nsec = period_us * 1000L;
+
+    t = now_sec();
+    for (i = 0; i < toggles; i++) {
+        __atomic_fetch_or((i & 1) ? &win->clr : &win->set, mask, __ATOMIC_RELEASE);
+        if (period_us) {
+            nanosleep(&ts, NULL);
+        }
+    }
+    t = now_sec() - t;
+
+    // 마지막 상태가 반영될 때까지 잠깐 기다린다
+    usleep(2000);
+    printf("%ld toggles in %.3f s (%.1f ns/toggle)\n", toggles, t, t * 1e9 / toggles);
+    printf("driver polls %u, output updates %u, last output 0x%x\n", win->polls, win->seq, win->out);
+
+    stop = 1;
+    if (emulate) {
+        pthread_join(poller, NULL);
+    }
+    munmap(win, sysconf(_SC_PAGESIZE));
+    if (fd >= 0) {
+        close(fd);
+    }
+    return 0;
+}
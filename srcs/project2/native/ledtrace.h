@@ -0,0 +1,45 @@
+#ifndef LEDTRACE_H
+#define LEDTRACE_H
+
+// 입력 trace 파일 (ledrec 이 쓰고 ledreplay 가 읽는다, little endian)
+//   header
+//   record x N (8 byte 고정, 파일 끝까지)
+// 시각은 직전 record 로부터의 µs. 71 분이 넘는 공백은 LT_GAP 으로 채운다.
+// 세션 번호는 드라이버 번호를 trace 안에서 0-255 로 다시 매긴 것 (닫히면 재사용)
+
+#include <stdint.h>
+
+#define LEDTRACE_MAGIC   0x5444454cu  // "LEDT"
+#define LEDTRACE_VERSION 1
+
+struct ledtrace_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;      // LEDTRACE_F_*
+    uint64_t start_ns;   // 첫 record 기준 시각 (녹화한 장비의 CLOCK_MONOTONIC)
+};
+
+#define LEDTRACE_F_INPUTS 0x1  // trace_inputs=1 로 녹화 (명령/세션 포함)
+#define LEDTRACE_SESSIONS_MAX 256
+
+struct ledtrace_rec {
+    uint32_t dt_us;
+    uint8_t type;        // LT_*
+    uint8_t sess;        // LT_OPEN/CLOSE/REQ 의 세션 번호
+    uint8_t op;          // LT_REQ 의 LED_REQ_*
+    uint8_t value;       // 스위치/LED 마스크, 모드(int8), 요청 값
+};
+
+enum ledtrace_type {
+    LT_GAP = 0,      // 시간만 흐름
+    LT_SWITCH,       // 디바운스 후 눌려 있는 스위치 (value: 마스크)
+    LT_MODE,         // 명령으로 바꾼 모드
+    LT_MASK,         // sysfs led_mask 로 직접 지정
+    LT_OPEN,         // 세션 열림
+    LT_CLOSE,        // 세션 닫힘
+    LT_REQ,          // 세션 요청 하나
+    LT_OBS_MODE,     // 명령이 아닌 원인(제스처, 프로그램 등)으로 바뀐 모드. 시뮬레이터만 쓴다
+    LT_COUNT,
+};
+
+#endif